@@ -66,8 +66,13 @@ std::shared_ptr<Query> Analyze::do_analyze(std::shared_ptr<ast::TreeNode> parse)
         check_clause({x->tab_name}, query->conds);        
     } else if (auto x = std::dynamic_pointer_cast<ast::InsertStmt>(parse)) {
         // 处理insert 的values值
-        for (auto &sv_val : x->vals) {
-            query->values.push_back(convert_sv_value(sv_val));
+        for (auto &sv_row : x->rows) {
+            std::vector<Value> row;
+            row.reserve(sv_row.size());
+            for (auto &sv_val : sv_row) {
+                row.push_back(convert_sv_value(sv_val));
+            }
+            query->rows.push_back(std::move(row));
         }
     } else {
         // do nothing
@@ -32,8 +32,8 @@ class Query{
     std::vector<std::string> tables;
     // update 的set 值
     std::vector<SetClause> set_clauses;
-    //insert 的values值
-    std::vector<Value> values;
+    //insert 的values值，每个元素为一行
+    std::vector<std::vector<Value>> rows;
 
     Query(){}
 
@@ -33,8 +33,21 @@ static constexpr int INVALID_TIMESTAMP = -1;                                  //
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                      // the header page id
 static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte  4KB
-static constexpr int BUFFER_POOL_SIZE = 65536;                                // size of buffer pool 256MB
+static constexpr int BUFFER_POOL_SIZE = 65536;                                // default size of buffer pool 256MB, overridden by rmdb -b
 // static constexpr int BUFFER_POOL_SIZE = 262144;                                // size of buffer pool 1GB
+static constexpr bool BUFFER_POOL_USE_HUGETLB = false;                        // back the frame arena with MAP_HUGETLB pages, falls back to THP-advised pages
+static constexpr int BUFFER_POOL_SHARDS = 16;                                 // number of buffer pool shards, 1 disables sharding
+static constexpr double BUFFER_POOL_CLEAN_RATIO = 0.1;                        // background flusher keeps this fraction of frames clean and unpinned
+static constexpr int BUFFER_POOL_FLUSH_INTERVAL_MS = 10;                      // background flusher wakes up every this many milliseconds
+static constexpr int BUFFER_POOL_FLUSH_BATCH = 16;                            // max pages written per shard in one flusher round
+static constexpr int BUFFER_POOL_FLUSH_ALL_BATCH = 256;                       // max pages pinned and written at once by flush_all_pages
+static constexpr int SCAN_RING_SIZE = 32;                                     // frames recycled by one large sequential scan or bulk load
+static constexpr double SCAN_RING_THRESHOLD = 0.25;                           // tables with more pages than this fraction of the pool are scanned through a ring
+static constexpr int READ_AHEAD_WINDOW = 32;                                  // pages prefetched ahead of a sequential scan, 0 disables read-ahead
+static constexpr int READ_AHEAD_TRIGGER = 2;                                  // consecutive sequential accesses before read-ahead starts
+static constexpr bool DIRECT_IO = false;                                      // open table and index files with O_DIRECT, bypassing the kernel page cache
+static constexpr bool LOG_SYNC = false;                                       // fdatasync the WAL after every write, independent of DIRECT_IO
+static constexpr int IO_URING_ENTRIES = 64;                                   // submission queue length of the optional io_uring backend
 static constexpr int LOG_BUFFER_SIZE = (1024 * PAGE_SIZE);                    // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
 
@@ -49,7 +62,27 @@ using timestamp_t = int32_t;  // timestamp type, used for transaction concurrenc
 // log file
 static const std::string LOG_FILE_NAME = "db.log";
 
-// replacer
+// replacer: LRU, CLOCK, LRU-K or 2Q
 static const std::string REPLACER_TYPE = "LRU";
+static constexpr int LRUK_REPLACER_K = 2;                                     // history length of LRU-K replacer
 
 static const std::string DB_META_NAME = "db.meta";
+
+// warm restart: close_db dumps the resident pages, open_db prefetches them back in the background
+static constexpr bool BUFFER_POOL_WARM_RESTART = true;
+static const std::string BUFFER_POOL_DUMP_NAME = "buffer_pool.dump";
+
+// bulk load: LOAD DATA INFILE parses the csv in parallel and writes whole heap pages, bypassing the buffer pool
+static constexpr int LOAD_DATA_THREADS = 8;                                   // max parser threads, also capped by hardware_concurrency
+static constexpr int LOAD_DATA_BLOCK_SIZE = (16 * 1024 * 1024);               // bytes of csv read and parsed per round
+static constexpr int LOAD_DATA_WRITE_PAGES = 64;                              // heap pages built in memory and written by one batched write
+
+// index bulk build: CREATE INDEX sorts (key, rid) pairs externally and packs the B+ tree bottom-up
+static constexpr double IX_BULK_FILL_FACTOR = 0.9;                            // fraction of each bulk-built node filled, leaving room for later inserts
+static constexpr int IX_SORT_BUFFER_SIZE = (64 * 1024 * 1024);                // bytes of (key, rid) pairs sorted in memory before a run is spilled
+static constexpr int IX_BULK_WRITE_PAGES = 64;                                // index pages built in memory and written by one batched write
+static constexpr int IX_INSERT_BATCH_KEYS = 1024;                             // sorted keys taken from a sorter per leaf-batched insert into a non-empty index
+
+// index node search: binary search narrows the range to a few keys, which are then probed linearly
+static constexpr int IX_LINEAR_SEARCH_KEYS = 8;                               // keys compared one by one with memcmp at the end of a search
+static constexpr int IX_PROBE_SEARCH_KEYS = 64;                               // keys counted branch-free when key suffixes are at most 4 bytes
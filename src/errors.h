@@ -132,6 +132,11 @@ class IndexExistsError : public RMDBError {
     }
 };
 
+class IndexDuplicateKeyError : public RMDBError {
+   public:
+    IndexDuplicateKeyError() : RMDBError("Duplicate key in index") {}
+};
+
 // QL errors
 class InvalidValueCountError : public RMDBError {
    public:
@@ -27,10 +27,12 @@ const char *help_info = "Supported SQL syntax:\n"
                    "  DROP TABLE table_name\n"
                    "  CREATE INDEX table_name (column_name)\n"
                    "  DROP INDEX table_name (column_name)\n"
-                   "  INSERT INTO table_name VALUES (value [, value ...])\n"
+                   "  INSERT INTO table_name VALUES (value [, value ...]) [, (value [, value ...]) ...]\n"
+                   "  LOAD DATA INFILE 'file_name' INTO TABLE table_name\n"
                    "  DELETE FROM table_name [WHERE where_clause]\n"
                    "  UPDATE table_name SET column_name = value [, column_name = value ...] [WHERE where_clause]\n"
                    "  SELECT selector FROM table_name [WHERE where_clause]\n"
+                   "  SET BUFFER POOL SIZE frames\n"
                    "type:\n"
                    "  {INT | FLOAT | CHAR(n)}\n"
                    "where_clause:\n"
@@ -44,7 +46,7 @@ const char *help_info = "Supported SQL syntax:\n"
                    "selector:\n"
                    "  {* | column [, column ...]}\n";
 
-// 主要负责执行DDL语句
+// 主要负责执行DDL语句和load data语句
 void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
     if (auto x = std::dynamic_pointer_cast<DDLPlan>(plan)) {
         switch(x->tag) {
@@ -72,10 +74,12 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
                 throw InternalError("Unexpected field type");
                 break;  
         }
+    } else if (auto x = std::dynamic_pointer_cast<LoadDataPlan>(plan)) {
+        sm_manager_->load_data(x->file_name_, x->tab_name_, context);
     }
 }
 
-// 执行help; show tables; desc table; begin; commit; abort;语句
+// 执行help; show tables; show buffer stats; set buffer pool size; desc table; begin; commit; abort;语句
 void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Context *context) {
     if (auto x = std::dynamic_pointer_cast<OtherPlan>(plan)) {
         switch(x->tag) {
@@ -90,6 +94,16 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Co
                 sm_manager_->show_tables(context);
                 break;
             }
+            case T_ShowBufferStats:
+            {
+                sm_manager_->show_buffer_stats(context);
+                break;
+            }
+            case T_SetBufferPoolSize:
+            {
+                sm_manager_->set_buffer_pool_size(x->value_, context);
+                break;
+            }
             case T_DescTable:
             {
                 sm_manager_->desc_table(x->tab_name_, context);
@@ -9,6 +9,9 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #pragma once
+#include <algorithm>
+#include <numeric>
+
 #include "execution_defs.h"
 #include "execution_manager.h"
 #include "executor_abstract.h"
@@ -18,51 +21,87 @@ See the Mulan PSL v2 for more details. */
 class InsertExecutor : public AbstractExecutor {
    private:
     TabMeta tab_;                   // 表的元数据
-    std::vector<Value> values_;     // 需要插入的数据
+    std::vector<std::vector<Value>> rows_;  // 需要插入的数据，每个元素为一行
     RmFileHandle *fh_;              // 表的数据文件句柄
     std::string tab_name_;          // 表名称
-    Rid rid_;                       // 插入的位置，由于系统默认插入时不指定位置，因此当前rid_在插入后才赋值
+    Rid rid_;                       // 插入的位置，由于系统默认插入时不指定位置，因此当前rid_在插入后才赋值，为最后一行的位置
     SmManager *sm_manager_;
 
    public:
-    InsertExecutor(SmManager *sm_manager, const std::string &tab_name, std::vector<Value> values, Context *context) {
+    InsertExecutor(SmManager *sm_manager, const std::string &tab_name, std::vector<std::vector<Value>> rows,
+                   Context *context) {
         sm_manager_ = sm_manager;
         tab_ = sm_manager_->db_.get_table(tab_name);
-        values_ = values;
+        rows_ = std::move(rows);
         tab_name_ = tab_name;
-        if (values.size() != tab_.cols.size()) {
-            throw InvalidValueCountError();
+        for (auto &values : rows_) {
+            if (values.size() != tab_.cols.size()) {
+                throw InvalidValueCountError();
+            }
         }
         fh_ = sm_manager_->fhs_.at(tab_name).get();
         context_ = context;
     };
 
     std::unique_ptr<RmRecord> Next() override {
-        // Make record buffer
-        RmRecord rec(fh_->get_file_hdr().record_size);
-        for (size_t i = 0; i < values_.size(); i++) {
-            auto &col = tab_.cols[i];
-            auto &val = values_[i];
-            if (col.type != val.type) {
-                throw IncompatibleTypeError(coltype2str(col.type), coltype2str(val.type));
+        const int num_rows = static_cast<int>(rows_.size());
+        if (num_rows == 0) {
+            return nullptr;
+        }
+        // Make record buffer, all rows are laid out contiguously
+        const int record_size = fh_->get_file_hdr().record_size;
+        std::vector<char> buf(static_cast<size_t>(num_rows) * record_size);
+        for (int r = 0; r < num_rows; r++) {
+            char *rec = buf.data() + static_cast<size_t>(r) * record_size;
+            for (size_t i = 0; i < rows_[r].size(); i++) {
+                auto &col = tab_.cols[i];
+                auto &val = rows_[r][i];
+                if (col.type != val.type) {
+                    throw IncompatibleTypeError(coltype2str(col.type), coltype2str(val.type));
+                }
+                val.init_raw(col.len);
+                memcpy(rec + col.offset, val.raw->data, col.len);
             }
-            val.init_raw(col.len);
-            memcpy(rec.data + col.offset, val.raw->data, col.len);
         }
-        // Insert into record file
-        rid_ = fh_->insert_record(rec.data, context_);
-        
-        // Insert into index
-        for(size_t i = 0; i < tab_.indexes.size(); ++i) {
-            auto& index = tab_.indexes[i];
+        // Insert into record file, each free page is pinned once for the whole batch
+        std::vector<Rid> rids = fh_->insert_records(buf.data(), num_rows, context_);
+        rid_ = rids.back();
+
+        // Insert into index, keys of the batch are sorted and inserted leaf by leaf, descending once per leaf
+        for (size_t i = 0; i < tab_.indexes.size(); ++i) {
+            auto &index = tab_.indexes[i];
             auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
-            char* key = new char[index.col_tot_len];
-            int offset = 0;
-            for(size_t i = 0; i < index.col_num; ++i) {
-                memcpy(key + offset, rec.data + index.cols[i].offset, index.cols[i].len);
-                offset += index.cols[i].len;
+            std::vector<ColType> col_types;
+            std::vector<int> col_lens;
+            for (auto &col : index.cols) {
+                col_types.push_back(col.type);
+                col_lens.push_back(col.len);
+            }
+            const int key_len = index.col_tot_len;
+            std::vector<char> keys(static_cast<size_t>(num_rows) * key_len);
+            for (int r = 0; r < num_rows; r++) {
+                char *key = keys.data() + static_cast<size_t>(r) * key_len;
+                const char *rec = buf.data() + static_cast<size_t>(r) * record_size;
+                int offset = 0;
+                for (int j = 0; j < index.col_num; ++j) {
+                    memcpy(key + offset, rec + index.cols[j].offset, index.cols[j].len);
+                    offset += index.cols[j].len;
+                }
+            }
+            std::vector<int> order(num_rows);
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+                return ix_compare(keys.data() + static_cast<size_t>(a) * key_len,
+                                  keys.data() + static_cast<size_t>(b) * key_len, col_types, col_lens) < 0;
+            });
+            std::vector<char> sorted_keys(keys.size());
+            std::vector<Rid> sorted_rids(num_rows);
+            for (int r = 0; r < num_rows; r++) {
+                memcpy(sorted_keys.data() + static_cast<size_t>(r) * key_len,
+                       keys.data() + static_cast<size_t>(order[r]) * key_len, key_len);
+                sorted_rids[r] = rids[order[r]];
             }
-            ih->insert_entry(key, rid_, context_->txn_);
+            ih->insert_entries(sorted_keys.data(), sorted_rids.data(), num_rows, context_->txn_);
         }
         return nullptr;
     }
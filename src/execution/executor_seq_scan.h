@@ -27,11 +27,13 @@ class SeqScanExecutor : public AbstractExecutor {
 
     Rid rid_;
     std::unique_ptr<RecScan> scan_;     // table_iterator
+    std::unique_ptr<BufferRing> ring_;  // 大表扫描使用的私有帧环，为nullptr时使用缓冲池的普通替换策略
 
     SmManager *sm_manager_;
 
    public:
-    SeqScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds, Context *context) {
+    SeqScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds, Context *context,
+                    bool use_ring = false) {
         sm_manager_ = sm_manager;
         tab_name_ = std::move(tab_name);
         conds_ = std::move(conds);
@@ -43,14 +45,18 @@ class SeqScanExecutor : public AbstractExecutor {
         context_ = context;
 
         fed_conds_ = conds_;
+
+        if (use_ring) {
+            ring_ = sm_manager_->get_bpm()->make_ring();
+        }
     }
 
     /**
      * @brief 构建表迭代器scan_,并开始迭代扫描,直到扫描到第一个满足谓词条件的元组停止,并赋值给rid_
-     *
+     * @note 构建scan_时传入ring_.get()，大表扫描在私有帧环内替换页面
      */
     void beginTuple() override {
-        
+        scan_ = std::make_unique<RmScan>(fh_, ring_.get());
     }
 
     /**
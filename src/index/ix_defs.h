@@ -31,8 +31,7 @@ public:
     std::vector<ColType> col_types_;    // 字段的类型
     std::vector<int> col_lens_;         // 字段的长度
     int col_tot_len_;                   // 索引包含的字段的总长度
-    int btree_order_;                   // # children per page 每个结点最多可插入的键值对数量
-    int keys_size_;                     // keys_size = (btree_order + 1) * col_tot_len
+    int btree_order_;                   // # children per page 每个结点最多可插入的键值对数量，实际容量还受结点中key的压缩程度限制
     // first_leaf初始化之后没有进行修改，只不过是在测试文件中遍历叶子结点的时候用了
     page_id_t first_leaf_;              // 首叶节点对应的页号，在上层IxManager的open函数进行初始化，初始化为root page_no
     page_id_t last_leaf_;               // 尾叶节点对应的页号
@@ -43,15 +42,15 @@ public:
     }
 
     IxFileHdr(page_id_t first_free_page_no, int num_pages, page_id_t root_page, int col_num,
-                int col_tot_len, int btree_order, int keys_size, page_id_t first_leaf, page_id_t last_leaf)
+                int col_tot_len, int btree_order, page_id_t first_leaf, page_id_t last_leaf)
                 : first_free_page_no_(first_free_page_no), num_pages_(num_pages), root_page_(root_page), col_num_(col_num),
-                col_tot_len_(col_tot_len), btree_order_(btree_order), keys_size_(keys_size), first_leaf_(first_leaf), last_leaf_(last_leaf) {
+                col_tot_len_(col_tot_len), btree_order_(btree_order), first_leaf_(first_leaf), last_leaf_(last_leaf) {
                     tot_len_ = 0;
                 } 
 
     void update_tot_len() {
         tot_len_ = 0;
-        tot_len_ += sizeof(page_id_t) * 4 + sizeof(int) * 6;
+        tot_len_ += sizeof(page_id_t) * 4 + sizeof(int) * 5;
         tot_len_ += sizeof(ColType) * col_num_ + sizeof(int) * col_num_;
     }
 
@@ -79,8 +78,6 @@ public:
         offset += sizeof(int);
         memcpy(dest + offset, &btree_order_, sizeof(int));
         offset += sizeof(int);
-        memcpy(dest + offset, &keys_size_, sizeof(int));
-        offset += sizeof(int);
         memcpy(dest + offset, &first_leaf_, sizeof(page_id_t));
         offset += sizeof(page_id_t);
         memcpy(dest + offset, &last_leaf_, sizeof(page_id_t));
@@ -117,8 +114,6 @@ public:
         offset += sizeof(int);
         btree_order_ = *reinterpret_cast<const int*>(src + offset);
         offset += sizeof(int);
-        keys_size_ = *reinterpret_cast<const int*>(src + offset);
-        offset += sizeof(int);
         first_leaf_ = *reinterpret_cast<const page_id_t*>(src+ offset);
         offset += sizeof(page_id_t);
         last_leaf_ = *reinterpret_cast<const page_id_t*>(src + offset);
@@ -130,11 +125,11 @@ public:
 class IxPageHdr {
 public:
     page_id_t next_free_page_no;    // unused
-    page_id_t parent;               // 父亲节点所在页面的叶号
     int num_key;                    // # current keys (always equals to #child - 1) 已插入的keys数量，key_idx∈[0,num_key)
     bool is_leaf;                   // 是否为叶节点
     page_id_t prev_leaf;            // previous leaf node's page_no, effective only when is_leaf is true
     page_id_t next_leaf;            // next leaf node's page_no, effective only when is_leaf is true
+    int prefix_len;                 // 结点中key的公共前缀长度；内部结点只统计key[1..num_key)，key[0]不参与
 };
 
 class Iid {
@@ -12,18 +12,89 @@ See the Mulan PSL v2 for more details. */
 
 #include "ix_scan.h"
 
+/**
+ * @brief 两个key的最长公共前缀的长度
+ */
+static int common_prefix_len(const char *a, const char *b, int len) {
+    int i = 0;
+    while (i < len && a[i] == b[i]) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * @brief 计算满足left < sep <= right的最短分隔key：right的前(公共前缀长度+1)个字节，其余字节补0
+ * 规范化key按字节比较，sep在第一个不同的字节上已经大于left，补0之后仍不大于right
+ */
+static void shortest_separator(const char *left, const char *right, int len, char *sep) {
+    int sep_len = common_prefix_len(left, right, len) + 1;
+    assert(sep_len <= len);
+    memcpy(sep, right, sep_len);
+    memset(sep + sep_len, 0, len - sep_len);
+}
+
+/**
+ * @brief 比较第key_idx个key与完整的key，先比较公共前缀，再比较后缀
+ *
+ * @return 小于0、等于0、大于0分别表示第key_idx个key小于、等于、大于key
+ */
+int IxNodeHandle::compare_key(int key_idx, const char *key) const {
+    int prefix_len = get_prefix_len();
+    int res = memcmp(get_prefix(), key, prefix_len);
+    if (res != 0) {
+        return res;
+    }
+    return ix_key_compare(get_suffix(key_idx), key + prefix_len, get_suffix_len());
+}
+
+/**
+ * @brief 在[begin,end)范围内的后缀中查找第一个>=suffix(upper为true时>suffix)的key_idx
+ * 先二分查找把范围缩小到几个key，再顺序比较剩下的key：后缀不超过4字节时(int/float key，或前缀压缩后的叶子)
+ * 按整数无分支地统计小于target的个数，可以一次比较更多key，否则逐个memcmp
+ */
+int IxNodeHandle::search_suffix(const char *suffix, int begin, int end, bool upper) const {
+    const char *suffixes = suffixes_begin();
+    int suffix_len = get_suffix_len();
+    bool probe = suffix_len <= 4;
+    int linear_keys = probe ? IX_PROBE_SEARCH_KEYS : IX_LINEAR_SEARCH_KEYS;
+    while (end - begin > linear_keys) {
+        int mid = begin + (end - begin) / 2;
+        int res = ix_key_compare(suffixes + mid * suffix_len, suffix, suffix_len);
+        if (res < 0 || (upper && res == 0)) {
+            begin = mid + 1;
+        } else {
+            end = mid;
+        }
+    }
+    if (probe) {
+        return begin + ix_probe_count(suffixes + begin * suffix_len, end - begin, suffix_len, suffix, upper);
+    }
+    while (begin < end) {
+        int res = ix_key_compare(suffixes + begin * suffix_len, suffix, suffix_len);
+        if (res > 0 || (!upper && res == 0)) {
+            break;
+        }
+        begin++;
+    }
+    return begin;
+}
+
 /**
  * @brief 在当前node中查找第一个>=target的key_idx
  *
  * @return key_idx，范围为[0,num_key)，如果返回的key_idx=num_key，则表示target大于最后一个key
  * @note 返回key index（同时也是rid index），作为slot no
+ * target与公共前缀不同时小于或大于所有key，否则只需比较后缀
  */
 int IxNodeHandle::lower_bound(const char *target) const {
-    // Todo:
-    // 查找当前节点中第一个大于等于target的key，并返回key的位置给上层
-    // 提示: 可以采用多种查找方式，如顺序遍历、二分查找等；使用ix_compare()函数进行比较
-
-    return -1;
+    int num_key = page_hdr->num_key;
+    int prefix_len = get_prefix_len();
+    int res = memcmp(target, get_prefix(), prefix_len);
+    if (res != 0) {
+        return res < 0 ? 0 : num_key;
+    }
+    return search_suffix(target + prefix_len, 0, num_key, false);
 }
 
 /**
@@ -33,11 +104,85 @@ int IxNodeHandle::lower_bound(const char *target) const {
  * @note 注意此处的范围从1开始
  */
 int IxNodeHandle::upper_bound(const char *target) const {
-    // Todo:
-    // 查找当前节点中第一个大于target的key，并返回key的位置给上层
-    // 提示: 可以采用多种查找方式：顺序遍历、二分查找等；使用ix_compare()函数进行比较
+    int num_key = page_hdr->num_key;
+    int prefix_len = get_prefix_len();
+    int res = memcmp(target, get_prefix(), prefix_len);
+    if (res != 0) {
+        return res < 0 ? 1 : std::max(num_key, 1);
+    }
+    return search_suffix(target + prefix_len, 1, std::max(num_key, 1), true);
+}
+
+/**
+ * @brief 插入key之后结点的公共前缀长度(按第first_key_idx()个及之后的key计算)
+ * 结点中的key有序，不以公共前缀开头的key只能插入到两端，新的公共前缀为原公共前缀与key的最长公共前缀；
+ * 结点中还没有参与压缩的key时，插入后只有这一个key，整个key都是公共前缀
+ */
+int IxNodeHandle::prefix_len_with(const char *key) {
+    if (get_size() <= first_key_idx()) {
+        return file_hdr->col_tot_len_;
+    }
+    return common_prefix_len(get_prefix(), key, get_prefix_len());
+}
 
-    return -1;
+/**
+ * @brief 把结点的公共前缀改为key的前prefix_len个字节，按新的前缀重新排列后缀，结点容量随之变化
+ * 插入不以原公共前缀开头的key之前缩短前缀，调用者保证缩短后仍能放下所有键值对；
+ * 删除两端的key之后公共前缀可能变长，加长前缀使结点容量变大
+ * @param key 以新前缀开头的key；内部结点的第0个key不参与压缩，其后缀只保留新前缀之后的部分
+ */
+void IxNodeHandle::restride(int prefix_len, const char *key) {
+    int num_key = get_size();
+    int key_len = file_hdr->col_tot_len_;
+    assert(num_key > 0 && num_key <= capacity(key_len, prefix_len));
+    char buf[PAGE_SIZE];
+    memcpy(buf, get_data(), PAGE_SIZE);
+    IxNodeHandle old_node(file_hdr, buf);
+
+    memcpy(get_data() + sizeof(IxPageHdr), key, prefix_len);
+    page_hdr->prefix_len = prefix_len;
+    memcpy(rids_begin(), old_node.rids_begin(), num_key * sizeof(Rid));
+    char *suffix = suffixes_begin();
+    char old_key[IX_MAX_COL_LEN];
+    for (int i = 0; i < num_key; i++) {
+        old_node.get_key(i, old_key);
+        memcpy(suffix, old_key + prefix_len, key_len - prefix_len);
+        suffix += key_len - prefix_len;
+    }
+}
+
+/**
+ * @brief 删除或替换两端的key之后，参与压缩的key的公共前缀可能变长，加长前缀使结点容量变大
+ */
+void IxNodeHandle::extend_prefix() {
+    int first = first_key_idx();
+    int num_key = get_size();
+    if (num_key <= first) {
+        return;
+    }
+    int prefix_len = get_prefix_len() + common_prefix_len(get_suffix(first), get_suffix(num_key - 1), get_suffix_len());
+    if (prefix_len > get_prefix_len()) {
+        char key[IX_MAX_COL_LEN];
+        get_key(first, key);
+        restride(prefix_len, key);
+    }
+}
+
+/**
+ * @brief 用完整的key替换第key_idx个key，key不以公共前缀开头时先缩短前缀
+ * @note 调用者保证缩短前缀后仍能放下所有键值对，见can_replace_key()
+ */
+void IxNodeHandle::set_key(int key_idx, const char *key) {
+    if (key_idx >= first_key_idx()) {
+        int prefix_len = common_prefix_len(get_prefix(), key, get_prefix_len());
+        if (prefix_len < get_prefix_len()) {
+            restride(prefix_len, key);
+        }
+    }
+    memcpy(get_suffix(key_idx), key + get_prefix_len(), get_suffix_len());
+    if (key_idx == first_key_idx() || key_idx == get_size() - 1) {
+        extend_prefix();
+    }
 }
 
 /**
@@ -49,13 +194,12 @@ int IxNodeHandle::upper_bound(const char *target) const {
  * @return 目标key是否存在
  */
 bool IxNodeHandle::leaf_lookup(const char *key, Rid **value) {
-    // Todo:
-    // 1. 在叶子节点中获取目标key所在位置
-    // 2. 判断目标key是否存在
-    // 3. 如果存在，获取key对应的Rid，并赋值给传出参数value
-    // 提示：可以调用lower_bound()和get_rid()函数。
-
-    return false;
+    int key_idx = lower_bound(key);
+    if (key_idx == get_size() || compare_key(key_idx, key) != 0) {
+        return false;
+    }
+    *value = get_rid(key_idx);
+    return true;
 }
 
 /**
@@ -64,12 +208,8 @@ bool IxNodeHandle::leaf_lookup(const char *key, Rid **value) {
  * @return page_id_t 目标key所在的孩子节点（子树）的存储页面编号
  */
 page_id_t IxNodeHandle::internal_lookup(const char *key) {
-    // Todo:
-    // 1. 查找当前非叶子节点中目标key所在孩子节点（子树）的位置
-    // 2. 获取该孩子节点（子树）所在页面的编号
-    // 3. 返回页面编号
-
-    return -1;
+    // 内部结点的第i(i>0)个key是第i-1个和第i个孩子之间的分隔key，目标key位于最后一个分隔key<=key的孩子中；小于所有分隔key时取第0个孩子
+    return value_at(upper_bound(key) - 1);
 }
 
 /**
@@ -87,12 +227,46 @@ page_id_t IxNodeHandle::internal_lookup(const char *key) {
  *                      key           key_slot
  */
 void IxNodeHandle::insert_pairs(int pos, const char *key, const Rid *rid, int n) {
-    // Todo:
-    // 1. 判断pos的合法性
-    // 2. 通过key获取n个连续键值对的key值，并把n个key值插入到pos位置
-    // 3. 通过rid获取n个连续键值对的rid值，并把n个rid值插入到pos位置
-    // 4. 更新当前节点的键数量
-
+    int num_key = get_size();
+    assert(pos >= 0 && pos <= num_key);
+    if (n == 0) {
+        return;
+    }
+    int key_len = file_hdr->col_tot_len_;
+    // 插入后位于first_key_idx()及之后的key参与压缩；内部结点只在空结点的开头插入，原来的第0个key不会移到后面
+    assert(is_leaf_page() || pos > 0 || num_key == 0);
+    int first = std::max(0, first_key_idx() - pos);
+    if (first < n) {
+        const char *first_key = key + first * key_len;
+        const char *last_key = key + (n - 1) * key_len;
+        int prefix_len;
+        if (num_key <= first_key_idx()) {
+            // 结点中还没有参与压缩的key，直接按插入的key重新确定公共前缀：有序的key的公共前缀就是第一个和最后一个key的公共前缀
+            prefix_len = common_prefix_len(first_key, last_key, key_len);
+        } else {
+            prefix_len = std::min(prefix_len_with(first_key), prefix_len_with(last_key));
+        }
+        if (num_key == 0) {
+            page_hdr->prefix_len = prefix_len;
+            memcpy(get_data() + sizeof(IxPageHdr), first_key, prefix_len);
+        } else if (prefix_len != get_prefix_len()) {
+            restride(prefix_len, first_key);
+        }
+    } else if (num_key == 0) {
+        page_hdr->prefix_len = 0;  // 只插入了内部结点的第0个key
+    }
+    int prefix_len = get_prefix_len();
+    int suffix_len = key_len - prefix_len;
+    assert(num_key + n <= capacity(key_len, prefix_len));
+    char *suffixes = suffixes_begin();
+    Rid *rids = rids_begin();
+    memmove(suffixes + (pos + n) * suffix_len, suffixes + pos * suffix_len, (num_key - pos) * suffix_len);
+    for (int i = 0; i < n; i++) {
+        memcpy(suffixes + (pos + i) * suffix_len, key + i * key_len + prefix_len, suffix_len);
+    }
+    memmove(rids + pos + n, rids + pos, (num_key - pos) * sizeof(Rid));
+    memcpy(rids + pos, rid, n * sizeof(Rid));
+    set_size(num_key + n);
 }
 
 /**
@@ -103,13 +277,12 @@ void IxNodeHandle::insert_pairs(int pos, const char *key, const Rid *rid, int n)
  * @return int 键值对数量
  */
 int IxNodeHandle::insert(const char *key, const Rid &value) {
-    // Todo:
-    // 1. 查找要插入的键值对应该插入到当前节点的哪个位置
-    // 2. 如果key重复则不插入
-    // 3. 如果key不重复则插入键值对
-    // 4. 返回完成插入操作之后的键值对数量
-
-    return -1;
+    int pos = lower_bound(key);
+    if (pos < get_size() && compare_key(pos, key) == 0) {
+        return get_size();
+    }
+    insert_pair(pos, key, value);
+    return get_size();
 }
 
 /**
@@ -118,11 +291,18 @@ int IxNodeHandle::insert(const char *key, const Rid &value) {
  * @param pos 要删除键值对的位置
  */
 void IxNodeHandle::erase_pair(int pos) {
-    // Todo:
-    // 1. 删除该位置的key
-    // 2. 删除该位置的rid
-    // 3. 更新结点的键值对数量
-
+    int num_key = get_size();
+    assert(pos >= 0 && pos < num_key);
+    int suffix_len = get_suffix_len();
+    char *suffixes = suffixes_begin();
+    Rid *rids = rids_begin();
+    memmove(suffixes + pos * suffix_len, suffixes + (pos + 1) * suffix_len, (num_key - pos - 1) * suffix_len);
+    memmove(rids + pos, rids + pos + 1, (num_key - pos - 1) * sizeof(Rid));
+    set_size(num_key - 1);
+    // 删除两端的key之后，剩余key的公共前缀可能变长
+    if (pos <= first_key_idx() || pos == num_key - 1) {
+        extend_prefix();
+    }
 }
 
 /**
@@ -132,46 +312,191 @@ void IxNodeHandle::erase_pair(int pos) {
  * @return 完成删除操作后的键值对数量
  */
 int IxNodeHandle::remove(const char *key) {
-    // Todo:
-    // 1. 查找要删除键值对的位置
-    // 2. 如果要删除的键值对存在，删除键值对
-    // 3. 返回完成删除操作后的键值对数量
-
-    return -1;
+    int pos = lower_bound(key);
+    if (pos < get_size() && compare_key(pos, key) == 0) {
+        erase_pair(pos);
+    }
+    return get_size();
 }
 
 IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
     : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd) {
     // init file_hdr_
-    disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, (char *)&file_hdr_, sizeof(file_hdr_));
-    char* buf = new char[PAGE_SIZE];
-    memset(buf, 0, PAGE_SIZE);
+    char buf[PAGE_SIZE] = {0};
     disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, buf, PAGE_SIZE);
     file_hdr_ = new IxFileHdr();
     file_hdr_->deserialize(buf);
-    
-    // disk_manager管理的fd对应的文件中，设置从file_hdr_->num_pages开始分配page_no
-    int now_page_no = disk_manager_->get_fd2pageno(fd);
-    disk_manager_->set_fd2pageno(fd, now_page_no + 1);
+
+    // 从文件末尾开始分配新的page_no：num_pages_只统计仍在使用的页面，被释放的页面留在空闲链表中，
+    // 不能作为分配位置；关闭索引时所有页面都已刷盘，文件大小就是分配过的页面个数
+    page_id_t num_pages = std::max<page_id_t>(disk_manager_->get_file_pages(fd), IX_INIT_NUM_PAGES);
+    disk_manager_->set_fd2pageno(fd, num_pages);
 }
 
 /**
  * @brief 用于查找指定键所在的叶子结点
- * @param key 要查找的目标key值
+ * FIND：自根结点向下对路径加读锁蟹行，返回加了读锁的叶子结点；
+ * INSERT/DELETE：悲观蟹行，沿路径加写锁，某个结点安全(is_safe)时释放它所有祖先的写锁以及root_latch_，
+ * 仍持有的写锁按自顶向下的顺序记录在transaction的index_latch_page_set中，其中nullptr表示root_latch_，
+ * 由release_latches()统一释放；每个内部结点走向的孩子下标记录在index_child_idx_set中，分裂/合并时不需要在父结点中查找孩子
+ * @param key 要查找的目标key值，为规范化key
  * @param operation 查找到目标键值对后要进行的操作类型
- * @param transaction 事务参数，如果不需要则默认传入nullptr
+ * @param transaction 事务参数，FIND时可以传入nullptr，INSERT/DELETE时不能为nullptr
+ * @param find_first 为true时总是走向第一个孩子，找到第一个叶子结点
  * @return [leaf node] and [root_is_latched] 返回目标叶子结点以及根结点是否加锁
  * @note need to Unlatch and unpin the leaf node outside!
- * 注意：用了FindLeafPage之后一定要unlatch叶结点，否则下次latch该结点会堵塞！
+ * 注意：FIND之后要对叶结点read_unlatch并unpin；INSERT/DELETE返回的叶结点的写锁和pin记录在transaction中，只需delete结点句柄
  */
 std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, Operation operation,
                                                             Transaction *transaction, bool find_first) {
-    // Todo:
-    // 1. 获取根节点
-    // 2. 从根节点开始不断向下查找目标key
-    // 3. 找到包含该key值的叶子结点停止查找，并返回叶子节点
+    if (operation == Operation::FIND) {
+        return std::make_pair(descend_read(key, find_first, false), false);
+    }
+    root_latch_.lock();
+    transaction->append_index_latch_page_set(nullptr);
+    bool root_is_latched = true;
+    IxNodeHandle *node = fetch_node(file_hdr_->root_page_);
+    node->page->write_latch();
+    while (true) {
+        if (is_safe(node, key, operation)) {
+            release_latches(transaction, false);
+            root_is_latched = false;
+        }
+        transaction->append_index_latch_page_set(node->page);
+        if (node->is_leaf_page()) {
+            break;
+        }
+        int child_idx = find_first ? 0 : node->upper_bound(key) - 1;
+        transaction->get_index_child_idx_set()->back() = child_idx;
+        page_id_t child_page_no = node->value_at(child_idx);
+        delete node;
+        node = fetch_node(child_page_no);
+        node->page->write_latch();
+    }
+    return std::make_pair(node, root_is_latched);
+}
 
-    return std::make_pair(nullptr, false);
+/**
+ * @brief 自根结点向下加读锁蟹行：先对孩子加锁再释放父结点，同一时刻最多持有两个结点的读锁
+ * 用于查找，以及插入/删除的乐观下降(假设叶子结点不会分裂或合并，只对叶子加写锁)
+ * @param latch_leaf_write 为true时对叶子结点加写锁，否则加读锁
+ * @param[out] upper_key 不为nullptr时记录叶子的上界：下降路径上离叶子最近的、位于所走孩子右侧的分隔key，
+ * 叶子是其所在子树中最后一个叶子时没有上界，*has_upper_key为false
+ * @return 加锁并pin住的叶子结点
+ * @note 加锁之后才能知道结点是否为叶子，需要写锁时先释放读锁再加写锁。此时仍持有父结点的读锁
+ * (根结点为叶子时持有root_latch_的读锁)，而分裂/合并叶子需要父结点的写锁，因此两次加锁之间叶子的键值范围不变。
+ * 叶子的键值范围只有在它自己分裂、合并或与兄弟重新分配时才会改变，这些操作都要加叶子的写锁，
+ * 因此持有叶子的写锁期间上界一直有效
+ */
+IxNodeHandle *IxIndexHandle::descend_read(const char *key, bool find_first, bool latch_leaf_write, char *upper_key,
+                                          bool *has_upper_key) {
+    if (has_upper_key != nullptr) {
+        *has_upper_key = false;
+    }
+    std::shared_lock<std::shared_mutex> root_lock(root_latch_);
+    IxNodeHandle *node = fetch_node(file_hdr_->root_page_);
+    node->page->read_latch();
+    if (latch_leaf_write && node->is_leaf_page()) {
+        node->page->read_unlatch();
+        node->page->write_latch();
+    }
+    root_lock.unlock();
+    while (!node->is_leaf_page()) {
+        int child_idx = find_first ? 0 : node->upper_bound(key) - 1;
+        if (upper_key != nullptr && child_idx + 1 < node->get_size()) {
+            node->get_key(child_idx + 1, upper_key);
+            *has_upper_key = true;
+        }
+        IxNodeHandle *child = fetch_node(node->value_at(child_idx));
+        child->page->read_latch();
+        if (latch_leaf_write && child->is_leaf_page()) {
+            child->page->read_unlatch();
+            child->page->write_latch();
+        }
+        node->page->read_unlatch();
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
+        node = child;
+    }
+    return node;
+}
+
+/**
+ * @brief 判断在node的子树中执行operation之后，node的父结点及更上层的结点是否都不会被修改
+ * 插入：node不会分裂。叶子按插入key之后的公共前缀计算容量；内部结点插入的是孩子分裂产生的分隔key，
+ * 它落在key所在孩子的两个分隔key之间时不改变公共前缀，落在第0个或最后一个孩子中时公共前缀可能缩短到任意长度，
+ * 按其中最小的容量判断
+ * 删除：node删除一个键值对后不少于半满。分隔key只需要划分孩子的范围，删除孩子的第一个key不影响父结点
+ * 根结点没有父结点，只要求不会更换根结点：插入时不分裂；删除时内部结点至少保留两个孩子，叶子结点删空后仍作为根结点
+ */
+bool IxIndexHandle::is_safe(IxNodeHandle *node, const char *key, Operation operation) {
+    if (operation == Operation::FIND) {
+        return true;
+    }
+    if (operation == Operation::INSERT) {
+        if (node->is_leaf_page()) {
+            return node->has_room_for(key);
+        }
+        int child_idx = node->upper_bound(key) - 1;
+        int prefix_len = node->get_prefix_len();
+        int max_size = IxNodeHandle::max_size(file_hdr_, prefix_len);
+        if (child_idx == 0 || child_idx == node->get_size() - 1) {
+            for (int len = 0; len < prefix_len; len++) {
+                max_size = std::min(max_size, IxNodeHandle::max_size(file_hdr_, len));
+            }
+        }
+        return node->get_size() + 1 < max_size;
+    }
+    if (node->is_root_page()) {
+        return node->is_leaf_page() || node->get_size() > 2;
+    }
+    return node->get_size() > node->get_min_size();
+}
+
+/**
+ * @brief 释放transaction中记录的所有写锁并unpin，nullptr表示root_latch_
+ * 被删除的结点在释放写锁之前放入空闲页面链表，此时其他线程已经无法从树中到达这些结点
+ * @param is_dirty 这些页面是否被修改过
+ */
+void IxIndexHandle::release_latches(Transaction *transaction, bool is_dirty) {
+    auto deleted_pages = transaction->get_index_deleted_page_set();
+    for (Page *page : *deleted_pages) {
+        IxNodeHandle node(file_hdr_, page);
+        release_node_handle(node);
+    }
+    deleted_pages->clear();
+    auto latched_pages = transaction->get_index_latch_page_set();
+    for (Page *page : *latched_pages) {
+        if (page == nullptr) {
+            root_latch_.unlock();
+        } else {
+            page->write_unlatch();
+            buffer_pool_manager_->unpin_page(page->get_page_id(), is_dirty);
+        }
+    }
+    latched_pages->clear();
+    transaction->get_index_child_idx_set()->clear();
+}
+
+/**
+ * @brief 在transaction记录的悲观下降路径上查找node的父结点，以及node在父结点中的下标
+ * 页面中不存放父结点：父结点是路径上的前一个结点，下降时已记录它走向的孩子下标
+ * @param[out] child_idx node在父结点中的下标
+ * @return 父结点的page_no
+ * @note node必须是路径上仍加写锁的非根结点，且父结点在此之前没有分裂或合并，记录的下标仍然有效
+ */
+page_id_t IxIndexHandle::path_parent(IxNodeHandle *node, Transaction *transaction, int *child_idx) {
+    auto latched_pages = transaction->get_index_latch_page_set();
+    auto child_idxs = transaction->get_index_child_idx_set();
+    for (size_t i = 1; i < latched_pages->size(); i++) {
+        if ((*latched_pages)[i] == node->page) {
+            Page *parent = (*latched_pages)[i - 1];
+            assert(parent != nullptr && (*child_idxs)[i - 1] >= 0);
+            *child_idx = (*child_idxs)[i - 1];
+            return parent->get_page_id().page_no;
+        }
+    }
+    throw InternalError("IxIndexHandle::path_parent node is not on the latched path");
 }
 
 /**
@@ -183,54 +508,169 @@ std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, O
  * @return bool 返回目标键值对是否存在
  */
 bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transaction *transaction) {
-    // Todo:
-    // 1. 获取目标key值所在的叶子结点
-    // 2. 在叶子节点中查找目标key值的位置，并读取key对应的rid
-    // 3. 把rid存入result参数中
-    // 提示：使用完buffer_pool提供的page之后，记得unpin page；记得处理并发的上锁
-
-    return false;
+    char norm_key[IX_MAX_COL_LEN];
+    normalize_key(key, norm_key);
+    key = norm_key;
+    IxNodeHandle *leaf = find_leaf_page(key, Operation::FIND, transaction).first;
+    Rid *rid;
+    bool found = leaf->leaf_lookup(key, &rid);
+    if (found) {
+        result->push_back(*rid);
+    }
+    leaf->page->read_unlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+    delete leaf;
+    return found;
 }
 
 /**
- * @brief  将传入的一个node拆分(Split)成两个结点，在node的右边生成一个新结点new node
+ * @brief 在node的pos位置插入(key, rid)之后放不下时调用：把插入后的键值对序列拆分(Split)成两个结点，
+ * 左半部分留在node中，右半部分放到node右边新生成的结点new node中，两个结点都重新计算公共前缀
+ * 在两边都不少于min_size的分裂点中选择相邻两个key的公共前缀最短的位置(最短的分隔key)，
+ * 使两个结点各自的公共前缀尽量长，相同时取最靠近中间的位置。
+ * 插入的key缩短了结点的公共前缀时可能没有满足上述条件的分裂点，此时key一定位于两端，
+ * 退而选择最靠近中间的、两边都能放下的分裂点(至少key单独成为一个结点是可行的)。
+ * 叶子结点的分隔key截断为能区分两侧相邻key的最短前缀；内部结点把new node的第0个key(不参与压缩)上移作为分隔key。
+ * 页面中不存放父结点，内部结点分裂时移到new node的孩子结点不需要修改
  * @param node 需要拆分的结点
- * @return 拆分得到的new_node
+ * @param (pos, key, rid) 要插入的位置和键值对
+ * @param[out] sep_key 要插入父结点的分隔key
+ * @return 拆分得到的new_node，已加写锁
  * @note need to unpin the new node outside
- * 注意：本函数执行完毕后，原node和new node都需要在函数外面进行unpin
+ * 注意：本函数执行完毕后，原node和new node都需要在函数外面进行unpin，new node还需要释放写锁。
+ * 插入的键值对在node中当且仅当pos < node->get_size()
  */
-IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
-    // Todo:
-    // 1. 将原结点的键值对平均分配，右半部分分裂为新的右兄弟结点
-    //    需要初始化新节点的page_hdr内容
-    // 2. 如果新的右兄弟结点是叶子结点，更新新旧节点的prev_leaf和next_leaf指针
-    //    为新节点分配键值对，更新旧节点的键值对数记录
-    // 3. 如果新的右兄弟结点不是叶子结点，更新该结点的所有孩子结点的父节点信息(使用IxIndexHandle::maintain_child())
+IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node, int pos, const char *key, const Rid &rid, char *sep_key) {
+    const int key_len = file_hdr_->col_tot_len_;
+    const int total = node->get_size() + 1;
+    std::vector<char> keys(static_cast<size_t>(total) * key_len);
+    std::vector<Rid> rids(total);
+    auto key_of = [&](int i) { return keys.data() + static_cast<size_t>(i) * key_len; };
+    for (int i = 0, j = 0; i < total; i++) {
+        if (i == pos) {
+            memcpy(key_of(i), key, key_len);
+            rids[i] = rid;
+        } else {
+            node->get_key(j, key_of(i));
+            rids[i] = *node->get_rid(j);
+            j++;
+        }
+    }
+
+    const bool is_leaf = node->is_leaf_page();
+    const int first = node->first_key_idx();
+    const int mid = total / 2;
+    // [begin, end)中的键值对放进一个结点后是否小于max_size，内部结点的第0个key不参与压缩
+    auto fits = [&](int begin, int end) {
+        int prefix_len = begin + first < end ? common_prefix_len(key_of(begin + first), key_of(end - 1), key_len) : 0;
+        return end - begin < IxNodeHandle::max_size(file_hdr_, prefix_len);
+    };
+    int min_size = node->get_min_size();
+    int best_sep_len = key_len + 1;
+    int left_size = -1;
+    for (int i = std::max(1, min_size); i <= std::min(total - 1, total - min_size); i++) {
+        if (!fits(0, i) || !fits(i, total)) {
+            continue;
+        }
+        int sep_len = common_prefix_len(key_of(i - 1), key_of(i), key_len);
+        if (sep_len < best_sep_len || (sep_len == best_sep_len && std::abs(i - mid) < std::abs(left_size - mid))) {
+            left_size = i;
+            best_sep_len = sep_len;
+        }
+    }
+    for (int i = 1; left_size == -1 && i < total; i++) {
+        // 从中间向两边尝试
+        int cand = i % 2 == 1 ? mid + i / 2 : mid - i / 2;
+        if (cand >= 1 && cand < total && fits(0, cand) && fits(cand, total)) {
+            left_size = cand;
+        }
+    }
+    assert(left_size != -1);
+    if (is_leaf) {
+        shortest_separator(key_of(left_size - 1), key_of(left_size), key_len, sep_key);
+    } else {
+        memcpy(sep_key, key_of(left_size), key_len);
+    }
 
-    return nullptr;
+    IxNodeHandle *new_node = create_node();
+    *new_node->page_hdr = {
+        .next_free_page_no = IX_NO_PAGE,
+        .num_key = 0,
+        .is_leaf = is_leaf,
+        .prev_leaf = IX_NO_PAGE,
+        .next_leaf = IX_NO_PAGE,
+        .prefix_len = 0,
+    };
+    new_node->insert_pairs(0, key_of(left_size), rids.data() + left_size, total - left_size);
+    node->set_size(0);
+    node->insert_pairs(0, key_of(0), rids.data(), left_size);
+
+    if (is_leaf) {
+        // 新结点填好之后再接入叶子链表，沿链表扫描的线程看到的总是完整的结点
+        new_node->set_prev_leaf(node->get_page_no());
+        new_node->set_next_leaf(node->get_next_leaf());
+        set_prev_of_next_leaf(node, new_node->get_page_no());
+        node->set_next_leaf(new_node->get_page_no());
+        if (file_hdr_->last_leaf_ == node->get_page_no()) {
+            file_hdr_->last_leaf_ = new_node->get_page_no();
+        }
+    }
+    return new_node;
 }
 
 /**
  * @brief Insert key & value pair into internal page after split
  * 拆分(Split)后，向上找到old_node的父结点
- * 将new_node的第一个key插入到父结点，其位置在 父结点指向old_node的孩子指针 之后
- * 如果插入后>=maxsize，则必须继续拆分父结点，然后在其父结点的父结点再插入，即需要递归
+ * 将old_node和new_node之间的分隔key插入到父结点，其位置在 父结点指向old_node的孩子指针 之后
+ * 如果父结点放不下，则在插入的同时拆分父结点，然后在其父结点的父结点再插入，即需要递归
  * 直到找到的old_node为根结点时，结束递归（此时将会新建一个根R，关键字为key，old_node和new_node为其孩子）
  *
  * @param (old_node, new_node) 原结点为old_node，old_node被分裂之后产生了新的右兄弟结点new_node
- * @param key 要插入parent的key
+ * @param key 要插入parent的分隔key，由split()给出
  * @note 一个结点插入了键值对之后需要分裂，分裂后左半部分的键值对保留在原结点，在参数中称为old_node，
  * 右半部分的键值对分裂为新的右兄弟节点，在参数中称为new_node（参考Split函数来理解old_node和new_node）
  * @note 本函数执行完毕后，new node和old node都需要在函数外面进行unpin
  */
 void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node,
                                      Transaction *transaction) {
-    // Todo:
-    // 1. 分裂前的结点（原结点, old_node）是否为根结点，如果为根结点需要分配新的root
-    // 2. 获取原结点（old_node）的父亲结点
-    // 3. 获取key对应的rid，并将(key, rid)插入到父亲结点
-    // 4. 如果父亲结点仍需要继续分裂，则进行递归插入
-    // 提示：记得unpin page
+    if (old_node->is_root_page()) {
+        // 根结点分裂时一定持有root_latch_的写锁(分裂的根结点不安全)
+        IxNodeHandle *new_root = create_node();
+        *new_root->page_hdr = {
+            .next_free_page_no = IX_NO_PAGE,
+            .num_key = 0,
+            .is_leaf = false,
+            .prev_leaf = IX_NO_PAGE,
+            .next_leaf = IX_NO_PAGE,
+            .prefix_len = 0,
+        };
+        // 第0个key不参与比较，与分隔key取相同的值
+        char keys[2 * IX_MAX_COL_LEN];
+        memcpy(keys, key, file_hdr_->col_tot_len_);
+        memcpy(keys + file_hdr_->col_tot_len_, key, file_hdr_->col_tot_len_);
+        Rid rids[2] = {{old_node->get_page_no(), -1}, {new_node->get_page_no(), -1}};
+        new_root->insert_pairs(0, keys, rids, 2);
+        update_root_page_no(new_root->get_page_no());
+        transaction->append_index_latch_page_set(new_root->page);
+        delete new_root;
+        return;
+    }
+
+    // old_node不安全，其父结点的写锁仍记录在transaction中
+    int rank;
+    IxNodeHandle *parent = fetch_node(path_parent(old_node, transaction, &rank));
+    Rid rid = {new_node->get_page_no(), -1};
+    if (parent->has_room_for(key)) {
+        parent->insert_pair(rank + 1, key, rid);
+    } else {
+        char new_parent_key[IX_MAX_COL_LEN];
+        IxNodeHandle *new_parent = split(parent, rank + 1, key, rid, new_parent_key);
+        transaction->append_index_latch_page_set(new_parent->page);
+        insert_into_parent(parent, new_parent_key, new_parent, transaction);
+        delete new_parent;
+    }
+    buffer_pool_manager_->unpin_page(parent->get_page_id(), true);
+    delete parent;
 }
 
 /**
@@ -240,13 +680,213 @@ void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key,
  * @return page_id_t 插入到的叶结点的page_no
  */
 page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transaction *transaction) {
-    // Todo:
-    // 1. 查找key值应该插入到哪个叶子节点
-    // 2. 在该叶子节点中插入键值对
-    // 3. 如果结点已满，分裂结点，并把新结点的相关信息插入父节点
-    // 提示：记得unpin page；若当前叶子节点是最右叶子节点，则需要更新file_hdr_.last_leaf；记得处理并发的上锁
+    char norm_key[IX_MAX_COL_LEN];
+    normalize_key(key, norm_key);
+    return insert_norm_entry(norm_key, value, transaction);
+}
 
-    return -1;
+/**
+ * @brief 将n个按key升序排列的键值对插入到B+树中，已存在的key不插入
+ * @param keys n个连续存放的记录格式key，按ix_compare()升序排列
+ * @param rids 与keys一一对应的值
+ * @param n 键值对数量
+ * @param transaction 事务指针
+ * @return int 实际插入的键值对数量，小于n时说明有重复的key
+ */
+int IxIndexHandle::insert_entries(const char *keys, const Rid *rids, int n, Transaction *transaction) {
+    const int key_len = file_hdr_->col_tot_len_;
+    std::vector<char> norm_keys(static_cast<size_t>(n) * key_len);
+    for (int i = 0; i < n; i++) {
+        normalize_key(keys + static_cast<size_t>(i) * key_len, norm_keys.data() + static_cast<size_t>(i) * key_len);
+    }
+    return insert_norm_entries(norm_keys.data(), rids, n, transaction);
+}
+
+/**
+ * @brief 把sorter按规范化key升序给出的键值对插入B+树，用于向非空的索引批量插入；
+ * 空索引应使用bulk_build()。每次从sorter中取出IX_INSERT_BATCH_KEYS个键值对按叶子成批插入。
+ * 已存在的key不插入，调用者应先用has_duplicate()检查，或比较返回值与sorter->size()
+ * @param sorter 已调用finish()的键值对排序器
+ * @param transaction 事务指针
+ * @return size_t 实际插入的键值对数量
+ */
+size_t IxIndexHandle::insert_sorted(IxSorter *sorter, Transaction *transaction) {
+    const int key_len = file_hdr_->col_tot_len_;
+    std::vector<char> keys(static_cast<size_t>(IX_INSERT_BATCH_KEYS) * key_len);
+    std::vector<Rid> rids(IX_INSERT_BATCH_KEYS);
+    const char *key;
+    int n = 0;
+    size_t inserted = 0;
+    while (sorter->next(&key, &rids[n])) {
+        memcpy(keys.data() + static_cast<size_t>(n) * key_len, key, key_len);
+        if (++n == IX_INSERT_BATCH_KEYS) {
+            inserted += insert_norm_entries(keys.data(), rids.data(), n, transaction);
+            n = 0;
+        }
+    }
+    inserted += insert_norm_entries(keys.data(), rids.data(), n, transaction);
+    return inserted;
+}
+
+/**
+ * @brief 将n个按规范化key升序排列的键值对插入到B+树中
+ * 读锁下降到第一个key所在的叶子并加写锁，随后的key只要小于叶子的上界(见descend_read())且叶子放得下，
+ * 就直接插入这个叶子，一个叶子只下降一次；越过上界时从根结点重新下降，叶子需要分裂时由insert_norm_entry()悲观插入这个key
+ * @param (keys, rids) n个连续存放的键值对，key为规范化key
+ * @param transaction 事务指针
+ * @return int 实际插入的键值对数量，已存在的key不插入
+ */
+int IxIndexHandle::insert_norm_entries(const char *keys, const Rid *rids, int n, Transaction *transaction) {
+    const int key_len = file_hdr_->col_tot_len_;
+    char upper_key[IX_MAX_COL_LEN];
+    bool has_upper_key;
+    int inserted = 0;
+    int i = 0;
+    while (i < n) {
+        IxNodeHandle *leaf = descend_read(keys + static_cast<size_t>(i) * key_len, false, true, upper_key, &has_upper_key);
+        bool dirty = false;
+        bool crossed = false;
+        for (int first = i; i < n; i++) {
+            const char *key = keys + static_cast<size_t>(i) * key_len;
+            if (i > first && has_upper_key && ix_key_compare(key, upper_key, key_len) >= 0) {
+                crossed = true;
+                break;
+            }
+            if (!leaf->has_room_for(key)) {
+                break;
+            }
+            int old_size = leaf->get_size();
+            if (leaf->insert(key, rids[i]) != old_size) {
+                dirty = true;
+                inserted++;
+            }
+        }
+        leaf->page->write_unlatch();
+        buffer_pool_manager_->unpin_page(leaf->get_page_id(), dirty);
+        delete leaf;
+        if (i < n && !crossed) {
+            if (insert_norm_entry(keys + static_cast<size_t>(i) * key_len, rids[i], transaction) != IX_NO_PAGE) {
+                inserted++;
+            }
+            i++;
+        }
+    }
+    return inserted;
+}
+
+/**
+ * @brief 索引中没有任何键值对，且除初始页面外没有分配过页面，满足bulk_build()的要求
+ */
+bool IxIndexHandle::can_bulk_build() {
+    if (file_hdr_->num_pages_ != IX_INIT_NUM_PAGES || file_hdr_->root_page_ != IX_INIT_ROOT_PAGE) {
+        return false;
+    }
+    std::shared_lock<std::shared_mutex> lock(root_latch_);
+    IxNodeHandle *root = fetch_node(file_hdr_->root_page_);
+    root->page->read_latch();
+    bool empty = root->get_size() == 0;
+    root->page->read_unlatch();
+    buffer_pool_manager_->unpin_page(root->get_page_id(), false);
+    delete root;
+    return empty;
+}
+
+/**
+ * @brief 检查sorter按规范化key升序给出的key之间是否重复，以及是否与索引中已有的key重复，不修改B+树。
+ * 用于批量装载在写入数据之前拒绝重复的key。索引非空时与insert_norm_entries()一样按叶子查找，
+ * 小于叶子上界的key不再从根结点下降
+ * @param sorter 已调用finish()的键值对排序器，检查会取完其中的键值对
+ * @return bool 存在重复的key时返回true
+ */
+bool IxIndexHandle::has_duplicate(IxSorter *sorter) {
+    const int key_len = file_hdr_->col_tot_len_;
+    const bool probe = !can_bulk_build();
+    std::vector<char> prev_key(key_len);
+    char upper_key[IX_MAX_COL_LEN];
+    bool has_upper_key = false;
+    IxNodeHandle *leaf = nullptr;
+    auto release_leaf = [&]() {
+        leaf->page->read_unlatch();
+        buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+        delete leaf;
+        leaf = nullptr;
+    };
+    bool found = false;
+    const char *key;
+    Rid rid;
+    for (size_t i = 0; !found && sorter->next(&key, &rid); i++) {
+        if (i > 0 && ix_key_compare(prev_key.data(), key, key_len) == 0) {
+            found = true;
+            break;
+        }
+        memcpy(prev_key.data(), key, key_len);
+        if (!probe) continue;
+        if (leaf != nullptr && has_upper_key && ix_key_compare(key, upper_key, key_len) >= 0) {
+            release_leaf();
+        }
+        if (leaf == nullptr) {
+            leaf = descend_read(key, false, false, upper_key, &has_upper_key);
+        }
+        Rid *value;
+        found = leaf->leaf_lookup(key, &value);
+    }
+    if (leaf != nullptr) {
+        release_leaf();
+    }
+    return found;
+}
+
+/**
+ * @brief 将规范化key的键值对插入到B+树中
+ * @param (key, value) 要插入的键值对，key为规范化key
+ * @param transaction 事务指针
+ * @return page_id_t 插入到的叶结点的page_no
+ */
+page_id_t IxIndexHandle::insert_norm_entry(const char *key, const Rid &value, Transaction *transaction) {
+    // 乐观插入：读锁下降，只对叶子加写锁，叶子安全时直接插入
+    IxNodeHandle *leaf = descend_read(key, false, true);
+    if (is_safe(leaf, key, Operation::INSERT)) {
+        int old_size = leaf->get_size();
+        bool inserted = leaf->insert(key, value) != old_size;
+        page_id_t page_no = inserted ? leaf->get_page_no() : IX_NO_PAGE;
+        leaf->page->write_unlatch();
+        buffer_pool_manager_->unpin_page(leaf->get_page_id(), inserted);
+        delete leaf;
+        return page_no;
+    }
+    leaf->page->write_unlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+    delete leaf;
+
+    // 叶子需要分裂，从根结点重新悲观下降
+    std::unique_ptr<Transaction> local_txn;
+    if (transaction == nullptr) {
+        local_txn = std::make_unique<Transaction>(INVALID_TXN_ID);
+        transaction = local_txn.get();
+    }
+    leaf = find_leaf_page(key, Operation::INSERT, transaction).first;
+    int pos = leaf->lower_bound(key);
+    if (pos < leaf->get_size() && leaf->compare_key(pos, key) == 0) {
+        release_latches(transaction, false);
+        delete leaf;
+        return IX_NO_PAGE;
+    }
+    page_id_t page_no = leaf->get_page_no();
+    if (leaf->has_room_for(key)) {
+        leaf->insert_pair(pos, key, value);
+    } else {
+        char sep_key[IX_MAX_COL_LEN];
+        IxNodeHandle *new_leaf = split(leaf, pos, key, value, sep_key);
+        transaction->append_index_latch_page_set(new_leaf->page);
+        if (pos >= leaf->get_size()) {
+            page_no = new_leaf->get_page_no();
+        }
+        insert_into_parent(leaf, sep_key, new_leaf, transaction);
+        delete new_leaf;
+    }
+    release_latches(transaction, true);
+    delete leaf;
+    return page_no;
 }
 
 /**
@@ -255,13 +895,43 @@ page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transac
  * @param transaction 事务指针
  */
 bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
-    // Todo:
-    // 1. 获取该键值对所在的叶子结点
-    // 2. 在该叶子结点中删除键值对
-    // 3. 如果删除成功需要调用CoalesceOrRedistribute来进行合并或重分配操作，并根据函数返回结果判断是否有结点需要删除
-    // 4. 如果需要并发，并且需要删除叶子结点，则需要在事务的delete_page_set中添加删除结点的对应页面；记得处理并发的上锁
+    char norm_key[IX_MAX_COL_LEN];
+    normalize_key(key, norm_key);
+    key = norm_key;
+    // 乐观删除：读锁下降，只对叶子加写锁，叶子安全或key不存在时直接返回
+    IxNodeHandle *leaf = descend_read(key, false, true);
+    Rid *rid;
+    bool safe = is_safe(leaf, key, Operation::DELETE);
+    if (safe || !leaf->leaf_lookup(key, &rid)) {
+        int old_size = leaf->get_size();
+        bool deleted = safe && leaf->remove(key) != old_size;
+        leaf->page->write_unlatch();
+        buffer_pool_manager_->unpin_page(leaf->get_page_id(), deleted);
+        delete leaf;
+        return deleted;
+    }
+    leaf->page->write_unlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+    delete leaf;
 
-    return false;
+    // 叶子可能少于半满，从根结点重新悲观下降
+    std::unique_ptr<Transaction> local_txn;
+    if (transaction == nullptr) {
+        local_txn = std::make_unique<Transaction>(INVALID_TXN_ID);
+        transaction = local_txn.get();
+    }
+    leaf = find_leaf_page(key, Operation::DELETE, transaction).first;
+    int pos = leaf->lower_bound(key);
+    if (pos == leaf->get_size() || leaf->compare_key(pos, key) != 0) {
+        release_latches(transaction, false);
+        delete leaf;
+        return false;
+    }
+    leaf->erase_pair(pos);
+    coalesce_or_redistribute(leaf, transaction);
+    release_latches(transaction, true);
+    delete leaf;
+    return true;
 }
 
 /**
@@ -274,19 +944,40 @@ bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
  * @note User needs to first find the sibling of input page.
  * If sibling's size + input page's size >= 2 * page's minsize, then redistribute.
  * Otherwise, merge(Coalesce).
+ * 并发：node少于半满时node不安全，其父结点的写锁仍在transaction中；兄弟结点与node同属该父结点，
+ * 其他线程只能经由父结点到达兄弟结点(沿叶子链表的扫描只短暂持有单个叶子的读锁)，因此这里直接对兄弟结点加写锁，
+ * 并记录到transaction中。被删除的结点记录在transaction的index_deleted_page_set中，在release_latches()中回收
  */
 bool IxIndexHandle::coalesce_or_redistribute(IxNodeHandle *node, Transaction *transaction, bool *root_is_latched) {
-    // Todo:
-    // 1. 判断node结点是否为根节点
-    //    1.1 如果是根节点，需要调用AdjustRoot() 函数来进行处理，返回根节点是否需要被删除
-    //    1.2 如果不是根节点，并且不需要执行合并或重分配操作，则直接返回false，否则执行2
-    // 2. 获取node结点的父亲结点
-    // 3. 寻找node结点的兄弟结点（优先选取前驱结点）
-    // 4. 如果node结点和兄弟结点的键值对数量之和，能够支撑两个B+树结点（即node.size+neighbor.size >=
-    // NodeMinSize*2)，则只需要重新分配键值对（调用Redistribute函数）
-    // 5. 如果不满足上述条件，则需要合并两个结点，将右边的结点合并到左边的结点（调用Coalesce函数）
+    if (node->is_root_page()) {
+        bool root_deleted = adjust_root(node);
+        if (root_deleted) {
+            transaction->append_index_deleted_page(node->page);
+        }
+        return root_deleted;
+    }
+    if (node->get_size() >= node->get_min_size()) {
+        return false;
+    }
 
-    return false;
+    int index;
+    IxNodeHandle *parent = fetch_node(path_parent(node, transaction, &index));
+    IxNodeHandle *neighbor = fetch_node(parent->value_at(index == 0 ? 1 : index - 1));
+    neighbor->page->write_latch();
+    transaction->append_index_latch_page_set(neighbor->page);
+
+    bool node_deleted = false;
+    if (node->get_size() + neighbor->get_size() >= node->get_min_size() * 2) {
+        redistribute(neighbor, node, parent, index, transaction);
+    } else {
+        IxNodeHandle *left = neighbor, *right = node;
+        coalesce(&left, &right, &parent, index, transaction, root_is_latched);
+        node_deleted = right == node;
+    }
+    buffer_pool_manager_->unpin_page(parent->get_page_id(), true);
+    delete parent;
+    delete neighbor;
+    return node_deleted;
 }
 
 /**
@@ -296,11 +987,12 @@ bool IxIndexHandle::coalesce_or_redistribute(IxNodeHandle *node, Transaction *tr
  * @note size of root page can be less than min size and this method is only called within coalesce_or_redistribute()
  */
 bool IxIndexHandle::adjust_root(IxNodeHandle *old_root_node) {
-    // Todo:
-    // 1. 如果old_root_node是内部结点，并且大小为1，则直接把它的孩子更新成新的根结点
-    // 2. 如果old_root_node是叶结点，且大小为0，则直接更新root page
-    // 3. 除了上述两种情况，不需要进行操作
-
+    // 内部根结点只剩一个孩子时才会走到这里，此时持有root_latch_的写锁(删除前根结点只有两个孩子，不安全)
+    if (!old_root_node->is_leaf_page() && old_root_node->get_size() == 1) {
+        update_root_page_no(old_root_node->remove_and_return_only_child());
+        return true;
+    }
+    // 叶子根结点删空后仍保留为根结点，树中始终至少有一个叶子，root_page_不会变为IX_NO_PAGE
     return false;
 }
 
@@ -316,14 +1008,65 @@ bool IxIndexHandle::adjust_root(IxNodeHandle *old_root_node) {
  * @note node是之前刚被删除过一个key的结点
  * index=0，则neighbor是node后继结点，表示：node(left)      neighbor(right)
  * index>0，则neighbor是node前驱结点，表示：neighbor(left)  node(right)
- * 注意更新parent结点的相关kv对
+ * 注意更新parent结点的相关kv对：叶子之间的分隔key按移动后两侧相邻的key重新截断；
+ * 内部结点移动的孩子原来的分隔key在parent中，parent中的分隔key改为移动后右结点第一个孩子的分隔key。
+ * 新的分隔key可能缩短parent的公共前缀，parent放不下时不重新分配，node暂时少于半满
  */
-void IxIndexHandle::redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node, IxNodeHandle *parent, int index) {
-    // Todo:
-    // 1. 通过index判断neighbor_node是否为node的前驱结点
-    // 2. 从neighbor_node中移动一个键值对到node结点中
-    // 3. 更新父节点中的相关信息，并且修改移动键值对对应孩字结点的父结点信息（maintain_child函数）
-    // 注意：neighbor_node的位置不同，需要移动的键值对不同，需要分类讨论
+void IxIndexHandle::redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node, IxNodeHandle *parent, int index,
+                                 Transaction *transaction) {
+    const int key_len = file_hdr_->col_tot_len_;
+    const bool is_leaf = node->is_leaf_page();
+    char key[IX_MAX_COL_LEN], next_key[IX_MAX_COL_LEN], sep_key[IX_MAX_COL_LEN];
+    if (index == 0) {
+        // node(left) neighbor(right)：neighbor的第一个键值对移到node末尾
+        neighbor_node->get_key(1, next_key);
+        if (is_leaf) {
+            neighbor_node->get_key(0, key);
+            shortest_separator(key, next_key, key_len, sep_key);
+        } else {
+            parent->get_key(index + 1, key);
+            memcpy(sep_key, next_key, key_len);
+        }
+        if (!parent->can_replace_key(sep_key)) {
+            return;
+        }
+        node->insert_pair(node->get_size(), key, *neighbor_node->get_rid(0));
+        neighbor_node->erase_pair(0);
+        parent->set_key(index + 1, sep_key);
+    } else {
+        // neighbor(left) node(right)：neighbor的最后一个键值对移到node开头
+        int last = neighbor_node->get_size() - 1;
+        neighbor_node->get_key(last, key);
+        if (is_leaf) {
+            neighbor_node->get_key(last - 1, next_key);
+            shortest_separator(next_key, key, key_len, sep_key);
+        } else {
+            memcpy(sep_key, key, key_len);
+        }
+        if (!parent->can_replace_key(sep_key)) {
+            return;
+        }
+        if (is_leaf) {
+            node->insert_pair(0, key, *neighbor_node->get_rid(last));
+        } else {
+            // 内部结点的第0个key不参与压缩，原来的第0个孩子移到第1个，其分隔key取自parent，整个结点重新写入
+            int size = node->get_size();
+            std::vector<char> keys(static_cast<size_t>(size + 1) * key_len);
+            std::vector<Rid> rids(size + 1);
+            memcpy(keys.data(), key, key_len);
+            parent->get_key(index, keys.data() + key_len);
+            rids[0] = *neighbor_node->get_rid(last);
+            rids[1] = *node->get_rid(0);
+            for (int i = 1; i < size; i++) {
+                node->get_key(i, keys.data() + static_cast<size_t>(i + 1) * key_len);
+                rids[i + 1] = *node->get_rid(i);
+            }
+            node->set_size(0);
+            node->insert_pairs(0, keys.data(), rids.data(), size + 1);
+        }
+        neighbor_node->erase_pair(last);
+        parent->set_key(index, sep_key);
+    }
 }
 
 /**
@@ -342,13 +1085,31 @@ void IxIndexHandle::redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node
  */
 bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node, IxNodeHandle **parent, int index,
                              Transaction *transaction, bool *root_is_latched) {
-    // Todo:
-    // 1. 用index判断neighbor_node是否为node的前驱结点，若不是则交换两个结点，让neighbor_node作为左结点，node作为右结点
-    // 2. 把node结点的键值对移动到neighbor_node中，并更新node结点孩子结点的父节点信息（调用maintain_child函数）
-    // 3. 释放和删除node结点，并删除parent中node结点的信息，返回parent是否需要被删除
-    // 提示：如果是叶子结点且为最右叶子结点，需要更新file_hdr_.last_leaf
-
-    return false;
+    if (index == 0) {
+        std::swap(*neighbor_node, *node);
+        index = 1;
+    }
+    IxNodeHandle *left = *neighbor_node, *right = *node;
+    int left_size = left->get_size();
+    const int key_len = file_hdr_->col_tot_len_;
+    std::vector<char> right_keys(static_cast<size_t>(right->get_size()) * key_len);
+    for (int i = 0; i < right->get_size(); i++) {
+        right->get_key(i, right_keys.data() + static_cast<size_t>(i) * key_len);
+    }
+    if (!right->is_leaf_page()) {
+        (*parent)->get_key(index, right_keys.data());  // 右结点第0个孩子的分隔key在parent中
+    }
+    left->insert_pairs(left_size, right_keys.data(), right->get_rid(0), right->get_size());
+    if (right->is_leaf_page()) {
+        erase_leaf(right);
+        if (file_hdr_->last_leaf_ == right->get_page_no()) {
+            file_hdr_->last_leaf_ = left->get_page_no();
+        }
+    }
+    transaction->append_index_deleted_page(right->page);
+    // 删除的总是右结点，index>=1，parent的第一个key不变
+    (*parent)->erase_pair(index);
+    return coalesce_or_redistribute(*parent, transaction, root_is_latched);
 }
 
 /**
@@ -361,12 +1122,12 @@ bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node,
  * @note iid和rid存的不是一个东西，rid是上层传过来的记录位置，iid是索引内部生成的索引槽位置
  */
 Rid IxIndexHandle::get_rid(const Iid &iid) const {
-    IxNodeHandle *node = fetch_node(iid.page_no);
-    if (iid.slot_no >= node->get_size()) {
+    ReadPageGuard guard = buffer_pool_manager_->fetch_page_read(PageId{fd_, iid.page_no});
+    IxNodeHandle node(file_hdr_, guard.get());
+    if (iid.slot_no >= node.get_size()) {
         throw IndexEntryNotFoundError();
     }
-    buffer_pool_manager_->unpin_page(node->get_page_id(), false);  // unpin it!
-    return *node->get_rid(iid.slot_no);
+    return *node.get_rid(iid.slot_no);
 }
 
 /**
@@ -374,12 +1135,23 @@ Rid IxIndexHandle::get_rid(const Iid &iid) const {
  *
  * @param key
  * @return Iid
- * @note 上层传入的key本来是int类型，通过(const char *)&key进行了转换
- * 可用*(int *)key转换回去
+ * @note 上层传入的key为记录格式，先编码为规范化key再查找
  */
 Iid IxIndexHandle::lower_bound(const char *key) {
-
-    return Iid{-1, -1};
+    char norm_key[IX_MAX_COL_LEN];
+    normalize_key(key, norm_key);
+    key = norm_key;
+    IxNodeHandle *leaf = find_leaf_page(key, Operation::FIND, nullptr).first;
+    int key_idx = leaf->lower_bound(key);
+    Iid iid = {.page_no = leaf->get_page_no(), .slot_no = key_idx};
+    if (key_idx == leaf->get_size() && leaf->get_page_no() != file_hdr_->last_leaf_) {
+        // 大于叶子中的所有key，位置在下一个叶子的开头
+        iid = {.page_no = leaf->get_next_leaf(), .slot_no = 0};
+    }
+    leaf->page->read_unlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+    delete leaf;
+    return iid;
 }
 
 /**
@@ -389,8 +1161,23 @@ Iid IxIndexHandle::lower_bound(const char *key) {
  * @return Iid
  */
 Iid IxIndexHandle::upper_bound(const char *key) {
-    
-    return Iid{-1, -1};
+    char norm_key[IX_MAX_COL_LEN];
+    normalize_key(key, norm_key);
+    key = norm_key;
+    IxNodeHandle *leaf = find_leaf_page(key, Operation::FIND, nullptr).first;
+    // 叶子中的upper_bound需要从0开始，这里用lower_bound跳过相等的key
+    int key_idx = leaf->lower_bound(key);
+    if (key_idx < leaf->get_size() && leaf->compare_key(key_idx, key) == 0) {
+        key_idx++;
+    }
+    Iid iid = {.page_no = leaf->get_page_no(), .slot_no = key_idx};
+    if (key_idx == leaf->get_size() && leaf->get_page_no() != file_hdr_->last_leaf_) {
+        iid = {.page_no = leaf->get_next_leaf(), .slot_no = 0};
+    }
+    leaf->page->read_unlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+    delete leaf;
+    return iid;
 }
 
 /**
@@ -400,10 +1187,9 @@ Iid IxIndexHandle::upper_bound(const char *key) {
  * @return Iid
  */
 Iid IxIndexHandle::leaf_end() const {
-    IxNodeHandle *node = fetch_node(file_hdr_->last_leaf_);
-    Iid iid = {.page_no = file_hdr_->last_leaf_, .slot_no = node->get_size()};
-    buffer_pool_manager_->unpin_page(node->get_page_id(), false);  // unpin it!
-    return iid;
+    ReadPageGuard guard = buffer_pool_manager_->fetch_page_read(PageId{fd_, file_hdr_->last_leaf_});
+    IxNodeHandle node(file_hdr_, guard.get());
+    return Iid{.page_no = file_hdr_->last_leaf_, .slot_no = node.get_size()};
 }
 
 /**
@@ -417,6 +1203,233 @@ Iid IxIndexHandle::leaf_begin() const {
     return iid;
 }
 
+/**
+ * @brief 自底向上批量构建B+树，要求当前B+树为空
+ * 键值对由sorter按规范化key升序给出，直接写入结点。叶子层顺序消费sorter，贪心地向当前叶子追加键值对，
+ * 直到按追加后的公共前缀算出的容量达到fill_factor，因此共享长前缀的key在一个叶子中装得更多；
+ * 剩余的键值对不足min_size时与最后一个叶子合并或从中借一部分，保证每个叶子至少半满。
+ * 相邻两个叶子之间的分隔key由前一个叶子的最后一个key和后一个叶子的第一个key截断得到，
+ * 每个内部结点以其第一个孩子的分隔key作为自己的分隔key。内部结点同样按分隔key的公共前缀贪心地装入孩子，
+ * 每层最后一个结点不足min_size时与前一个结点合并或从中借一部分。
+ * 第一个叶子使用初始根结点的页面，与叶子链表头一起经过缓冲池修改；其余页面在文件末尾按构建顺序分配，
+ * 不经过缓冲池，按页号顺序批量写盘
+ *
+ * @param sorter 已调用finish()的键值对排序器
+ * @param fill_factor 结点的填充率
+ * @note key不允许重复，出现重复key时抛出IndexDuplicateKeyError。初始页面和文件头只在接受最后一个key之后修改，
+ * 抛出异常时索引仍为空；已经写盘的页面位于文件头记录的num_pages_之外，不会被读到
+ */
+void IxIndexHandle::bulk_build(IxSorter *sorter, double fill_factor) {
+    if (!can_bulk_build()) {
+        throw InternalError("IxIndexHandle::bulk_build requires an empty index");
+    }
+    const size_t n = sorter->size();
+    if (n == 0) return;
+    const int key_len = file_hdr_->col_tot_len_;
+    const int min_size = IxNodeHandle::max_size(file_hdr_, 0) / 2;
+    // 公共前缀长度为prefix_len时一个结点装入的键值对个数
+    auto node_limit = [&](int prefix_len) {
+        int max_keys = IxNodeHandle::max_size(file_hdr_, prefix_len) - 1;
+        return std::max(min_size, std::min(max_keys, static_cast<int>(max_keys * fill_factor)));
+    };
+
+    if (disk_manager_->get_fd2pageno(fd_) < file_hdr_->num_pages_) {
+        disk_manager_->set_fd2pageno(fd_, file_hdr_->num_pages_);
+    }
+    std::unique_ptr<char, decltype(&free)> pages(
+        static_cast<char *>(aligned_alloc(PAGE_SIZE, static_cast<size_t>(IX_BULK_WRITE_PAGES) * PAGE_SIZE)), &free);
+    if (pages == nullptr) {
+        throw InternalError("IxIndexHandle::bulk_build out of memory");
+    }
+    std::vector<PageIORequest> requests;
+    auto flush_requests = [&]() {
+        disk_manager_->write_pages(fd_, requests.data(), static_cast<int>(requests.size()));
+        requests.clear();
+    };
+    // 取出下一个页面缓冲区并初始化页头
+    auto begin_node = [&](page_id_t page_no, bool is_leaf) {
+        if (requests.size() == static_cast<size_t>(IX_BULK_WRITE_PAGES)) {
+            flush_requests();
+        }
+        char *data = pages.get() + requests.size() * PAGE_SIZE;
+        memset(data, 0, PAGE_SIZE);
+        auto page_hdr = reinterpret_cast<IxPageHdr *>(data);
+        page_hdr->next_free_page_no = IX_NO_PAGE;
+        page_hdr->is_leaf = is_leaf;
+        page_hdr->prev_leaf = IX_NO_PAGE;
+        page_hdr->next_leaf = IX_NO_PAGE;
+        requests.push_back(PageIORequest{page_no, data});
+        return IxNodeHandle(file_hdr_, data);
+    };
+
+    // 叶子层：第一个叶子可能已在缓冲池中，写完后经由缓冲池修改；
+    // 正在填充的叶子总是批量写缓冲区中的最后一页，开始下一个叶子之前不会被写盘
+    std::vector<page_id_t> leaf_pages;
+    std::vector<char> seps;  // 第i个叶子与前一个叶子之间的分隔key，第0个不参与比较
+    std::vector<char> prev_last_key(key_len);
+    std::vector<char> first_leaf(PAGE_SIZE);  // 第一个叶子在接受最后一个key之后才写入缓冲池
+    IxNodeHandle leaf;
+    auto finish_leaf = [&]() {
+        seps.resize(leaf_pages.size() * key_len);
+        char *sep = seps.data() + (leaf_pages.size() - 1) * key_len;
+        char first_key[IX_MAX_COL_LEN];
+        leaf.get_key(0, first_key);
+        if (leaf_pages.size() == 1) {
+            memcpy(sep, first_key, key_len);
+        } else {
+            shortest_separator(prev_last_key.data(), first_key, key_len, sep);
+        }
+        leaf.get_key(leaf.get_size() - 1, prev_last_key.data());
+        if (leaf_pages.size() == 1) {
+            memcpy(first_leaf.data(), requests.front().buf, PAGE_SIZE);
+            requests.erase(requests.begin());
+        }
+    };
+    auto start_leaf = [&]() {
+        page_id_t page_no = leaf_pages.empty() ? IX_INIT_ROOT_PAGE : disk_manager_->allocate_page(fd_);
+        page_id_t prev_leaf = IX_LEAF_HEADER_PAGE;
+        if (!leaf_pages.empty()) {
+            prev_leaf = leaf_pages.back();
+            leaf.set_next_leaf(page_no);
+            finish_leaf();
+        }
+        leaf = begin_node(page_no, true);
+        leaf.set_prev_leaf(prev_leaf);
+        leaf.set_next_leaf(IX_LEAF_HEADER_PAGE);
+        leaf_pages.push_back(page_no);
+    };
+
+    std::vector<char> prev_key(key_len);
+    bool tail = false;  // 已进入最后一个叶子，剩余键值对全部追加到当前叶子
+    start_leaf();
+    for (size_t i = 0; i < n; i++) {
+        const char *key;
+        Rid rid;
+        if (!sorter->next(&key, &rid)) {
+            throw InternalError("IxIndexHandle::bulk_build sorter ended early");
+        }
+        if (i > 0 && ix_key_compare(prev_key.data(), key, key_len) == 0) {
+            throw IndexDuplicateKeyError();
+        }
+        memcpy(prev_key.data(), key, key_len);
+        if (!tail && leaf.get_size() + 1 > node_limit(leaf.prefix_len_with(key))) {
+            const int remain = static_cast<int>(std::min(n - i, static_cast<size_t>(min_size)));
+            if (remain < min_size) {
+                tail = true;
+                if (leaf.get_size() + remain < IxNodeHandle::max_size(file_hdr_, 0)) {
+                    // 剩余的键值对在任何前缀下都能放入当前叶子
+                    leaf.insert_pair(leaf.get_size(), key, rid);
+                    continue;
+                }
+                // 从当前叶子末尾移出一部分，使最后一个叶子恰好半满
+                const int moved = min_size - remain;
+                const int kept = leaf.get_size() - moved;
+                std::vector<char> moved_keys(moved * key_len);
+                std::vector<Rid> moved_rids(moved);
+                for (int j = 0; j < moved; j++) {
+                    leaf.get_key(kept + j, moved_keys.data() + j * key_len);
+                    moved_rids[j] = *leaf.get_rid(kept + j);
+                }
+                leaf.set_size(kept);
+                start_leaf();
+                leaf.insert_pairs(0, moved_keys.data(), moved_rids.data(), moved);
+            } else {
+                start_leaf();
+            }
+        }
+        leaf.insert_pair(leaf.get_size(), key, rid);
+    }
+    finish_leaf();
+    {
+        WritePageGuard guard = buffer_pool_manager_->fetch_page_write(PageId{fd_, IX_INIT_ROOT_PAGE});
+        memcpy(guard.get_data(), first_leaf.data(), PAGE_SIZE);
+        guard.mark_dirty();
+    }
+    {
+        WritePageGuard guard = buffer_pool_manager_->fetch_page_write(PageId{fd_, IX_LEAF_HEADER_PAGE});
+        auto page_hdr = reinterpret_cast<IxPageHdr *>(guard.get_data());
+        page_hdr->next_leaf = leaf_pages.front();
+        page_hdr->prev_leaf = leaf_pages.back();
+        guard.mark_dirty();
+    }
+
+    // 把一层的m个孩子按分隔key贪心地分给结点，返回每个结点第一个孩子的下标，最后追加m
+    auto group_children = [&](const std::vector<char> &child_seps, size_t m) {
+        auto sep_of = [&](size_t j) { return child_seps.data() + j * key_len; };
+        std::vector<size_t> starts = {0};
+        for (size_t j = 1; j < m; j++) {
+            // 加入第j个孩子之后参与压缩的是第starts.back()+1到第j个孩子的分隔key
+            size_t cnt = j - starts.back();
+            int prefix_len = cnt == 1 ? key_len : common_prefix_len(sep_of(starts.back() + 1), sep_of(j), key_len);
+            if (static_cast<int>(cnt) + 1 > node_limit(prefix_len)) {
+                starts.push_back(j);
+            }
+        }
+        size_t k = starts.size();
+        if (k > 1 && m - starts[k - 1] < static_cast<size_t>(min_size)) {
+            if (m - starts[k - 2] < static_cast<size_t>(2 * min_size)) {
+                starts.pop_back();
+            } else {
+                starts[k - 1] = m - min_size;
+            }
+        }
+        starts.push_back(m);
+        return starts;
+    };
+
+    // 每层的结点个数，level 0为叶子层，最后一层只有根结点；
+    // 第level层的第i个结点包含第level-1层的[starts[i], starts[i+1])个结点，分隔key为其中第一个结点的分隔key
+    std::vector<size_t> level_nodes = {leaf_pages.size()};
+    std::vector<std::vector<size_t>> level_starts(1);
+    std::vector<std::vector<char>> level_seps;
+    level_seps.push_back(std::move(seps));
+    while (level_nodes.back() > 1) {
+        std::vector<size_t> starts = group_children(level_seps.back(), level_nodes.back());
+        std::vector<char> node_seps((starts.size() - 1) * key_len);
+        for (size_t i = 0; i + 1 < starts.size(); i++) {
+            memcpy(node_seps.data() + i * key_len, level_seps.back().data() + starts[i] * key_len, key_len);
+        }
+        level_nodes.push_back(starts.size() - 1);
+        level_starts.push_back(std::move(starts));
+        level_seps.push_back(std::move(node_seps));
+    }
+    const size_t num_levels = level_nodes.size();
+    std::vector<std::vector<page_id_t>> level_pages(num_levels);
+    level_pages[0] = leaf_pages;
+    for (size_t level = 1; level < num_levels; level++) {
+        level_pages[level].resize(level_nodes[level]);
+        for (size_t i = 0; i < level_nodes[level]; i++) {
+            level_pages[level][i] = disk_manager_->allocate_page(fd_);
+        }
+    }
+
+    // 内部结点层，第i个孩子的key为该孩子与前一个孩子之间的分隔key
+    for (size_t level = 1; level < num_levels; level++) {
+        const std::vector<size_t> &starts = level_starts[level];
+        std::vector<Rid> rids;
+        for (size_t i = 0; i < level_nodes[level]; i++) {
+            IxNodeHandle node = begin_node(level_pages[level][i], false);
+            size_t start = starts[i];
+            size_t cnt = starts[i + 1] - start;
+            rids.clear();
+            for (size_t j = 0; j < cnt; j++) {
+                rids.push_back(Rid{level_pages[level - 1][start + j], -1});
+            }
+            node.insert_pairs(0, level_seps[level - 1].data() + start * key_len, rids.data(), static_cast<int>(cnt));
+        }
+    }
+    if (!requests.empty()) {
+        flush_requests();
+    }
+
+    size_t num_new_pages = 0;
+    for (size_t cnt : level_nodes) num_new_pages += cnt;
+    file_hdr_->num_pages_ += static_cast<int>(num_new_pages - 1);
+    file_hdr_->root_page_ = level_pages.back().front();
+    file_hdr_->first_leaf_ = leaf_pages.front();
+    file_hdr_->last_leaf_ = leaf_pages.back();
+}
+
 /**
  * @brief 获取一个指定结点
  *
@@ -434,48 +1447,40 @@ IxNodeHandle *IxIndexHandle::fetch_node(int page_no) const {
 /**
  * @brief 创建一个新结点
  *
- * @return IxNodeHandle*
+ * @return IxNodeHandle*，已加写锁
  * @note pin the page, remember to unpin it outside!
  * 注意：对于Index的处理是，删除某个页面后，认为该被删除的页面是free_page
  * 而first_free_page实际上就是最新被删除的页面，初始为IX_NO_PAGE
  * 在最开始插入时，一直是create node，那么first_page_no一直没变，一直是IX_NO_PAGE
  * 与Record的处理不同，Record将未插入满的记录页认为是free_page
+ * 复用的空闲页面可能仍被删除它的线程加着写锁(见release_latches())，在page_alloc_latch_之外等待
  */
 IxNodeHandle *IxIndexHandle::create_node() {
-    IxNodeHandle *node;
-    file_hdr_->num_pages_++;
+    IxNodeHandle *node = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(page_alloc_latch_);
+        file_hdr_->num_pages_++;
+        // 优先复用被删除结点的页面，空闲页面通过页头的next_free_page_no串成链表
+        if (file_hdr_->first_free_page_no_ != IX_NO_PAGE) {
+            node = fetch_node(file_hdr_->first_free_page_no_);
+            file_hdr_->first_free_page_no_ = node->page_hdr->next_free_page_no;
+        }
+    }
+    if (node != nullptr) {
+        node->page->write_latch();
+        node->page_hdr->next_free_page_no = IX_NO_PAGE;
+        buffer_pool_manager_->mark_dirty(node->page);
+        return node;
+    }
 
     PageId new_page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
     // 从3开始分配page_no，第一次分配之后，new_page_id.page_no=3，file_hdr_.num_pages=4
     Page *page = buffer_pool_manager_->new_page(&new_page_id);
+    page->write_latch();
     node = new IxNodeHandle(file_hdr_, page);
     return node;
 }
 
-/**
- * @brief 从node开始更新其父节点的第一个key，一直向上更新直到根节点
- *
- * @param node
- */
-void IxIndexHandle::maintain_parent(IxNodeHandle *node) {
-    IxNodeHandle *curr = node;
-    while (curr->get_parent_page_no() != IX_NO_PAGE) {
-        // Load its parent
-        IxNodeHandle *parent = fetch_node(curr->get_parent_page_no());
-        int rank = parent->find_child(curr);
-        char *parent_key = parent->get_key(rank);
-        char *child_first_key = curr->get_key(0);
-        if (memcmp(parent_key, child_first_key, file_hdr_->col_tot_len_) == 0) {
-            assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
-            break;
-        }
-        memcpy(parent_key, child_first_key, file_hdr_->col_tot_len_);  // 修改了parent node
-        curr = parent;
-
-        assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
-    }
-}
-
 /**
  * @brief 要删除leaf之前调用此函数，更新leaf前驱结点的next指针和后继结点的prev指针
  *
@@ -484,33 +1489,40 @@ void IxIndexHandle::maintain_parent(IxNodeHandle *node) {
 void IxIndexHandle::erase_leaf(IxNodeHandle *leaf) {
     assert(leaf->is_leaf_page());
 
+    // 前驱结点是与leaf合并的左兄弟，调用者已持有其写锁
     IxNodeHandle *prev = fetch_node(leaf->get_prev_leaf());
     prev->set_next_leaf(leaf->get_next_leaf());
     buffer_pool_manager_->unpin_page(prev->get_page_id(), true);
+    delete prev;
+
+    set_prev_of_next_leaf(leaf, leaf->get_prev_leaf());  // 注意此处是SetPrevLeaf()
+}
 
+/**
+ * @brief 把leaf的后继结点(可能是叶子链表头)的prev_leaf置为prev_leaf
+ *
+ * @note 后继结点不一定与leaf属于同一个父结点，不在调用者持有的写锁范围内，这里单独短暂地加写锁。
+ * 持有叶子的写锁时只会向右对后继结点加锁，不会形成环路等待
+ */
+void IxIndexHandle::set_prev_of_next_leaf(IxNodeHandle *leaf, page_id_t prev_leaf) {
     IxNodeHandle *next = fetch_node(leaf->get_next_leaf());
-    next->set_prev_leaf(leaf->get_prev_leaf());  // 注意此处是SetPrevLeaf()
+    next->page->write_latch();
+    next->set_prev_leaf(prev_leaf);
+    next->page->write_unlatch();
     buffer_pool_manager_->unpin_page(next->get_page_id(), true);
+    delete next;
 }
 
 /**
- * @brief 删除node时，更新file_hdr_.num_pages
+ * @brief 删除node时，更新file_hdr_.num_pages，并把node的页面放到空闲页面链表头部，供create_node()复用
  *
  * @param node
+ * @note 空闲页面链表随file_hdr_一起持久化，重新打开索引后仍然可以复用
  */
 void IxIndexHandle::release_node_handle(IxNodeHandle &node) {
+    std::lock_guard<std::mutex> lock(page_alloc_latch_);
     file_hdr_->num_pages_--;
+    node.page_hdr->next_free_page_no = file_hdr_->first_free_page_no_;
+    file_hdr_->first_free_page_no_ = node.get_page_no();
+    buffer_pool_manager_->mark_dirty(node.page);
 }
-
-/**
- * @brief 将node的第child_idx个孩子结点的父节点置为node
- */
-void IxIndexHandle::maintain_child(IxNodeHandle *node, int child_idx) {
-    if (!node->is_leaf_page()) {
-        //  Current node is inner node, load its child and set its parent to current node
-        int child_page_no = node->value_at(child_idx);
-        IxNodeHandle *child = fetch_node(child_page_no);
-        child->set_parent_page_no(node->get_page_no());
-        buffer_pool_manager_->unpin_page(child->get_page_id(), true);
-    }
-}
\ No newline at end of file
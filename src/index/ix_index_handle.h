@@ -10,13 +10,16 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <algorithm>
+#include <shared_mutex>
+
 #include "ix_defs.h"
+#include "ix_key.h"
+#include "ix_sorter.h"
 #include "transaction/transaction.h"
 
 enum class Operation { FIND = 0, INSERT, DELETE };  // 三种操作：查找、插入、删除
 
-static const bool binary_search = false;
-
 inline int ix_compare(const char *a, const char *b, ColType type, int col_len) {
     switch (type) {
         case TYPE_INT: {
@@ -46,36 +49,77 @@ inline int ix_compare(const char* a, const char* b, const std::vector<ColType>&
     return 0;
 }
 
-/* 管理B+树中的每个节点 */
+/* 管理B+树中的每个节点
+ * 页面布局：| IxPageHdr | 公共前缀(prefix_len字节，补齐到4字节) | rids[capacity] | 后缀keys[capacity] |
+ * 结点中的key共享长度为prefix_len的公共前缀，前缀只存一份，每个key只存去掉前缀后的后缀，
+ * 后缀长度和结点容量capacity都随prefix_len变化
+ * 内部结点的第i(i>0)个key是第i-1个和第i个孩子之间截断的分隔key：大于第i-1个孩子中的所有key，不大于第i个孩子中的所有key；
+ * 第0个key没有意义，不参与比较和压缩，其后缀只是占位
+ * 布局由页头中的prefix_len决定，每次访问时重新计算，因此句柄可以在加锁之前创建、跨多次加锁使用
+ */
 class IxNodeHandle {
     friend class IxIndexHandle;
     friend class IxScan;
 
    private:
     const IxFileHdr *file_hdr;      // 节点所在文件的头部信息
-    Page *page;                     // 存储节点的页面
+    Page *page;                     // 存储节点的页面，不经过缓冲池构建的结点为nullptr
     IxPageHdr *page_hdr;            // page->data的第一部分，指针指向首地址，长度为sizeof(IxPageHdr)
-    char *keys;                     // page->data的第二部分，指针指向首地址，长度为file_hdr->keys_size，每个key的长度为file_hdr->col_len
-    Rid *rids;                      // page->data的第三部分，指针指向首地址
+
+    char *get_data() const { return reinterpret_cast<char *>(page_hdr); }
+
+    static int prefix_size(int prefix_len) { return (prefix_len + 3) / 4 * 4; }
+
+    Rid *rids_begin() const { return reinterpret_cast<Rid *>(get_data() + sizeof(IxPageHdr) + prefix_size(get_prefix_len())); }
+
+    char *suffixes_begin() const {
+        return reinterpret_cast<char *>(rids_begin() + capacity(file_hdr->col_tot_len_, get_prefix_len()));
+    }
+
+    void restride(int prefix_len, const char *key);
+
+    void extend_prefix();
+
+    int search_suffix(const char *suffix, int begin, int end, bool upper) const;
 
    public:
     IxNodeHandle() = default;
 
     IxNodeHandle(const IxFileHdr *file_hdr_, Page *page_) : file_hdr(file_hdr_), page(page_) {
         page_hdr = reinterpret_cast<IxPageHdr *>(page->get_data());
-        keys = page->get_data() + sizeof(IxPageHdr);
-        rids = reinterpret_cast<Rid *>(keys + file_hdr->keys_size_);
+    }
+
+    // 直接管理一块PAGE_SIZE大小的内存，用于不经过缓冲池构建结点(bulk_build)
+    IxNodeHandle(const IxFileHdr *file_hdr_, char *data) : file_hdr(file_hdr_), page(nullptr) {
+        page_hdr = reinterpret_cast<IxPageHdr *>(data);
+    }
+
+    /* 公共前缀长度为prefix_len时，一个结点在物理上最多能存放的键值对数量 */
+    static int capacity(int col_tot_len, int prefix_len) {
+        return static_cast<int>((PAGE_SIZE - sizeof(IxPageHdr) - prefix_size(prefix_len)) /
+                                (sizeof(Rid) + col_tot_len - prefix_len));
+    }
+
+    /* 公共前缀长度为prefix_len时结点的max_size，结点中的键值对数量总是小于max_size */
+    static int max_size(const IxFileHdr *file_hdr, int prefix_len) {
+        return std::min(file_hdr->btree_order_, capacity(file_hdr->col_tot_len_, prefix_len)) + 1;
     }
 
     int get_size() { return page_hdr->num_key; }
 
     void set_size(int size) { page_hdr->num_key = size; }
 
-    int get_max_size() { return file_hdr->btree_order_ + 1; }
+    int get_max_size() { return max_size(file_hdr, get_prefix_len()); }
 
-    int get_min_size() { return get_max_size() / 2; }
+    // 按不压缩时的容量计算，不随前缀变化：任意不超过2*min_size-1个键值对的集合都能放进一个结点
+    int get_min_size() { return max_size(file_hdr, 0) / 2; }
 
-    int key_at(int i) { return *(int *)get_key(i); }
+    // 第i个key的第一个字段按int解码，用于测试
+    int key_at(int i) {
+        char key[IX_MAX_COL_LEN];
+        get_key(i, key);
+        return ix_decode_int(key);
+    }
 
     /* 得到第i个孩子结点的page_no */
     page_id_t value_at(int i) { return get_rid(i)->page_no; }
@@ -88,25 +132,48 @@ class IxNodeHandle {
 
     page_id_t get_prev_leaf() { return page_hdr->prev_leaf; }
 
-    page_id_t get_parent_page_no() { return page_hdr->parent; }
-
     bool is_leaf_page() { return page_hdr->is_leaf; }
 
-    bool is_root_page() { return get_parent_page_no() == INVALID_PAGE_ID; }
+    // 页面中不存放父结点，根结点由文件头中的root_page_确定；持有结点的写锁时其是否为根结点不会改变
+    bool is_root_page() { return get_page_no() == file_hdr->root_page_; }
 
     void set_next_leaf(page_id_t page_no) { page_hdr->next_leaf = page_no; }
 
     void set_prev_leaf(page_id_t page_no) { page_hdr->prev_leaf = page_no; }
 
-    void set_parent_page_no(page_id_t parent) { page_hdr->parent = parent; }
+    int get_prefix_len() const { return page_hdr->prefix_len; }
+
+    const char *get_prefix() const { return get_data() + sizeof(IxPageHdr); }
+
+    int get_suffix_len() const { return file_hdr->col_tot_len_ - get_prefix_len(); }
+
+    /* 第key_idx个key去掉公共前缀后的部分 */
+    char *get_suffix(int key_idx) const { return suffixes_begin() + key_idx * get_suffix_len(); }
+
+    /* 把第key_idx个完整的key拷贝到key中 */
+    void get_key(int key_idx, char *key) const {
+        memcpy(key, get_prefix(), get_prefix_len());
+        memcpy(key + get_prefix_len(), get_suffix(key_idx), get_suffix_len());
+    }
+
+    Rid *get_rid(int rid_idx) const { return rids_begin() + rid_idx; }
+
+    void set_key(int key_idx, const char *key);
 
-    char *get_key(int key_idx) const { return keys + key_idx * file_hdr->col_tot_len_; }
+    void set_rid(int rid_idx, const Rid &rid) { *get_rid(rid_idx) = rid; }
 
-    Rid *get_rid(int rid_idx) const { return &rids[rid_idx]; }
+    int compare_key(int key_idx, const char *key) const;
 
-    void set_key(int key_idx, const char *key) { memcpy(keys + key_idx * file_hdr->col_tot_len_, key, file_hdr->col_tot_len_); }
+    /* 参与比较和压缩的第一个key：叶子结点为0，内部结点为1 */
+    int first_key_idx() { return is_leaf_page() ? 0 : 1; }
 
-    void set_rid(int rid_idx, const Rid &rid) { rids[rid_idx] = rid; }
+    int prefix_len_with(const char *key);
+
+    /* 插入key之后结点仍然小于max_size，不需要分裂 */
+    bool has_room_for(const char *key) { return get_size() + 1 < max_size(file_hdr, prefix_len_with(key)); }
+
+    /* 把一个参与压缩的key替换为key之后结点仍然小于max_size */
+    bool can_replace_key(const char *key) { return get_size() < max_size(file_hdr, prefix_len_with(key)); }
 
     int lower_bound(const char *target) const;
 
@@ -139,22 +206,6 @@ class IxNodeHandle {
         assert(get_size() == 0);
         return child_page_no;
     }
-
-    /**
-     * @brief 由parent调用，寻找child，返回child在parent中的rid_idx∈[0,page_hdr->num_key)
-     * @param child
-     * @return int
-     */
-    int find_child(IxNodeHandle *child) {
-        int rid_idx;
-        for (rid_idx = 0; rid_idx < page_hdr->num_key; rid_idx++) {
-            if (get_rid(rid_idx)->page_no == child->get_page_no()) {
-                break;
-            }
-        }
-        assert(rid_idx < page_hdr->num_key);
-        return rid_idx;
-    }
 };
 
 /* B+树 */
@@ -167,11 +218,14 @@ class IxIndexHandle {
     BufferPoolManager *buffer_pool_manager_;
     int fd_;                                    // 存储B+树的文件
     IxFileHdr* file_hdr_;                       // 存了root_page，但其初始化为2（第0页存FILE_HDR_PAGE，第1页存LEAF_HEADER_PAGE）
-    std::mutex root_latch_;
+    std::shared_mutex root_latch_;              // 保护root_page_，相当于根结点的父结点：读取根结点时加读锁，可能更换根结点时加写锁
+    std::mutex page_alloc_latch_;               // 保护file_hdr_中的num_pages_和空闲页面链表，不同子树中的分裂/合并可能同时分配/释放页面
 
    public:
     IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd);
 
+    int get_fd() const { return fd_; }
+
     // for search
     bool get_value(const char *key, std::vector<Rid> *result, Transaction *transaction);
 
@@ -181,7 +235,11 @@ class IxIndexHandle {
     // for insert
     page_id_t insert_entry(const char *key, const Rid &value, Transaction *transaction);
 
-    IxNodeHandle *split(IxNodeHandle *node);
+    int insert_entries(const char *keys, const Rid *rids, int n, Transaction *transaction);
+
+    size_t insert_sorted(IxSorter *sorter, Transaction *transaction);
+
+    IxNodeHandle *split(IxNodeHandle *node, int pos, const char *key, const Rid &rid, char *sep_key);
 
     void insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node, Transaction *transaction);
 
@@ -192,7 +250,8 @@ class IxIndexHandle {
                                 bool *root_is_latched = nullptr);
     bool adjust_root(IxNodeHandle *old_root_node);
 
-    void redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node, IxNodeHandle *parent, int index);
+    void redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node, IxNodeHandle *parent, int index,
+                      Transaction *transaction);
 
     bool coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node, IxNodeHandle **parent, int index,
                   Transaction *transaction, bool *root_is_latched);
@@ -205,25 +264,49 @@ class IxIndexHandle {
 
     Iid leaf_begin() const;
 
+    // for bulk build
+    void bulk_build(IxSorter *sorter, double fill_factor = IX_BULK_FILL_FACTOR);
+
+    bool can_bulk_build();
+
+    bool has_duplicate(IxSorter *sorter);
+
    private:
     // 辅助函数
     void update_root_page_no(page_id_t root) { file_hdr_->root_page_ = root; }
 
     bool is_empty() const { return file_hdr_->root_page_ == IX_NO_PAGE; }
 
+    page_id_t insert_norm_entry(const char *key, const Rid &value, Transaction *transaction);
+
+    int insert_norm_entries(const char *keys, const Rid *rids, int n, Transaction *transaction);
+
+    // 把上层传入的记录格式key编码为结点中存放的规范化key
+    void normalize_key(const char *key, char *norm_key) const {
+        ix_encode_key(key, norm_key, file_hdr_->col_types_, file_hdr_->col_lens_);
+    }
+
+    // for latch crabbing
+    IxNodeHandle *descend_read(const char *key, bool find_first, bool latch_leaf_write, char *upper_key = nullptr,
+                               bool *has_upper_key = nullptr);
+
+    bool is_safe(IxNodeHandle *node, const char *key, Operation operation);
+
+    void release_latches(Transaction *transaction, bool is_dirty);
+
+    page_id_t path_parent(IxNodeHandle *node, Transaction *transaction, int *child_idx);
+
     // for get/create node
     IxNodeHandle *fetch_node(int page_no) const;
 
     IxNodeHandle *create_node();
 
     // for maintain data structure
-    void maintain_parent(IxNodeHandle *node);
-
     void erase_leaf(IxNodeHandle *leaf);
 
-    void release_node_handle(IxNodeHandle &node);
+    void set_prev_of_next_leaf(IxNodeHandle *leaf, page_id_t prev_leaf);
 
-    void maintain_child(IxNodeHandle *node, int child_idx);
+    void release_node_handle(IxNodeHandle &node);
 
     // for index test
     Rid get_rid(const Iid &iid) const;
@@ -0,0 +1,172 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "defs.h"
+#include "errors.h"
+
+/**
+ * 保序的key规范化编码：把记录中的组合key编码为等长的字节串，两个编码之间按字节无符号比较(memcmp)的结果
+ * 与原key逐字段按类型比较(ix_compare)的结果一致。B+树结点中存放的都是编码后的key，
+ * 结点内查找只需一次memcmp，不再按字段类型分支
+ *   TYPE_INT:    符号位取反后按大端序存放
+ *   TYPE_FLOAT:  非负数符号位取反，负数所有位取反，再按大端序存放；-0.0规范化为+0.0
+ *   TYPE_STRING: 原样存放（定长，不足部分已由上层补齐）
+ * 编码后的长度与原key相同，结点布局不变
+ */
+
+inline void ix_store_be32(char *dst, uint32_t v) {
+    dst[0] = static_cast<char>(v >> 24);
+    dst[1] = static_cast<char>(v >> 16);
+    dst[2] = static_cast<char>(v >> 8);
+    dst[3] = static_cast<char>(v);
+}
+
+inline uint32_t ix_load_be32(const char *src) {
+    auto p = reinterpret_cast<const unsigned char *>(src);
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+inline void ix_encode_int(const char *src, char *dst) {
+    int32_t v;
+    memcpy(&v, src, sizeof(v));
+    ix_store_be32(dst, static_cast<uint32_t>(v) ^ 0x80000000u);
+}
+
+inline int ix_decode_int(const char *src) {
+    return static_cast<int32_t>(ix_load_be32(src) ^ 0x80000000u);
+}
+
+inline void ix_encode_float(const char *src, char *dst) {
+    float f;
+    memcpy(&f, src, sizeof(f));
+    if (f == 0.0f) f = 0.0f;
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    bits = (bits & 0x80000000u) ? ~bits : (bits ^ 0x80000000u);
+    ix_store_be32(dst, bits);
+}
+
+inline float ix_decode_float(const char *src) {
+    uint32_t bits = ix_load_be32(src);
+    bits = (bits & 0x80000000u) ? (bits ^ 0x80000000u) : ~bits;
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+/**
+ * @description: 把记录格式的组合key编码为规范化key
+ * @param {char*} src 原key，各字段按col_types/col_lens依次存放
+ * @param {char*} dst 编码结果，长度与src相同，不能与src重叠
+ */
+inline void ix_encode_key(const char *src, char *dst, const std::vector<ColType> &col_types,
+                          const std::vector<int> &col_lens) {
+    int offset = 0;
+    for (size_t i = 0; i < col_types.size(); ++i) {
+        switch (col_types[i]) {
+            case TYPE_INT:
+                ix_encode_int(src + offset, dst + offset);
+                break;
+            case TYPE_FLOAT:
+                ix_encode_float(src + offset, dst + offset);
+                break;
+            case TYPE_STRING:
+                memcpy(dst + offset, src + offset, col_lens[i]);
+                break;
+            default:
+                throw InternalError("Unexpected data type");
+        }
+        offset += col_lens[i];
+    }
+}
+
+/**
+ * @description: ix_encode_key的逆过程，把规范化key还原为记录格式
+ */
+inline void ix_decode_key(const char *src, char *dst, const std::vector<ColType> &col_types,
+                          const std::vector<int> &col_lens) {
+    int offset = 0;
+    for (size_t i = 0; i < col_types.size(); ++i) {
+        switch (col_types[i]) {
+            case TYPE_INT: {
+                int v = ix_decode_int(src + offset);
+                memcpy(dst + offset, &v, sizeof(v));
+                break;
+            }
+            case TYPE_FLOAT: {
+                float v = ix_decode_float(src + offset);
+                memcpy(dst + offset, &v, sizeof(v));
+                break;
+            }
+            case TYPE_STRING:
+                memcpy(dst + offset, src + offset, col_lens[i]);
+                break;
+            default:
+                throw InternalError("Unexpected data type");
+        }
+        offset += col_lens[i];
+    }
+}
+
+/* 比较两个规范化key */
+inline int ix_key_compare(const char *a, const char *b, int key_len) { return memcmp(a, b, key_len); }
+
+/* 长度不超过4字节的规范化key按大端序读出，右侧补0，比较结果与memcmp一致 */
+inline uint32_t ix_load_be_upto32(const char *src, int len) {
+    auto p = reinterpret_cast<const unsigned char *>(src);
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) {
+        v = (v << 8) | (i < len ? p[i] : 0);
+    }
+    return v;
+}
+
+/**
+ * @description: 统计n个连续存放、长度为len(不超过4)的有序规范化key中小于target的个数，即target的lower_bound；
+ * or_equal为true时统计小于等于target的个数，即upper_bound。不提前退出、没有分支，
+ * 4字节的key在SSE2下每次比较4个
+ */
+inline int ix_probe_count(const char *keys, int n, int len, const char *target, bool or_equal) {
+    const uint32_t t = ix_load_be_upto32(target, len);
+    int i = 0, count = 0;
+#ifdef __SSE2__
+    if (len == 4) {
+        const __m128i sign = _mm_set1_epi32(static_cast<int>(0x80000000u));
+        const __m128i vt = _mm_xor_si128(_mm_set1_epi32(static_cast<int>(t)), sign);
+        for (; i + 4 <= n; i += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i * 4));
+            // 大端序转为本机序：先交换每个32位中的两个16位，再交换每个16位中的两个字节
+            v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xB1), 0xB1);
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+            // 翻转符号位后按有符号数比较，等价于无符号比较
+            v = _mm_xor_si128(v, sign);
+            __m128i mask = or_equal ? _mm_cmpgt_epi32(v, vt) : _mm_cmplt_epi32(v, vt);
+            int bits = __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(mask)));
+            count += or_equal ? 4 - bits : bits;
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        uint32_t v = ix_load_be_upto32(keys + i * len, len);
+        count += or_equal ? v <= t : v < t;
+    }
+    return count;
+}
@@ -61,10 +61,6 @@ class IxManager {
         // Open index file
         int fd = disk_manager_->open_file(ix_name);
 
-        // Create file header and write to file
-        // Theoretically we have: |page_hdr| + (|attr| + |rid|) * n <= PAGE_SIZE
-        // but we reserve one slot for convenient inserting and deleting, i.e.
-        // |page_hdr| + (|attr| + |rid|) * (n + 1) <= PAGE_SIZE
         int col_tot_len = 0;
         int col_num = index_cols.size();
         for(auto& col: index_cols) {
@@ -73,15 +69,14 @@ class IxManager {
         if (col_tot_len > IX_MAX_COL_LEN) {
             throw InvalidColLengthError(col_tot_len);
         }
-        // 根据 |page_hdr| + (|attr| + |rid|) * (n + 1) <= PAGE_SIZE 求得n的最大值btree_order
-        // 即 n <= btree_order，那么btree_order就是每个结点最多可插入的键值对数量（实际还多留了一个空位，但其不可插入）
-        int btree_order = static_cast<int>((PAGE_SIZE - sizeof(IxPageHdr)) / (col_tot_len + sizeof(Rid)) - 1);
-        assert(btree_order > 2);
+        // 结点按公共前缀压缩(内部结点存放截断的分隔key)，容量由 |page_hdr| + |prefix| + (|suffix| + |rid|) * n <= PAGE_SIZE 决定，随前缀长度变化
+        // btree_order取所有key完全相同时的容量，作为结点键值对数量的上界；未压缩时至少能放下3个键值对
+        int btree_order = IxNodeHandle::capacity(col_tot_len, col_tot_len);
+        assert(IxNodeHandle::capacity(col_tot_len, 0) > 2);
 
         // Create file header and write to file
         IxFileHdr* fhdr = new IxFileHdr(IX_NO_PAGE, IX_INIT_NUM_PAGES, IX_INIT_ROOT_PAGE,
-                                col_num, col_tot_len, btree_order, (btree_order + 1) * col_tot_len,
-                                IX_INIT_ROOT_PAGE, IX_INIT_ROOT_PAGE);
+                                col_num, col_tot_len, btree_order, IX_INIT_ROOT_PAGE, IX_INIT_ROOT_PAGE);
         for(int i = 0; i < col_num; ++i) {
             fhdr->col_types_.push_back(index_cols[i].type);
             fhdr->col_lens_.push_back(index_cols[i].len);
@@ -102,11 +97,11 @@ class IxManager {
             auto phdr = reinterpret_cast<IxPageHdr *>(page_buf);
             *phdr = {
                 .next_free_page_no = IX_NO_PAGE,
-                .parent = IX_NO_PAGE,
                 .num_key = 0,
                 .is_leaf = true,
                 .prev_leaf = IX_INIT_ROOT_PAGE,
                 .next_leaf = IX_INIT_ROOT_PAGE,
+                .prefix_len = 0,
             };
             disk_manager_->write_page(fd, IX_LEAF_HEADER_PAGE, page_buf, PAGE_SIZE);
         }
@@ -117,11 +112,11 @@ class IxManager {
             auto phdr = reinterpret_cast<IxPageHdr *>(page_buf);
             *phdr = {
                 .next_free_page_no = IX_NO_PAGE,
-                .parent = IX_NO_PAGE,
                 .num_key = 0,
                 .is_leaf = true,
                 .prev_leaf = IX_LEAF_HEADER_PAGE,
                 .next_leaf = IX_LEAF_HEADER_PAGE,
+                .prefix_len = 0,
             };
             // Must write PAGE_SIZE here in case of future fetch_node()
             disk_manager_->write_page(fd, IX_INIT_ROOT_PAGE, page_buf, PAGE_SIZE);
@@ -11,23 +11,55 @@ See the Mulan PSL v2 for more details. */
 #include "ix_scan.h"
 
 /**
- * @brief 
- * @todo 加上读锁（需要使用缓冲池得到page）
+ * @brief 移动到下一个索引槽，读取叶子时加读锁，叶子的pin在叶内迭代期间一直保留
  */
 void IxScan::next() {
     assert(!is_end());
-    IxNodeHandle *node = ih_->fetch_node(iid_.page_no);
-    assert(node->is_leaf_page());
-    assert(iid_.slot_no < node->get_size());
+    pin_leaf();
+    node_.page->read_latch();
+    assert(node_.is_leaf_page());
+    assert(iid_.slot_no < node_.get_size());
+    // 开始遍历一个叶子时沿next_leaf预读下一个叶子，使其读盘与当前叶子的遍历重叠
+    if (iid_.slot_no == 0 && iid_.page_no != ih_->file_hdr_->last_leaf_) {
+        page_id_t next_leaf = node_.get_next_leaf();
+        bpm_->prefetch_pages(ih_->fd_, next_leaf, next_leaf + 1);
+    }
     // increment slot no
     iid_.slot_no++;
-    if (iid_.page_no != ih_->file_hdr_->last_leaf_ && iid_.slot_no == node->get_size()) {
+    if (iid_.page_no != ih_->file_hdr_->last_leaf_ && iid_.slot_no == node_.get_size()) {
         // go to next leaf
         iid_.slot_no = 0;
-        iid_.page_no = node->get_next_leaf();
+        iid_.page_no = node_.get_next_leaf();
+    }
+    node_.page->read_unlatch();
+    if (is_end()) {
+        guard_.release();
     }
 }
 
 Rid IxScan::rid() const {
-    return ih_->get_rid(iid_);
+    pin_leaf();
+    node_.page->read_latch();
+    if (iid_.slot_no >= node_.get_size()) {
+        node_.page->read_unlatch();
+        throw IndexEntryNotFoundError();
+    }
+    Rid rid = *node_.get_rid(iid_.slot_no);
+    node_.page->read_unlatch();
+    return rid;
+}
+
+/**
+ * @brief 保证iid_所在的叶子被固定，已固定时直接复用，离开上一个叶子时才unpin
+ */
+void IxScan::pin_leaf() const {
+    if (guard_ && guard_.get_page_id().page_no == iid_.page_no) {
+        return;
+    }
+    guard_.release();
+    guard_ = bpm_->fetch_page_basic(PageId{ih_->fd_, iid_.page_no});
+    if (!guard_) {
+        throw PageNotExistError("ix_scan", iid_.page_no);
+    }
+    node_ = IxNodeHandle(ih_->file_hdr_, guard_.get());
 }
\ No newline at end of file
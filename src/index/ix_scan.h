@@ -23,6 +23,10 @@ class IxScan : public RecScan {
     Iid iid_;  // 初始为lower（用于遍历的指针）
     Iid end_;  // 初始为upper
     BufferPoolManager *bpm_;
+    mutable PageGuard guard_;     // iid_所在叶子的pin，在同一叶子内迭代时不再经过缓冲池
+    mutable IxNodeHandle node_;   // guard_对应的叶子结点
+
+    void pin_leaf() const;
 
    public:
     IxScan(const IxIndexHandle *ih, const Iid &lower, const Iid &upper, BufferPoolManager *bpm)
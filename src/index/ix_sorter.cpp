@@ -0,0 +1,200 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_sorter.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <numeric>
+
+#include "errors.h"
+#include "ix_key.h"
+
+static constexpr size_t IX_SORT_READ_SIZE = 64 * 1024;  // 归并时每个run一次读入的字节数
+
+IxSorter::IxSorter(const std::vector<ColType> &col_types, const std::vector<int> &col_lens,
+                   const std::string &run_prefix, size_t memory_budget)
+    : col_types_(col_types), col_lens_(col_lens), run_prefix_(run_prefix) {
+    key_len_ = std::accumulate(col_lens_.begin(), col_lens_.end(), 0);
+    entry_size_ = key_len_ + sizeof(Rid);
+    // 至少容纳一个键值对
+    memory_budget_ = std::max(memory_budget, entry_size_);
+}
+
+IxSorter::~IxSorter() {
+    for (auto &reader : readers_) {
+        if (reader.file != nullptr) fclose(reader.file);
+    }
+    for (auto &run : runs_) {
+        remove(run.c_str());
+    }
+}
+
+/**
+ * @description: 比较两个键值对，key相同时按rid比较，使输出顺序确定
+ */
+int IxSorter::compare(const char *a, const char *b) const {
+    int res = ix_key_compare(a, b, key_len_);
+    if (res != 0) return res;
+    Rid ra, rb;
+    memcpy(&ra, a + key_len_, sizeof(Rid));
+    memcpy(&rb, b + key_len_, sizeof(Rid));
+    if (ra.page_no != rb.page_no) return ra.page_no < rb.page_no ? -1 : 1;
+    if (ra.slot_no != rb.slot_no) return ra.slot_no < rb.slot_no ? -1 : 1;
+    return 0;
+}
+
+void IxSorter::add(const char *key, const Rid &rid) {
+    assert(!finished_);
+    if (buffer_.size() + entry_size_ > memory_budget_) {
+        spill();
+    }
+    size_t off = buffer_.size();
+    buffer_.resize(off + entry_size_);
+    ix_encode_key(key, buffer_.data() + off, col_types_, col_lens_);
+    memcpy(buffer_.data() + off + key_len_, &rid, sizeof(Rid));
+    num_entries_++;
+}
+
+/**
+ * @description: 对内存缓冲区中的键值对排序，结果为order_，不移动键值对本身
+ */
+void IxSorter::sort_buffer() {
+    order_.resize(buffer_.size() / entry_size_);
+    std::iota(order_.begin(), order_.end(), 0);
+    const char *base = buffer_.data();
+    std::sort(order_.begin(), order_.end(), [&](uint32_t a, uint32_t b) {
+        return compare(base + a * entry_size_, base + b * entry_size_) < 0;
+    });
+}
+
+/**
+ * @description: 把内存缓冲区排序后按顺序写出为一个新的run，清空缓冲区
+ */
+void IxSorter::spill() {
+    if (buffer_.empty()) return;
+    sort_buffer();
+    std::string name = run_prefix_ + "." + std::to_string(runs_.size());
+    FILE *file = fopen(name.c_str(), "wb");
+    if (file == nullptr) {
+        throw UnixError();
+    }
+    runs_.push_back(name);
+    std::vector<char> out;
+    out.reserve(std::min(buffer_.size(), IX_SORT_READ_SIZE));
+    for (uint32_t idx : order_) {
+        out.insert(out.end(), buffer_.data() + idx * entry_size_, buffer_.data() + (idx + 1) * entry_size_);
+        if (out.size() >= IX_SORT_READ_SIZE) {
+            if (fwrite(out.data(), 1, out.size(), file) != out.size()) {
+                fclose(file);
+                throw UnixError();
+            }
+            out.clear();
+        }
+    }
+    if (fwrite(out.data(), 1, out.size(), file) != out.size() || fclose(file) != 0) {
+        throw UnixError();
+    }
+    buffer_.clear();
+    order_.clear();
+}
+
+/**
+ * @description: 结束输入。全部键值对都在内存中时只做一次内存排序，否则把剩余部分也写出为run，打开所有run准备归并
+ */
+void IxSorter::finish() {
+    assert(!finished_);
+    finished_ = true;
+    if (runs_.empty()) {
+        sort_buffer();
+        cursor_ = 0;
+        return;
+    }
+    spill();
+    std::vector<char>().swap(buffer_);
+    readers_.resize(runs_.size());
+    for (size_t i = 0; i < runs_.size(); i++) {
+        readers_[i].file = fopen(runs_[i].c_str(), "rb");
+        if (readers_[i].file == nullptr) {
+            throw UnixError();
+        }
+        // 缓冲区为键值对大小的整数倍，键值对不会跨越两次读取
+        readers_[i].buf.resize(std::max<size_t>(1, IX_SORT_READ_SIZE / entry_size_) * entry_size_);
+        if (fill(&readers_[i])) {
+            heap_.push_back(i);
+        }
+    }
+    for (size_t i = heap_.size() / 2; i-- > 0;) {
+        heap_sift_down(i);
+    }
+}
+
+/**
+ * @description: 从run文件读入下一段数据
+ * @return {bool} run中还有数据则返回true
+ */
+bool IxSorter::fill(RunReader *reader) {
+    reader->pos = 0;
+    reader->end = fread(reader->buf.data(), 1, reader->buf.size(), reader->file);
+    return reader->end >= entry_size_;
+}
+
+bool IxSorter::heap_less(size_t a, size_t b) const {
+    const RunReader &ra = readers_[a];
+    const RunReader &rb = readers_[b];
+    return compare(ra.buf.data() + ra.pos, rb.buf.data() + rb.pos) < 0;
+}
+
+void IxSorter::heap_sift_down(size_t i) {
+    while (true) {
+        size_t smallest = i;
+        size_t l = 2 * i + 1, r = 2 * i + 2;
+        if (l < heap_.size() && heap_less(heap_[l], heap_[smallest])) smallest = l;
+        if (r < heap_.size() && heap_less(heap_[r], heap_[smallest])) smallest = r;
+        if (smallest == i) return;
+        std::swap(heap_[i], heap_[smallest]);
+        i = smallest;
+    }
+}
+
+/**
+ * @description: 按顺序取出下一个键值对
+ * @return {bool} 没有更多键值对时返回false
+ * @param {char**} key 传出参数，指向key的指针，在下一次调用next()之前有效
+ * @param {Rid*} rid 传出参数，key对应的rid
+ */
+bool IxSorter::next(const char **key, Rid *rid) {
+    assert(finished_);
+    if (runs_.empty()) {
+        if (cursor_ == order_.size()) return false;
+        const char *entry = buffer_.data() + order_[cursor_++] * entry_size_;
+        *key = entry;
+        memcpy(rid, entry + key_len_, sizeof(Rid));
+        return true;
+    }
+    // 上一次输出的键值对在堆顶，此时才前进，保证返回的key指针在下一次调用前有效
+    if (last_reader_ != SIZE_MAX) {
+        RunReader &reader = readers_[last_reader_];
+        reader.pos += entry_size_;
+        if (reader.pos + entry_size_ > reader.end && !fill(&reader)) {
+            heap_[0] = heap_.back();
+            heap_.pop_back();
+        }
+        if (!heap_.empty()) heap_sift_down(0);
+        last_reader_ = SIZE_MAX;
+    }
+    if (heap_.empty()) return false;
+    last_reader_ = heap_[0];
+    const RunReader &reader = readers_[last_reader_];
+    *key = reader.buf.data() + reader.pos;
+    memcpy(rid, reader.buf.data() + reader.pos + key_len_, sizeof(Rid));
+    return true;
+}
@@ -0,0 +1,92 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "defs.h"
+
+/**
+ * @description: (key, rid)对的外部排序，用于自底向上构建B+树。
+ * add()把key编码为规范化key(见ix_key.h)后与rid一起追加到内存缓冲区，缓冲区超过内存预算时排序后写出到一个临时文件(run)；
+ * finish()之后用next()按key升序(key相同时按rid)逐个取出规范化key：只有一个缓冲区时直接遍历，否则对所有run做多路归并。
+ * 临时文件在析构时删除
+ */
+class IxSorter {
+   public:
+    /**
+     * @param {vector<ColType>&} col_types key中各字段的类型
+     * @param {vector<int>&} col_lens key中各字段的长度
+     * @param {string&} run_prefix 临时文件名前缀，run文件名为run_prefix.<序号>
+     * @param {size_t} memory_budget 内存缓冲区的字节数上限
+     */
+    IxSorter(const std::vector<ColType> &col_types, const std::vector<int> &col_lens, const std::string &run_prefix,
+             size_t memory_budget);
+
+    ~IxSorter();
+
+    IxSorter(const IxSorter &) = delete;
+    IxSorter &operator=(const IxSorter &) = delete;
+
+    void add(const char *key, const Rid &rid);
+
+    void finish();
+
+    bool next(const char **key, Rid *rid);
+
+    /* 加入的键值对总数 */
+    size_t size() const { return num_entries_; }
+
+    /* 写出的run个数，0表示全部在内存中排序 */
+    size_t num_runs() const { return runs_.size(); }
+
+   private:
+    /* 一个run的顺序读取器，每次从文件读入一段到缓冲区 */
+    struct RunReader {
+        FILE *file = nullptr;
+        std::vector<char> buf;
+        size_t pos = 0;   // 当前键值对在buf中的偏移量
+        size_t end = 0;   // buf中有效数据的长度
+    };
+
+    int compare(const char *a, const char *b) const;
+
+    void sort_buffer();
+
+    void spill();
+
+    bool fill(RunReader *reader);
+
+    bool heap_less(size_t a, size_t b) const;
+
+    void heap_sift_down(size_t i);
+
+    std::vector<ColType> col_types_;
+    std::vector<int> col_lens_;
+    int key_len_;
+    size_t entry_size_;         // key_len_ + sizeof(Rid)
+    std::string run_prefix_;
+    size_t memory_budget_;
+
+    std::vector<char> buffer_;          // 未写出的键值对，连续存放
+    std::vector<uint32_t> order_;       // buffer_中键值对排序后的下标
+    size_t num_entries_ = 0;
+    size_t cursor_ = 0;                 // 内存排序时下一个输出的order_下标
+
+    std::vector<std::string> runs_;
+    std::vector<RunReader> readers_;
+    std::vector<size_t> heap_;          // 归并时以readers_下标组成的小顶堆
+    size_t last_reader_ = SIZE_MAX;     // 上一次next()输出的reader，下一次next()时前进
+    bool finished_ = false;
+};
@@ -38,6 +38,12 @@ class Optimizer {
         } else if (auto x = std::dynamic_pointer_cast<ast::ShowTables>(query->parse)) {
             // show tables;
             return std::make_shared<OtherPlan>(T_ShowTable, std::string());
+        } else if (auto x = std::dynamic_pointer_cast<ast::ShowBufferStats>(query->parse)) {
+            // show buffer stats;
+            return std::make_shared<OtherPlan>(T_ShowBufferStats, std::string());
+        } else if (auto x = std::dynamic_pointer_cast<ast::SetBufferPoolSize>(query->parse)) {
+            // set buffer pool size n;
+            return std::make_shared<OtherPlan>(T_SetBufferPoolSize, std::string(), x->pool_size);
         } else if (auto x = std::dynamic_pointer_cast<ast::DescTable>(query->parse)) {
             // desc table;
             return std::make_shared<OtherPlan>(T_DescTable, x->tab_name);
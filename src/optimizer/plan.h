@@ -23,12 +23,15 @@ typedef enum PlanTag{
     T_Invalid = 1,
     T_Help,
     T_ShowTable,
+    T_ShowBufferStats,
+    T_SetBufferPoolSize,
     T_DescTable,
     T_CreateTable,
     T_DropTable,
     T_CreateIndex,
     T_DropIndex,
     T_Insert,
+    T_LoadData,
     T_Update,
     T_Delete,
     T_select,
@@ -64,7 +67,11 @@ class ScanPlan : public Plan
             len_ = cols_.back().offset + cols_.back().len;
             fed_conds_ = conds_;
             index_col_names_ = index_col_names;
-        
+            // 大表的顺序扫描使用私有帧环，避免冲掉缓冲池中的热点页面
+            auto fh = sm_manager->fhs_.find(tab_name_);
+            use_ring_ = tag == T_SeqScan && fh != sm_manager->fhs_.end() &&
+                        fh->second->get_file_hdr().num_pages >
+                            SCAN_RING_THRESHOLD * sm_manager->get_bpm()->get_pool_size();
         }
         ~ScanPlan(){}
         // 以下变量同ScanExecutor中的变量
@@ -74,6 +81,7 @@ class ScanPlan : public Plan
         size_t len_;                               
         std::vector<Condition> fed_conds_;
         std::vector<std::string> index_col_names_;
+        bool use_ring_;
     
 };
 
@@ -137,20 +145,20 @@ class DMLPlan : public Plan
 {
     public:
         DMLPlan(PlanTag tag, std::shared_ptr<Plan> subplan,std::string tab_name,
-                std::vector<Value> values, std::vector<Condition> conds,
+                std::vector<std::vector<Value>> rows, std::vector<Condition> conds,
                 std::vector<SetClause> set_clauses)
         {
             Plan::tag = tag;
             subplan_ = std::move(subplan);
             tab_name_ = std::move(tab_name);
-            values_ = std::move(values);
+            rows_ = std::move(rows);
             conds_ = std::move(conds);
             set_clauses_ = std::move(set_clauses);
         }
         ~DMLPlan(){}
         std::shared_ptr<Plan> subplan_;
         std::string tab_name_;
-        std::vector<Value> values_;
+        std::vector<std::vector<Value>> rows_;  // insert的各行数据
         std::vector<Condition> conds_;
         std::vector<SetClause> set_clauses_;
 };
@@ -172,17 +180,34 @@ class DDLPlan : public Plan
         std::vector<ColDef> cols_;
 };
 
+// load data语句，把csv文件批量装载到表中
+class LoadDataPlan : public Plan
+{
+    public:
+        LoadDataPlan(PlanTag tag, std::string tab_name, std::string file_name)
+        {
+            Plan::tag = tag;
+            tab_name_ = std::move(tab_name);
+            file_name_ = std::move(file_name);
+        }
+        ~LoadDataPlan(){}
+        std::string tab_name_;
+        std::string file_name_;
+};
+
 // help; show tables; desc tables; begin; abort; commit; rollback语句对应的plan
 class OtherPlan : public Plan
 {
     public:
-        OtherPlan(PlanTag tag, std::string tab_name)
+        OtherPlan(PlanTag tag, std::string tab_name, int value = 0)
         {
             Plan::tag = tag;
             tab_name_ = std::move(tab_name);            
+            value_ = value;
         }
         ~OtherPlan(){}
         std::string tab_name_;
+        int value_;     // 语句中的整数参数，如SET BUFFER POOL SIZE的帧个数
 };
 
 class plannerInfo{
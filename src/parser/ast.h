@@ -43,6 +43,15 @@ struct Help : public TreeNode {
 struct ShowTables : public TreeNode {
 };
 
+struct ShowBufferStats : public TreeNode {
+};
+
+struct SetBufferPoolSize : public TreeNode {
+    int pool_size;
+
+    SetBufferPoolSize(int pool_size_) : pool_size(pool_size_) {}
+};
+
 struct TxnBegin : public TreeNode {
 };
 
@@ -168,10 +177,18 @@ struct OrderBy : public TreeNode
 
 struct InsertStmt : public TreeNode {
     std::string tab_name;
-    std::vector<std::shared_ptr<Value>> vals;
+    std::vector<std::vector<std::shared_ptr<Value>>> rows;   // VALUES (...), (...) 中的每一行
+
+    InsertStmt(std::string tab_name_, std::vector<std::vector<std::shared_ptr<Value>>> rows_) :
+            tab_name(std::move(tab_name_)), rows(std::move(rows_)) {}
+};
+
+struct LoadData : public TreeNode {
+    std::string file_name;
+    std::string tab_name;
 
-    InsertStmt(std::string tab_name_, std::vector<std::shared_ptr<Value>> vals_) :
-            tab_name(std::move(tab_name_)), vals(std::move(vals_)) {}
+    LoadData(std::string file_name_, std::string tab_name_) :
+            file_name(std::move(file_name_)), tab_name(std::move(tab_name_)) {}
 };
 
 struct DeleteStmt : public TreeNode {
@@ -246,6 +263,7 @@ struct SemValue {
 
     std::shared_ptr<Value> sv_val;
     std::vector<std::shared_ptr<Value>> sv_vals;
+    std::vector<std::vector<std::shared_ptr<Value>>> sv_rows;
 
     std::shared_ptr<Col> sv_col;
     std::vector<std::shared_ptr<Col>> sv_cols;
@@ -79,6 +79,11 @@ private:
             std::cout << "HELP\n";
         } else if (auto x = std::dynamic_pointer_cast<ShowTables>(node)) {
             std::cout << "SHOW_TABLES\n";
+        } else if (auto x = std::dynamic_pointer_cast<ShowBufferStats>(node)) {
+            std::cout << "SHOW_BUFFER_STATS\n";
+        } else if (auto x = std::dynamic_pointer_cast<SetBufferPoolSize>(node)) {
+            std::cout << "SET_BUFFER_POOL_SIZE\n";
+            print_val(x->pool_size, offset);
         } else if (auto x = std::dynamic_pointer_cast<CreateTable>(node)) {
             std::cout << "CREATE_TABLE\n";
             print_val(x->tab_name, offset);
@@ -134,7 +139,13 @@ private:
         } else if (auto x = std::dynamic_pointer_cast<InsertStmt>(node)) {
             std::cout << "INSERT\n";
             print_val(x->tab_name, offset);
-            print_node_list(x->vals, offset);
+            for (auto &row : x->rows) {
+                print_node_list(row, offset);
+            }
+        } else if (auto x = std::dynamic_pointer_cast<LoadData>(node)) {
+            std::cout << "LOAD_DATA\n";
+            print_val(x->file_name, offset);
+            print_val(x->tab_name, offset);
         } else if (auto x = std::dynamic_pointer_cast<DeleteStmt>(node)) {
             std::cout << "DELETE\n";
             print_val(x->tab_name, offset);
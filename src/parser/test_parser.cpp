@@ -16,6 +16,8 @@ See the Mulan PSL v2 for more details. */
 int main() {
     std::vector<std::string> sqls = {
         "show tables;",
+        "show buffer stats;",
+        "set buffer pool size 1024;",
         "desc tb;",
         "create table tb (a int, b float, c char(4));",
         "drop table tb;",
@@ -24,6 +26,8 @@ int main() {
         "drop index tb(a, b, c);",
         "drop index tb(b);",
         "insert into tb values (1, 3.14, 'pi');",
+        "insert into tb values (1, 3.14, 'pi'), (2, 2.72, 'e');",
+        "load data infile 'tb.csv' into table tb;",
         "delete from tb where a = 1;",
         "update tb set a = 1, b = 2.2, c = 'xyz' where x = 2 and y < 1.1 and z > 'abc';",
         "select * from tb;",
@@ -1,6 +1,7 @@
 %{
 #include "ast.h"
 #include "yacc.tab.h"
+#include <strings.h>
 #include <iostream>
 #include <memory>
 
@@ -40,6 +41,7 @@ WHERE UPDATE SET SELECT INT CHAR FLOAT INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_CO
 %type <sv_expr> expr
 %type <sv_val> value
 %type <sv_vals> valueList
+%type <sv_rows> valueRows
 %type <sv_str> tbName colName
 %type <sv_strs> tableList colNameList
 %type <sv_col> col
@@ -106,6 +108,25 @@ dbStmt:
     {
         $$ = std::make_shared<ShowTables>();
     }
+    |   SHOW IDENTIFIER IDENTIFIER
+    {
+        // BUFFER、STATS不是保留字，仍可用作表名和列名
+        if (strcasecmp($2.c_str(), "BUFFER") != 0 || strcasecmp($3.c_str(), "STATS") != 0) {
+            yyerror(&@$, "syntax error, expected SHOW TABLES or SHOW BUFFER STATS");
+            YYERROR;
+        }
+        $$ = std::make_shared<ShowBufferStats>();
+    }
+    |   SET IDENTIFIER IDENTIFIER IDENTIFIER VALUE_INT
+    {
+        // 同上，BUFFER、POOL、SIZE不是保留字
+        if (strcasecmp($2.c_str(), "BUFFER") != 0 || strcasecmp($3.c_str(), "POOL") != 0 ||
+            strcasecmp($4.c_str(), "SIZE") != 0) {
+            yyerror(&@$, "syntax error, expected SET BUFFER POOL SIZE n");
+            YYERROR;
+        }
+        $$ = std::make_shared<SetBufferPoolSize>($5);
+    }
     ;
 
 ddl:
@@ -132,9 +153,19 @@ ddl:
     ;
 
 dml:
-        INSERT INTO tbName VALUES '(' valueList ')'
+        INSERT INTO tbName VALUES valueRows
+    {
+        $$ = std::make_shared<InsertStmt>($3, $5);
+    }
+    |   IDENTIFIER IDENTIFIER IDENTIFIER VALUE_STRING INTO TABLE tbName
     {
-        $$ = std::make_shared<InsertStmt>($3, $6);
+        // LOAD、DATA、INFILE不是保留字，仍可用作表名和列名
+        if (strcasecmp($1.c_str(), "LOAD") != 0 || strcasecmp($2.c_str(), "DATA") != 0 ||
+            strcasecmp($3.c_str(), "INFILE") != 0) {
+            yyerror(&@$, "syntax error, expected LOAD DATA INFILE 'file_name' INTO TABLE table_name");
+            YYERROR;
+        }
+        $$ = std::make_shared<LoadData>($4, $7);
     }
     |   DELETE FROM tbName optWhereClause
     {
@@ -205,6 +236,17 @@ valueList:
     }
     ;
 
+valueRows:
+        '(' valueList ')'
+    {
+        $$ = std::vector<std::vector<std::shared_ptr<Value>>>{$2};
+    }
+    |   valueRows ',' '(' valueList ')'
+    {
+        $$.push_back($4);
+    }
+    ;
+
 value:
         VALUE_INT
     {
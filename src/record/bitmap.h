@@ -10,6 +10,7 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstring>
 
@@ -39,14 +40,39 @@ class Bitmap {
      * @return 找到了就返回偏移位置，没找到就返回max_n
      */
     static int next_bit(bool bit, const char *bm, int max_n, int curr) {
-        for (int i = curr + 1; i < max_n; i++) {
-            if (is_set(bm, i) == bit) {
-                return i;
+        int pos = curr + 1;
+        if (pos >= max_n) return max_n;
+        int num_bytes = (max_n + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        // 一次检查64位，找0时取反后找1；超出max_n的位(包括补齐的0)取反后为1，找到时返回值会被截断为max_n
+        for (int base = pos & ~(WORD_WIDTH - 1); base < max_n; base += WORD_WIDTH) {
+            uint64_t word = load_word(bm, base / BITMAP_WIDTH, num_bytes);
+            if (!bit) word = ~word;
+            if (base < pos) word &= ~0ULL >> (pos - base);
+            if (word != 0) {
+                int i = base + __builtin_clzll(word);
+                return i < max_n ? i : max_n;
             }
         }
         return max_n;
     }
 
+    /**
+     * @brief 按位置递增的顺序对[0, max_n)中每个为1的位调用f(pos)，用于扫描时一次取出页面中的所有记录
+     */
+    template <typename F>
+    static void for_each_set_bit(const char *bm, int max_n, F &&f) {
+        int num_bytes = (max_n + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        for (int base = 0; base < max_n; base += WORD_WIDTH) {
+            uint64_t word = load_word(bm, base / BITMAP_WIDTH, num_bytes);
+            while (word != 0) {
+                int offset = __builtin_clzll(word);
+                if (base + offset >= max_n) return;
+                f(base + offset);
+                word &= ~(WORD_HIGHEST_BIT >> offset);
+            }
+        }
+    }
+
     // 找第一个为0 or 1的位
     static int first_bit(bool bit, const char *bm, int max_n) { return next_bit(bit, bm, max_n, -1); }
 
@@ -55,6 +81,22 @@ class Bitmap {
     // rid_.slot_no); int slot_no = Bitmap::first_bit(false, page_handle.bitmap, file_hdr_.num_records_per_page);
 
    private:
+    static constexpr int WORD_WIDTH = 64;
+    static constexpr uint64_t WORD_HIGHEST_BIT = 1ULL << 63;
+
+    /**
+     * @brief 读取从第byte个字节开始的8个字节，超出num_bytes的部分补0，按大端序拼成64位整数。
+     * 每个字节内第0位是最高位，因此拼接后第byte * 8 + i位正好是整数从最高位数起的第i位
+     */
+    static uint64_t load_word(const char *bm, int byte, int num_bytes) {
+        uint64_t word = 0;
+        memcpy(&word, bm + byte, std::min(8, num_bytes - byte));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        word = __builtin_bswap64(word);
+#endif
+        return word;
+    }
+
     static int get_bucket(int pos) { return pos / BITMAP_WIDTH; }
 
     static char get_bit(int pos) { return BITMAP_HIGHEST_BIT >> static_cast<char>(pos % BITMAP_WIDTH); }
@@ -23,20 +23,20 @@ struct RmFileHdr {
     int record_size;            // 表中每条记录的大小，由于不包含变长字段，因此当前字段初始化后保持不变
     int num_pages;              // 文件中分配的页面个数（初始化为1）
     int num_records_per_page;   // 每个页面最多能存储的元组个数
-    int first_free_page_no;     // 文件中当前第一个包含空闲空间的页面号（初始化为-1）
+    int first_free_page_no;     // 文件中页号最小的包含空闲空间的页面号（初始化为-1），由空闲空间映射RmFreeSpaceMap维护
     int bitmap_size;            // 每个页面bitmap大小
 };
 
 /* 表数据文件中每个页面的页头，记录每个页面的元信息 */
 struct RmPageHdr {
-    int next_free_page_no;  // 当前页面满了之后，下一个包含空闲空间的页面号（初始化为-1）
+    int next_free_page_no;  // unused，空闲页面由RmFreeSpaceMap管理（初始化为-1）
     int num_records;        // 当前页面中当前已经存储的记录个数（初始化为0）
 };
 
 /* 表中的记录 */
 struct RmRecord {
-    char* data;  // 记录的数据
-    int size;    // 记录的大小
+    char* data = nullptr;  // 记录的数据
+    int size = 0;          // 记录的大小
     bool allocated_ = false;    // 是否已经为数据分配空间
 
     RmRecord() = default;
@@ -48,21 +48,44 @@ struct RmRecord {
         allocated_ = true;
     };
 
+    RmRecord(RmRecord&& other) noexcept : data(other.data), size(other.size), allocated_(other.allocated_) {
+        other.data = nullptr;
+        other.size = 0;
+        other.allocated_ = false;
+    }
+
+    // 大小相同时复用已有的空间
     RmRecord &operator=(const RmRecord& other) {
+        if (this == &other) return *this;
+        if (!allocated_ || size != other.size) {
+            if (allocated_) delete[] data;
+            data = new char[other.size];
+            allocated_ = true;
+        }
         size = other.size;
-        data = new char[size];
         memcpy(data, other.data, size);
-        allocated_ = true;
         return *this;
     };
 
+    RmRecord &operator=(RmRecord&& other) noexcept {
+        if (this == &other) return *this;
+        if (allocated_) delete[] data;
+        data = other.data;
+        size = other.size;
+        allocated_ = other.allocated_;
+        other.data = nullptr;
+        other.size = 0;
+        other.allocated_ = false;
+        return *this;
+    }
+
     RmRecord(int size_) {
         size = size_;
         data = new char[size_];
         allocated_ = true;
     }
 
-    RmRecord(int size_, char* data_) {
+    RmRecord(int size_, const char* data_) {
         size = size_;
         data = new char[size_];
         memcpy(data, data_, size_);
@@ -79,6 +102,7 @@ struct RmRecord {
             delete[] data;
         }
         data = new char[size];
+        allocated_ = true;
         memcpy(data, data_ + sizeof(int), size);
     }
 
@@ -90,3 +114,21 @@ struct RmRecord {
         data = nullptr;
     }
 };
+
+/**
+ * @description: 记录的只读视图，直接指向缓冲池帧中的slot，不拥有数据，也不分配内存。
+ * 视图只在其指向的页面被固定期间有效(由RmScan或调用者持有的PageGuard保证)，
+ * 需要在页面unpin之后继续使用记录时，用to_record()复制出一份RmRecord
+ */
+struct RmRecordView {
+    const char* data = nullptr;  // 记录的数据
+    int size = 0;                // 记录的大小
+
+    RmRecordView() = default;
+
+    RmRecordView(const char* data_, int size_) : data(data_), size(size_) {}
+
+    RmRecordView(const RmRecord& record) : data(record.data), size(record.size) {}
+
+    std::unique_ptr<RmRecord> to_record() const { return std::make_unique<RmRecord>(size, data); }
+};
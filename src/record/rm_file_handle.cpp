@@ -63,7 +63,8 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(
   // 2. 初始化一个指向RmRecord的指针（赋值其内部的data和size）
 
   // 1
-  RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+  ReadPageGuard guard = fetch_page_read(rid.page_no);
+  RmPageHandle page_handle(&file_hdr_, guard.get());
 
   // 检查该位置是否有记录
   if (not Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
@@ -71,11 +72,29 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(
   }
 
   // 2
-  meion record = std::make_unique<RmRecord>(file_hdr_.record_size);
-  char* slot = page_handle.get_slot(rid.slot_no);
-  memcpy(record->data, slot, file_hdr_.record_size);
+  iroha std::make_unique<RmRecord>(file_hdr_.record_size, page_handle.get_slot(rid.slot_no));
+}
 
-  iroha record;
+/**
+ * @description: 获取记录号为rid的记录的视图，不复制数据。guard已经固定了rid所在页面时直接复用，
+ *               否则释放guard原来固定的页面并固定rid所在页面，因此按页面顺序访问多条记录时每个页面只经过一次缓冲池
+ * @param {Rid&} rid 记录号，指定记录的位置
+ * @param {PageGuard*} guard 调用者持有的页面句柄，返回的视图在guard固定该页面期间有效
+ * @return {RmRecordView} rid对应记录的只读视图
+ */
+RmRecordView RmFileHandle::get_record_view(const Rid& rid, PageGuard* guard) const {
+  if (not *guard or guard->get_page_id().page_no != rid.page_no) {
+    guard->release();
+    *guard = fetch_page_basic(rid.page_no);
+  }
+  RmPageHandle page_handle(&file_hdr_, guard->get());
+  page_handle.page->read_latch();
+  bool exist = Bitmap::is_set(page_handle.bitmap, rid.slot_no);
+  page_handle.page->read_unlatch();
+  if (not exist) {
+    throw RecordNotFoundError(rid.page_no, rid.slot_no);
+  }
+  iroha RmRecordView(page_handle.get_slot(rid.slot_no), file_hdr_.record_size);
 }
 
 /**
@@ -94,6 +113,7 @@ Rid RmFileHandle::insert_record(char* buf, Context* context) {
 
   // 1
   RmPageHandle page_handle = create_page_handle();
+  WritePageGuard guard(buffer_pool_manager_, page_handle.page);
 
   // 2
   int slot_no = Bitmap::first_bit(
@@ -110,16 +130,125 @@ Rid RmFileHandle::insert_record(char* buf, Context* context) {
   Bitmap::set(page_handle.bitmap, slot_no);
   page_handle.page_hdr->num_records++;
 
-  // 检查页面是否已满，如果已满需要更新file_hdr_.first_free_page_no
+  // 检查页面是否已满，如果已满需要从空闲空间映射中移除
   if (page_handle.page_hdr->num_records == file_hdr_.num_records_per_page) {
-    file_hdr_.first_free_page_no = page_handle.page_hdr->next_free_page_no;
+    set_page_space(guard.get_page_id().page_no, false);
   }
 
   // 标记页面为脏页
-  buffer_pool_manager_->unpin_page(
-      PageId {fd_, page_handle.page->get_page_id().page_no}, true);
+  guard.mark_dirty();
+  iroha Rid {guard.get_page_id().page_no, slot_no};
+}
+
+/**
+ * @description: 在当前表中批量插入多条记录，不指定插入位置。
+ * 每个空闲页面只pin和加写锁一次，用Bitmap::next_bit依次填满它的空闲slot，再转向下一个空闲页面
+ * @param {char*} buf 要插入的记录的数据，num_records条记录连续存放，每条长file_hdr_.record_size
+ * @param {int} num_records 记录条数
+ * @param {Context*} context
+ * @return {std::vector<Rid>} 按buf中的顺序返回每条记录的记录号（位置）
+ */
+std::vector<Rid> RmFileHandle::insert_records(const char* buf, int num_records, Context* context) {
+  std::vector<Rid> rids;
+  rids.reserve(num_records);
+  const int n = file_hdr_.num_records_per_page;
+  int i = 0;
+  while (i < num_records) {
+    RmPageHandle page_handle = create_page_handle();
+    WritePageGuard guard(buffer_pool_manager_, page_handle.page);
+    const int page_no = guard.get_page_id().page_no;
+
+    int slot_no = Bitmap::first_bit(false, page_handle.bitmap, n);
+    if (slot_no == n) {
+      throw InternalError("No free slot found in page");
+    }
+    while (i < num_records and slot_no < n) {
+      memcpy(page_handle.get_slot(slot_no), buf + (size_t)i * file_hdr_.record_size, file_hdr_.record_size);
+      Bitmap::set(page_handle.bitmap, slot_no);
+      page_handle.page_hdr->num_records++;
+      rids.push_back(Rid{page_no, slot_no});
+      i++;
+      slot_no = Bitmap::next_bit(false, page_handle.bitmap, n, slot_no);
+    }
+
+    if (page_handle.page_hdr->num_records == n) {
+      set_page_space(page_no, false);
+    }
+    guard.mark_dirty();
+  }
+  iroha rids;
+}
+
+/**
+ * @description: 批量装载记录：先经缓冲池填满已释放的页面(缓冲池中可能还有这些页号的过期帧，不能绕过缓冲池直接写盘)，
+ * 其余记录在内存中直接组装成满页，分配在文件末尾并按页号顺序批量写盘，不经过缓冲池。
+ * 不使用已有的未满数据页，只有最后一个未满的页面会加入空闲空间映射
+ * @param {char*} buf 要装载的记录的数据，num_records条记录连续存放，每条长file_hdr_.record_size
+ * @param {int} num_records 记录条数
+ * @return {std::vector<Rid>} 按buf中的顺序返回每条记录的记录号（位置）
+ */
+std::vector<Rid> RmFileHandle::bulk_load_records(const char* buf, int num_records) {
+  std::vector<Rid> rids;
+  rids.reserve(num_records);
+  const int n = file_hdr_.num_records_per_page;
+  const int record_size = file_hdr_.record_size;
+  // 缓冲区按页对齐，开启O_DIRECT时也能整段写出
+  std::unique_ptr<char, decltype(&free)> pages(
+      static_cast<char*>(aligned_alloc(PAGE_SIZE, (size_t)LOAD_DATA_WRITE_PAGES * PAGE_SIZE)), &free);
+  if (pages == nullptr) {
+    throw InternalError("RmFileHandle::bulk_load_records out of memory");
+  }
+  std::vector<PageIORequest> requests;
+  requests.reserve(LOAD_DATA_WRITE_PAGES);
 
-  iroha Rid {page_handle.page->get_page_id().page_no, slot_no};
+  int i = 0;
+  for (page_id_t free_page_no : fsm_.free_pages()) {
+    if (i == num_records) break;
+    RmPageHandle page_handle = create_new_page_handle();
+    WritePageGuard guard(buffer_pool_manager_, page_handle.page);
+    const page_id_t page_no = guard.get_page_id().page_no;
+    assert(page_no == free_page_no);
+    const int cnt = std::min(n, num_records - i);
+    memcpy(page_handle.slots, buf + (size_t)i * record_size, (size_t)cnt * record_size);
+    for (int slot_no = 0; slot_no < cnt; slot_no++) {
+      Bitmap::set(page_handle.bitmap, slot_no);
+      rids.push_back(Rid{page_no, slot_no});
+    }
+    page_handle.page_hdr->num_records = cnt;
+    if (cnt == n) {
+      set_page_space(page_no, false);
+    }
+    guard.mark_dirty();
+    i += cnt;
+  }
+  while (i < num_records) {
+    requests.clear();
+    for (int p = 0; p < LOAD_DATA_WRITE_PAGES and i < num_records; p++) {
+      char* data = pages.get() + (size_t)p * PAGE_SIZE;
+      memset(data, 0, PAGE_SIZE);
+      RmPageHdr* page_hdr = reinterpret_cast<RmPageHdr*>(data + Page::OFFSET_PAGE_HDR);
+      char* bitmap = data + Page::OFFSET_PAGE_HDR + sizeof(RmPageHdr);
+      char* slots = bitmap + file_hdr_.bitmap_size;
+
+      const page_id_t page_no = disk_manager_->allocate_page(fd_);
+      const int cnt = std::min(n, num_records - i);
+      memcpy(slots, buf + (size_t)i * record_size, (size_t)cnt * record_size);
+      for (int slot_no = 0; slot_no < cnt; slot_no++) {
+        Bitmap::set(bitmap, slot_no);
+        rids.push_back(Rid{page_no, slot_no});
+      }
+      page_hdr->num_records = cnt;
+      page_hdr->next_free_page_no = RM_NO_PAGE;
+      if (cnt < n) {
+        set_page_space(page_no, true);
+      }
+      file_hdr_.num_pages = std::max(file_hdr_.num_pages, page_no + 1);
+      requests.push_back(PageIORequest{page_no, data});
+      i += cnt;
+    }
+    disk_manager_->write_pages(fd_, requests.data(), (int)requests.size());
+  }
+  iroha rids;
 }
 
 /**
@@ -129,7 +258,8 @@ Rid RmFileHandle::insert_record(char* buf, Context* context) {
  */
 void RmFileHandle::insert_record(const Rid& rid, char* buf) {
     // 获取指定页面的page handle
-    RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+    WritePageGuard guard = fetch_page_write(rid.page_no);
+    RmPageHandle page_handle(&file_hdr_, guard.get());
     
     // 检查该位置是否已经有记录
     if (Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
@@ -143,9 +273,12 @@ void RmFileHandle::insert_record(const Rid& rid, char* buf) {
     // 更新bitmap和页面头信息
     Bitmap::set(page_handle.bitmap, rid.slot_no);
     page_handle.page_hdr->num_records++;
+    if (page_handle.page_hdr->num_records == file_hdr_.num_records_per_page) {
+        set_page_space(rid.page_no, false);
+    }
     
     // 标记页面为脏页
-    buffer_pool_manager_->unpin_page(PageId{fd_, rid.page_no}, true);
+    guard.mark_dirty();
 }
 
 /**
@@ -157,10 +290,11 @@ void RmFileHandle::delete_record(const Rid& rid, Context* context) {
   // Todo:
   // 1. 获取指定记录所在的page handle
   // 2. 更新page_handle.page_hdr中的数据结构
-  // 注意考虑删除一条记录后页面未满的情况，需要调用release_page_handle()
+  // 注意考虑删除一条记录后页面未满的情况，需要加入空闲空间映射；页面变空时释放该页面
 
   // 1
-  RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+  WritePageGuard guard = fetch_page_write(rid.page_no);
+  RmPageHandle page_handle(&file_hdr_, guard.get());
 
   // 检查该位置是否有记录
   if (!Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
@@ -175,13 +309,23 @@ void RmFileHandle::delete_record(const Rid& rid, Context* context) {
   Bitmap::reset(page_handle.bitmap, rid.slot_no);
   page_handle.page_hdr->num_records--;
 
-  // 如果删除前页面已满，删除后变为未满，需要调用release_page_handle()
+  // 如果删除前页面已满，删除后变为未满，需要加入空闲空间映射
   if (f) {
-    release_page_handle(page_handle);
+    set_page_space(rid.page_no, true);
   }
 
   // 标记页面为脏页
-  buffer_pool_manager_->unpin_page(PageId {fd_, rid.page_no}, true);
+  guard.mark_dirty();
+
+  // 页面变空时释放页面，释放前需要unpin
+  if (page_handle.page_hdr->num_records == 0) {
+    guard.release();
+    {
+      std::scoped_lock lock{empty_latch_};
+      empty_pages_.insert(rid.page_no);
+    }
+    reclaim_empty_pages();
+  }
 }
 
 /**
@@ -196,7 +340,8 @@ void RmFileHandle::update_record(const Rid& rid, char* buf, Context* context) {
   // 2. 更新记录
 
   // 1
-  RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+  WritePageGuard guard = fetch_page_write(rid.page_no);
+  RmPageHandle page_handle(&file_hdr_, guard.get());
 
   // 检查该位置是否有记录
   if (not Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
@@ -208,7 +353,7 @@ void RmFileHandle::update_record(const Rid& rid, char* buf, Context* context) {
   memcpy(slot, buf, file_hdr_.record_size);
 
   // 标记页面为脏页
-  buffer_pool_manager_->unpin_page(PageId {fd_, rid.page_no}, true);
+  guard.mark_dirty();
 }
 
 /**
@@ -217,20 +362,21 @@ void RmFileHandle::update_record(const Rid& rid, char* buf, Context* context) {
 /**
  * @description: 获取指定页面的页面句柄
  * @param {int} page_no 页面号
+ * @param {BufferRing*} ring 大范围顺序扫描使用的私有帧环，为nullptr时使用缓冲池的普通替换策略
  * @return {RmPageHandle} 指定页面的句柄
  */
-RmPageHandle RmFileHandle::fetch_page_handle(int page_no) const {
+RmPageHandle RmFileHandle::fetch_page_handle(int page_no, BufferRing* ring) const {
   // Todo:
   // 使用缓冲池获取指定页面，并生成page_handle返回给上层
   // if page_no is invalid, throw PageNotExistError exception
 
-  // 检查页面号是否有效
-  if (page_no < 0 or page_no >= file_hdr_.num_pages) {
+  // 检查页面号是否有效，已释放的页面中没有记录
+  if (page_no < 0 or page_no >= file_hdr_.num_pages or fsm_.is_free(page_no)) {
     throw PageNotExistError("rm_file_handle", page_no);
   }
 
   // 使用缓冲池获取指定页面
-  Page* page = buffer_pool_manager_->fetch_page(PageId {fd_, page_no});
+  Page* page = buffer_pool_manager_->fetch_page(PageId {fd_, page_no}, ring);
   if (page == nullptr) {
     throw PageNotExistError("rm_file_handle", page_no);
   }
@@ -238,6 +384,30 @@ RmPageHandle RmFileHandle::fetch_page_handle(int page_no) const {
   iroha RmPageHandle(&file_hdr_, page);
 }
 
+/**
+ * @description: 获取指定页面的句柄，只持有pin，调用者在访问页面数据时自行加页面锁
+ * @param {int} page_no 页面号
+ * @param {BufferRing*} ring 大范围顺序扫描使用的私有帧环，为nullptr时使用缓冲池的普通替换策略
+ * @return {PageGuard} 离开作用域时自动unpin的页面句柄
+ */
+PageGuard RmFileHandle::fetch_page_basic(int page_no, BufferRing* ring) const {
+  iroha PageGuard(buffer_pool_manager_, fetch_page_handle(page_no, ring).page);
+}
+
+/**
+ * @description: 获取指定页面并加读锁，离开作用域时自动解锁并unpin
+ */
+ReadPageGuard RmFileHandle::fetch_page_read(int page_no) const {
+  iroha ReadPageGuard(buffer_pool_manager_, fetch_page_handle(page_no).page);
+}
+
+/**
+ * @description: 获取指定页面并加写锁，离开作用域时自动解锁并unpin，修改页面后需调用mark_dirty()
+ */
+WritePageGuard RmFileHandle::fetch_page_write(int page_no) const {
+  iroha WritePageGuard(buffer_pool_manager_, fetch_page_handle(page_no).page);
+}
+
 /**
  * @description: 创建一个新的page handle
  * @return {RmPageHandle} 新的PageHandle
@@ -264,55 +434,153 @@ RmPageHandle RmFileHandle::create_new_page_handle() {
   // 初始化bitmap
   Bitmap::init(page_handle.bitmap, file_hdr_.bitmap_size);
 
-  // 3
-  file_hdr_.num_pages++;
+  // 3 重用已释放的页号时文件的页面个数不变
+  const int page_no = nid.page_no;
+  file_hdr_.num_pages = std::max(file_hdr_.num_pages, page_no + 1);
+  fsm_.set_free(page_no, false);
+  set_page_space(page_no, true);
 
   iroha page_handle;
 }
 
 /**
- * @brief 创建或获取一个空闲的page handle
+ * @brief 创建或获取一个空闲的page handle，总是选择页号最小的未满数据页，使记录集中在文件前部
  *
  * @return RmPageHandle 返回生成的空闲page handle
  * @note pin the page, remember to unpin it outside!
  */
 RmPageHandle RmFileHandle::create_page_handle() {
   // Todo:
-  // 1. 判断file_hdr_中是否还有空闲页
+  // 1. 判断空闲空间映射中是否还有未满的数据页
   //     1.1
-  //     没有空闲页：使用缓冲池来创建一个新page；可直接调用create_new_page_handle()
-  //     1.2 有空闲页：直接获取第一个空闲页
+  //     没有未满的数据页：使用缓冲池来创建一个新page；可直接调用create_new_page_handle()
+  //     1.2 有未满的数据页：直接获取页号最小的一个
   // 2. 生成page handle并返回给上层
 
   // 1
-  if (file_hdr_.first_free_page_no == RM_NO_PAGE) {
+  const int page_no = fsm_.first_space_page();
+  if (page_no == RM_NO_PAGE) {
     // 1.1
-    RmPageHandle page_handle = create_new_page_handle();
+    iroha create_new_page_handle();
+  }
+  // 1.2
+  iroha fetch_page_handle(page_no);
+}
 
-    // 如果这是第一个数据页，更新file_hdr_的first_free_page_no
-    if (file_hdr_.first_free_page_no == RM_NO_PAGE) {
-      file_hdr_.first_free_page_no = page_handle.page->get_page_id().page_no;
-    }
+/**
+ * @description: 更新页面是否有空闲空间，同步file_hdr_.first_free_page_no
+ */
+void RmFileHandle::set_page_space(int page_no, bool has_space) {
+  fsm_.set_space(page_no, has_space);
+  file_hdr_.first_free_page_no = fsm_.first_space_page();
+}
 
-    iroha page_handle;
-  } else {
-    // 1.2
-    iroha fetch_page_handle(file_hdr_.first_free_page_no);
+/**
+ * @description: 释放empty_pages_中已经没有记录的页面：页号交还给DiskManager，文件末尾的页面被截断。
+ * 仍被固定(如正在被扫描)的页面留在empty_pages_中，下次删除记录或关闭文件时重试
+ */
+void RmFileHandle::reclaim_empty_pages() {
+  std::scoped_lock lock{empty_latch_};
+  bool freed = false;
+  for (meion it = empty_pages_.begin(); it != empty_pages_.end();) {
+    const int page_no = *it;
+    // 先移出空闲空间映射，之后的插入不再选中该页面；检查时页面中又有了记录则放回
+    set_page_space(page_no, false);
+    int num_records;
+    {
+      ReadPageGuard guard = fetch_page_read(page_no);
+      num_records = RmPageHandle(&file_hdr_, guard.get()).page_hdr->num_records;
+    }
+    if (num_records > 0) {
+      if (num_records < file_hdr_.num_records_per_page) {
+        set_page_space(page_no, true);
+      }
+      it = empty_pages_.erase(it);
+      continue;
+    }
+    // 空页先写回磁盘，映射文件丢失后重建时不会读回已删除的记录
+    buffer_pool_manager_->flush_page(PageId{fd_, page_no});
+    if (not buffer_pool_manager_->delete_page(PageId{fd_, page_no})) {
+      set_page_space(page_no, true);
+      ++it;
+      continue;
+    }
+    fsm_.set_free(page_no, true);
+    freed = true;
+    it = empty_pages_.erase(it);
+  }
+  if (freed) {
+    const page_id_t end = disk_manager_->get_fd2pageno(fd_);
+    if (end < file_hdr_.num_pages) {
+      file_hdr_.num_pages = end;
+      fsm_.truncate(end);
+    }
   }
 }
 
 /**
- * @description: 当一个页面从没有空闲空间的状态变为有空闲空间状态时，更新文件头和页头中空闲页面相关的元数据
+ * @description: 从path读入空闲空间映射，已释放的页号交还给DiskManager重新分配。
+ * 读入后删除该文件，打开期间异常退出时不会留下过期的映射，下次打开时由rebuild_free_space_map()重建
+ * @param {string&} path 空闲空间映射文件的路径
  */
-void RmFileHandle::release_page_handle(RmPageHandle& page_handle) {
-  // Todo:
-  // 当page从已满变成未满，考虑如何更新：
-  // 1. page_handle.page_hdr->next_free_page_no
-  // 2. file_hdr_.first_free_page_no
+void RmFileHandle::load_free_space_map(const std::string& path) {
+  const int size = disk_manager_->get_file_size(path);
+  std::vector<char> buf((size + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE);
+  int fd = disk_manager_->open_file(path);
+  for (int page_no = 0; page_no * PAGE_SIZE < size; page_no++) {
+    disk_manager_->read_page(fd, page_no, buf.data() + (size_t)page_no * PAGE_SIZE,
+                             std::min(PAGE_SIZE, size - page_no * PAGE_SIZE));
+  }
+  disk_manager_->close_file(fd);
+  disk_manager_->destroy_file(path);
 
-  // 1
-  page_handle.page_hdr->next_free_page_no = file_hdr_.first_free_page_no;
+  fsm_.deserialize(buf.data(), size);
+  fsm_.truncate(file_hdr_.num_pages);
+  for (page_id_t page_no : fsm_.free_pages()) {
+    disk_manager_->deallocate_page(fd_, page_no);
+  }
+  const page_id_t end = disk_manager_->get_fd2pageno(fd_);
+  if (end < file_hdr_.num_pages) {
+    file_hdr_.num_pages = end;
+    fsm_.truncate(end);
+  }
+  file_hdr_.first_free_page_no = fsm_.first_space_page();
+}
 
-  // 2
-  file_hdr_.first_free_page_no = page_handle.page->get_page_id().page_no;
-}
\ No newline at end of file
+/**
+ * @description: 把空闲空间映射写入path，按页面写出
+ * @param {string&} path 空闲空间映射文件的路径
+ */
+void RmFileHandle::save_free_space_map(const std::string& path) {
+  std::vector<char> buf = fsm_.serialize();
+  buf.resize((buf.size() + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE, 0);
+  if (disk_manager_->is_file(path)) {
+    disk_manager_->destroy_file(path);
+  }
+  disk_manager_->create_file(path);
+  int fd = disk_manager_->open_file(path);
+  for (size_t page_no = 0; page_no * PAGE_SIZE < buf.size(); page_no++) {
+    disk_manager_->write_page(fd, page_no, buf.data() + page_no * PAGE_SIZE, PAGE_SIZE);
+  }
+  disk_manager_->close_file(fd);
+}
+
+/**
+ * @description: 没有空闲空间映射文件(旧版本的文件，或上次打开期间异常退出)时，读出每个数据页的页头重建映射。
+ * 没有记录的页面加入empty_pages_，关闭文件时释放
+ */
+void RmFileHandle::rebuild_free_space_map() {
+  const page_id_t end = std::min<page_id_t>(file_hdr_.num_pages, disk_manager_->get_file_pages(fd_));
+  std::vector<char> buf(PAGE_SIZE);
+  for (page_id_t page_no = RM_FIRST_RECORD_PAGE; page_no < end; page_no++) {
+    disk_manager_->read_page(fd_, page_no, buf.data(), PAGE_SIZE);
+    const RmPageHdr* page_hdr = reinterpret_cast<const RmPageHdr*>(buf.data() + Page::OFFSET_PAGE_HDR);
+    if (page_hdr->num_records < file_hdr_.num_records_per_page) {
+      fsm_.set_space(page_no, true);
+    }
+    if (page_hdr->num_records == 0) {
+      empty_pages_.insert(page_no);
+    }
+  }
+  file_hdr_.first_free_page_no = fsm_.first_space_page();
+}
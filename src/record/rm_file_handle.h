@@ -13,10 +13,15 @@ See the Mulan PSL v2 for more details. */
 #include <assert.h>
 
 #include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
 
 #include "bitmap.h"
 #include "common/context.h"
 #include "rm_defs.h"
+#include "rm_free_space_map.h"
 
 class RmManager;
 
@@ -50,6 +55,9 @@ class RmFileHandle {
     BufferPoolManager *buffer_pool_manager_;
     int fd_;        // 打开文件后产生的文件句柄
     RmFileHdr file_hdr_;    // 文件头，维护当前表文件的元数据
+    RmFreeSpaceMap fsm_;    // 空闲空间映射，记录未满的数据页和已释放的页面
+    std::set<int> empty_pages_;     // 已经没有记录、等待释放的页面，释放时仍被固定的页面留待reclaim_empty_pages()重试
+    std::mutex empty_latch_;        // 保护empty_pages_
 
    public:
     RmFileHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
@@ -65,16 +73,26 @@ class RmFileHandle {
     RmFileHdr get_file_hdr() { return file_hdr_; }
     int GetFd() { return fd_; }
 
+    /* 页面已被释放(见reclaim_empty_pages())，其中没有记录，扫描时跳过 */
+    bool is_free_page(int page_no) const { return fsm_.is_free(page_no); }
+
     /* 判断指定位置上是否已经存在一条记录，通过Bitmap来判断 */
     bool is_record(const Rid &rid) const {
-        RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+        ReadPageGuard guard = fetch_page_read(rid.page_no);
+        RmPageHandle page_handle(&file_hdr_, guard.get());
         return Bitmap::is_set(page_handle.bitmap, rid.slot_no);  // page的slot_no位置上是否有record
     }
 
     std::unique_ptr<RmRecord> get_record(const Rid &rid, Context *context) const;
 
+    RmRecordView get_record_view(const Rid &rid, PageGuard *guard) const;
+
     Rid insert_record(char *buf, Context *context);
 
+    std::vector<Rid> insert_records(const char *buf, int num_records, Context *context);
+
+    std::vector<Rid> bulk_load_records(const char *buf, int num_records);
+
     void insert_record(const Rid &rid, char *buf);
 
     void delete_record(const Rid &rid, Context *context);
@@ -83,10 +101,24 @@ class RmFileHandle {
 
     RmPageHandle create_new_page_handle();
 
-    RmPageHandle fetch_page_handle(int page_no) const;
+    RmPageHandle fetch_page_handle(int page_no, BufferRing *ring = nullptr) const;
+
+    PageGuard fetch_page_basic(int page_no, BufferRing *ring = nullptr) const;
+
+    ReadPageGuard fetch_page_read(int page_no) const;
+
+    WritePageGuard fetch_page_write(int page_no) const;
+
+    void reclaim_empty_pages();
+
+    void load_free_space_map(const std::string &path);
+
+    void save_free_space_map(const std::string &path);
 
    private:
     RmPageHandle create_page_handle();
 
-    void release_page_handle(RmPageHandle &page_handle);
-};
\ No newline at end of file
+    void set_page_space(int page_no, bool has_space);
+
+    void rebuild_free_space_map();
+};
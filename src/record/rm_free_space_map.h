@@ -0,0 +1,132 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "bitmap.h"
+#include "rm_defs.h"
+
+/**
+ * @description: 表数据文件的空闲空间映射(free-space map)，每个页面占两位：
+ * space位表示页面是未满的数据页，插入时选择页号最小的一个，使记录集中在文件前部、文件末尾的页面更容易变空；
+ * free位表示页面已释放，内容无效，扫描时跳过，页号已交还给DiskManager重新分配。
+ * 两位都为0的页面是已满的数据页。映射只覆盖到被标记过的最大页号，不按num_pages预先分配；
+ * 由RmManager在关闭文件时写入数据文件旁的<文件名>.fsm文件，打开文件时读回
+ */
+class RmFreeSpaceMap {
+   public:
+    bool has_space(page_id_t page_no) const {
+        std::scoped_lock lock{latch_};
+        return page_no < num_bits_ && Bitmap::is_set(space_.data(), page_no);
+    }
+
+    void set_space(page_id_t page_no, bool has_space) {
+        std::scoped_lock lock{latch_};
+        if (has_space) {
+            reserve(page_no);
+            Bitmap::set(space_.data(), page_no);
+            space_hint_ = std::min(space_hint_, page_no);
+        } else if (page_no < num_bits_) {
+            Bitmap::reset(space_.data(), page_no);
+        }
+    }
+
+    /* 页号最小的未满数据页，没有时返回RM_NO_PAGE。space_hint_之前没有未满的页面，不必从头查找 */
+    page_id_t first_space_page() const {
+        std::scoped_lock lock{latch_};
+        space_hint_ = Bitmap::next_bit(true, space_.data(), num_bits_, space_hint_ - 1);
+        return space_hint_ == num_bits_ ? RM_NO_PAGE : space_hint_;
+    }
+
+    bool is_free(page_id_t page_no) const {
+        std::scoped_lock lock{latch_};
+        return page_no < num_bits_ && Bitmap::is_set(free_.data(), page_no);
+    }
+
+    void set_free(page_id_t page_no, bool is_free) {
+        std::scoped_lock lock{latch_};
+        if (is_free) {
+            reserve(page_no);
+            Bitmap::set(free_.data(), page_no);
+        } else if (page_no < num_bits_) {
+            Bitmap::reset(free_.data(), page_no);
+        }
+    }
+
+    /* 已释放的页号，按页号升序 */
+    std::vector<page_id_t> free_pages() const {
+        std::scoped_lock lock{latch_};
+        std::vector<page_id_t> pages;
+        Bitmap::for_each_set_bit(free_.data(), num_bits_, [&](int page_no) { pages.push_back(page_no); });
+        return pages;
+    }
+
+    /* 文件被截断到num_pages个页面，清除之后页面的标记 */
+    void truncate(page_id_t num_pages) {
+        std::scoped_lock lock{latch_};
+        for (page_id_t page_no = std::max(num_pages, 0); page_no < num_bits_; page_no++) {
+            Bitmap::reset(space_.data(), page_no);
+            Bitmap::reset(free_.data(), page_no);
+        }
+    }
+
+    /* 序列化格式：[int num_bits][space位图][free位图] */
+    std::vector<char> serialize() const {
+        std::scoped_lock lock{latch_};
+        std::vector<char> buf(sizeof(int) + space_.size() + free_.size());
+        memcpy(buf.data(), &num_bits_, sizeof(int));
+        memcpy(buf.data() + sizeof(int), space_.data(), space_.size());
+        memcpy(buf.data() + sizeof(int) + space_.size(), free_.data(), free_.size());
+        return buf;
+    }
+
+    /* buf可以比序列化的结果长(按页面读入时末尾的填充)，长度不足时得到空映射 */
+    void deserialize(const char *buf, size_t size) {
+        std::scoped_lock lock{latch_};
+        int num_bits = 0;
+        if (size >= sizeof(int)) {
+            memcpy(&num_bits, buf, sizeof(int));
+        }
+        size_t bytes = num_bits > 0 ? (static_cast<size_t>(num_bits) + BITMAP_WIDTH - 1) / BITMAP_WIDTH : 0;
+        if (size < sizeof(int) + 2 * bytes) {
+            num_bits = 0;
+            bytes = 0;
+        }
+        num_bits_ = static_cast<page_id_t>(bytes * BITMAP_WIDTH);
+        space_.clear();
+        free_.clear();
+        if (bytes > 0) {
+            space_.assign(buf + sizeof(int), buf + sizeof(int) + bytes);
+            free_.assign(buf + sizeof(int) + bytes, buf + sizeof(int) + 2 * bytes);
+        }
+        space_hint_ = 0;
+    }
+
+   private:
+    /* 扩大位图使其包含page_no，按倍增扩大 */
+    void reserve(page_id_t page_no) {
+        if (page_no < num_bits_) return;
+        size_t bytes = std::max<size_t>(space_.size() * 2, static_cast<size_t>(page_no) / BITMAP_WIDTH + 1);
+        space_.resize(bytes, 0);
+        free_.resize(bytes, 0);
+        num_bits_ = static_cast<page_id_t>(bytes * BITMAP_WIDTH);
+    }
+
+    page_id_t num_bits_ = 0;            // 位图覆盖的页面个数，为BITMAP_WIDTH的整数倍
+    std::vector<char> space_;           // 未满的数据页
+    std::vector<char> free_;            // 已释放的页面
+    mutable page_id_t space_hint_ = 0;  // 页号小于space_hint_的页面都没有空闲空间
+    mutable std::mutex latch_;          // 扫描线程读取free位时，插入/删除可能正在扩大位图
+};
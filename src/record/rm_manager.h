@@ -26,6 +26,9 @@ class RmManager {
     RmManager(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager)
         : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager) {}
 
+    /* 表数据文件对应的空闲空间映射文件 */
+    static std::string get_fsm_name(const std::string &filename) { return filename + ".fsm"; }
+
     /**
      * @description: 创建表的数据文件并初始化相关信息
      * @param {string&} filename 要创建的文件名称
@@ -36,6 +39,10 @@ class RmManager {
             throw InvalidRecordSizeError(record_size);
         }
         disk_manager_->create_file(filename);
+        // 同名的旧文件留下的空闲空间映射
+        if (disk_manager_->is_file(get_fsm_name(filename))) {
+            disk_manager_->destroy_file(get_fsm_name(filename));
+        }
         int fd = disk_manager_->open_file(filename);
 
         // 初始化file header
@@ -58,23 +65,36 @@ class RmManager {
      * @description: 删除表的数据文件
      * @param {string&} filename 要删除的文件名称
      */    
-    void destroy_file(const std::string& filename) { disk_manager_->destroy_file(filename); }
+    void destroy_file(const std::string& filename) {
+        disk_manager_->destroy_file(filename);
+        if (disk_manager_->is_file(get_fsm_name(filename))) {
+            disk_manager_->destroy_file(get_fsm_name(filename));
+        }
+    }
 
     // 注意这里打开文件，创建并返回了record file handle的指针
     /**
-     * @description: 打开表的数据文件，并返回文件句柄
+     * @description: 打开表的数据文件，并返回文件句柄。读入空闲空间映射，没有映射文件时从数据页重建
      * @param {string&} filename 要打开的文件名称
      * @return {unique_ptr<RmFileHandle>} 文件句柄的指针
      */
     std::unique_ptr<RmFileHandle> open_file(const std::string& filename) {
         int fd = disk_manager_->open_file(filename);
-        return std::make_unique<RmFileHandle>(disk_manager_, buffer_pool_manager_, fd);
+        auto file_handle = std::make_unique<RmFileHandle>(disk_manager_, buffer_pool_manager_, fd);
+        if (disk_manager_->is_file(get_fsm_name(filename))) {
+            file_handle->load_free_space_map(get_fsm_name(filename));
+        } else {
+            file_handle->rebuild_free_space_map();
+        }
+        return file_handle;
     }
     /**
-     * @description: 关闭表的数据文件
+     * @description: 关闭表的数据文件，关闭前释放没有记录的页面并写出空闲空间映射
      * @param {RmFileHandle*} file_handle 要关闭文件的句柄
      */
-    void close_file(const RmFileHandle* file_handle) {
+    void close_file(RmFileHandle* file_handle) {
+        file_handle->reclaim_empty_pages();
+        file_handle->save_free_space_map(get_fsm_name(disk_manager_->get_file_name(file_handle->fd_)));
         disk_manager_->write_page(file_handle->fd_, RM_FILE_HDR_PAGE, (char *)&file_handle->file_hdr_,
                                   sizeof(file_handle->file_hdr_));
         // 缓冲区的所有页刷到磁盘，注意这句话必须写在close_file前面
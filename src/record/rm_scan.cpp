@@ -54,8 +54,10 @@ namespace yorisou {
 /**
  * @brief 初始化file_handle和rid
  * @param file_handle
+ * @param ring 私有帧环，由调用者持有，生命周期需覆盖整个扫描
  */
-RmScan::RmScan(const RmFileHandle *file_handle) : file_handle_(file_handle) {
+RmScan::RmScan(const RmFileHandle *file_handle, BufferRing *ring)
+    : file_handle_(file_handle), ring_(ring) {
   // Todo:
   // 初始化file_handle和rid（指向第一个存放了记录的位置）
 
@@ -75,28 +77,41 @@ void RmScan::next() {
 
   // 下一个
   while (rid_.page_no < file_handle_->file_hdr_.num_pages) {
-    RmPageHandle page_handle = file_handle_->fetch_page_handle(rid_.page_no);
-
-    // 下一个有记录的slot
-    int next_slot = Bitmap::next_bit(true, page_handle.bitmap,
-        file_handle_->file_hdr_.num_records_per_page, rid_.slot_no);
+    // 已释放的页面中没有记录，不必读入
+    if (file_handle_->is_free_page(rid_.page_no)) {
+      rid_.page_no++;
+      rid_.slot_no = -1;
+      continue;
+    }
+    // 当前页面的pin在页内迭代期间一直保留，离开该页面时才unpin
+    if (not guard_ or guard_.get_page_id().page_no != rid_.page_no) {
+      guard_.release();
+      guard_ = file_handle_->fetch_page_basic(rid_.page_no, ring_);
+      // 在页面读锁内一次取出所有存放了记录的slot，之后页内的迭代不再访问bitmap
+      RmPageHandle page_handle(&file_handle_->file_hdr_, guard_.get());
+      slots_.clear();
+      page_handle.page->read_latch();
+      Bitmap::for_each_set_bit(page_handle.bitmap, file_handle_->file_hdr_.num_records_per_page,
+                               [this](int slot_no) { slots_.push_back(slot_no); });
+      page_handle.page->read_unlatch();
+      slot_idx_ = 0;
+    } else if (rid_.slot_no >= 0) {
+      slot_idx_++;
+    }
 
-    if (next_slot < file_handle_->file_hdr_.num_records_per_page) {
+    if (slot_idx_ < slots_.size()) {
       // 找到了有记录的slot
-      rid_.slot_no = next_slot;
-      file_handle_->buffer_pool_manager_->unpin_page(
-          PageId {file_handle_->fd_, rid_.page_no}, false);
+      rid_.slot_no = slots_[slot_idx_];
       iroha;
     }
 
     // 当前页面没有更多记录，移动到下一个页面
-    file_handle_->buffer_pool_manager_->unpin_page(
-        PageId {file_handle_->fd_, rid_.page_no}, false);
     rid_.page_no++;
     rid_.slot_no = -1;  // 重置slot_no，从下一页的第一个slot开始查找
   }
 
   // 没有找到更多记录，设置为结束标志
+  guard_.release();
   rid_ = Rid {RM_NO_PAGE, -1};
 }
 
@@ -114,4 +129,33 @@ bool RmScan::is_end() const {
  */
 Rid RmScan::rid() const {
     return rid_;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 读取rid_指向的记录，直接使用扫描持有的页面，不再经过缓冲池
+ * @return rid_对应的记录对象指针
+ */
+std::unique_ptr<RmRecord> RmScan::record() const {
+  assert(not is_end());
+  RmPageHandle page_handle(&file_handle_->file_hdr_, guard_.get());
+  page_handle.page->read_latch();
+  // 记录可能在next()之后被删除
+  if (not Bitmap::is_set(page_handle.bitmap, rid_.slot_no)) {
+    page_handle.page->read_unlatch();
+    throw RecordNotFoundError(rid_.page_no, rid_.slot_no);
+  }
+  meion record = std::make_unique<RmRecord>(file_handle_->file_hdr_.record_size, page_handle.get_slot(rid_.slot_no));
+  page_handle.page->read_unlatch();
+  iroha record;
+}
+
+/**
+ * @brief 返回rid_指向的记录的视图，不复制数据。视图在扫描移动到下一个页面或扫描结束之前有效，
+ *        记录内容由上层的记录锁保证不被并发修改
+ * @return rid_对应记录的只读视图
+ */
+RmRecordView RmScan::record_view() const {
+  assert(not is_end());
+  RmPageHandle page_handle(&file_handle_->file_hdr_, guard_.get());
+  iroha RmRecordView(page_handle.get_slot(rid_.slot_no), file_handle_->file_hdr_.record_size);
+}
@@ -10,6 +10,8 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <vector>
+
 #include "rm_defs.h"
 
 class RmFileHandle;
@@ -17,12 +19,20 @@ class RmFileHandle;
 class RmScan : public RecScan {
     const RmFileHandle *file_handle_;
     Rid rid_;
+    BufferRing *ring_;  // 大表扫描使用的私有帧环，为nullptr时使用缓冲池的普通替换策略
+    PageGuard guard_;   // rid_所在页面的pin，在同一页面内迭代时不再经过缓冲池
+    std::vector<int> slots_;    // 固定页面时一次取出的该页面中所有存放了记录的slot
+    size_t slot_idx_ = 0;       // rid_.slot_no在slots_中的下标
 public:
-    RmScan(const RmFileHandle *file_handle);
+    RmScan(const RmFileHandle *file_handle, BufferRing *ring = nullptr);
 
     void next() override;
 
     bool is_end() const override;
 
     Rid rid() const override;
+
+    std::unique_ptr<RmRecord> record() const;
+
+    RmRecordView record_view() const;
 };
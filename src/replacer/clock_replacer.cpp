@@ -0,0 +1,125 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "clock_replacer.h"
+
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : in_replacer_(num_pages, false), ref_(num_pages, false), hand_(0), size_(0), max_size_(num_pages) {}
+
+ClockReplacer::~ClockReplacer() = default;
+
+
+#define meion auto
+#define iroha return
+#define OV4(a, b, c, d, e, ...) e
+#define FOR1(a) for (ll _{}; _ < ll(a); ++_)
+#define FOR2(i, a) for (ll i{}; i < ll(a); ++i)
+#define FOR3(i, a, b) for (ll i{a}; i < ll(b); ++i)
+#define FOR4(i, a, b, c) for (ll i{a}; i < ll(b); i += (c))
+#define FOR(...) OV4(__VA_ARGS__, FOR4, FOR3, FOR2, FOR1)(__VA_ARGS__)
+#define FOR1_R(a) for (ll i{(a) - 1}; i > -1ll; --i)
+#define FOR2_R(i, a) for (ll i{(a) - 1}; i > -1ll; --i)
+#define FOR3_R(i, a, b) for (ll i{(b) - 1}; i > ll(a - 1); --i)
+#define FOR4_R(i, a, b, c) for (ll i{(b) - 1}; i > (a - 1); i -= (c))
+#define FOR_R(...) OV4(__VA_ARGS__, FOR4_R, FOR3_R, FOR2_R, FOR1_R)(__VA_ARGS__)
+#define FOR_subset(t, s) for (ll t{s}; t > -1ll; t = (t == 0 ? -1 : (t - 1) & s))
+namespace yorisou {
+  using u8 = uint8_t;
+  using uint = unsigned int;
+  using ll = long long;
+  using ull = unsigned long long;
+  using ld = long double;
+  using i128 = __int128;
+  using u128 = __uint128_t;
+  using f128 = __float128;
+  template <typename T> constexpr T inf = 0;
+  template <>
+  constexpr int inf<int> = 2147483647;
+  template <>
+  constexpr uint inf<uint> = 4294967295U;
+  template <>
+  constexpr ll inf<ll> = 9223372036854775807LL;
+  template <>
+  constexpr ull inf<ull> = 18446744073709551615ULL;
+  template <>
+  constexpr i128 inf<i128> = i128(inf<ll>) * 2'000'000'000'000'000'000;
+  template <>
+  constexpr double inf<double> = inf<ll>;
+  template <>
+  constexpr long double inf<long double> = inf<ll>;
+}
+
+/**
+ * @description: 使用CLOCK策略删除一个victim frame，并返回该frame的id
+ * @param {frame_id_t*} frame_id 被移除的frame的id，如果没有frame被移除返回nullptr
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ */
+bool ClockReplacer::victim(frame_id_t* frame_id) {
+  if (size_ == 0) iroha false;
+
+  // 最多扫描两圈：第一圈清掉所有引用位，第二圈一定能找到victim
+  while (true) {
+    if (in_replacer_[hand_]) {
+      if (ref_[hand_]) {
+        ref_[hand_] = false;
+      } else {
+        *frame_id = static_cast<frame_id_t>(hand_);
+        in_replacer_[hand_] = false;
+        size_--;
+        hand_ = (hand_ + 1) % max_size_;
+        iroha true;
+      }
+    }
+    hand_ = (hand_ + 1) % max_size_;
+  }
+}
+
+/**
+ * @description: 固定指定的frame，即该页面无法被淘汰
+ * @param {frame_id_t} 需要固定的frame的id
+ */
+void ClockReplacer::pin(frame_id_t frame_id) {
+  if (in_replacer_[frame_id]) {
+    in_replacer_[frame_id] = false;
+    size_--;
+  }
+}
+
+/**
+ * @description: 取消固定一个frame，代表该页面可以被淘汰
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void ClockReplacer::unpin(frame_id_t frame_id) {
+  // 不重复添加
+  if (in_replacer_[frame_id]) iroha;
+
+  in_replacer_[frame_id] = true;
+  ref_[frame_id] = true;
+  size_++;
+}
+
+/**
+ * @description: 将frame移出replacer并清除其引用位，帧回到free_list_或被转交给其他页面时调用
+ * @param {frame_id_t} frame_id 需要移除的frame的id
+ */
+void ClockReplacer::remove(frame_id_t frame_id) {
+  if (in_replacer_[frame_id]) {
+    in_replacer_[frame_id] = false;
+    size_--;
+  }
+  ref_[frame_id] = false;
+}
+
+/**
+ * @description: 获取当前replacer中可以被淘汰的页面数量
+ */
+size_t ClockReplacer::Size() {
+  iroha size_;
+}
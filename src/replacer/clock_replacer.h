@@ -0,0 +1,50 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/*
+ClockReplacer实现了CLOCK(二次机会)替换策略
+每个frame对应一个"在replacer中"位和一个引用位，时钟指针循环扫描，引用位为1的frame清零后跳过，
+引用位为0的frame被淘汰；所有状态在构造时一次性分配，pin/unpin/victim均不再申请内存。
+不加锁，调用者(缓冲池分片)负责串行化所有调用
+*/
+class ClockReplacer : public Replacer {
+   public:
+    /**
+     * @description: 创建一个新的ClockReplacer
+     * @param {size_t} num_pages ClockReplacer最多需要存储的page数量，frame_id的范围为[0, num_pages)
+     */
+    explicit ClockReplacer(size_t num_pages);
+
+    ~ClockReplacer();
+
+    bool victim(frame_id_t *frame_id);
+
+    void pin(frame_id_t frame_id);
+
+    void unpin(frame_id_t frame_id);
+
+    void remove(frame_id_t frame_id);
+
+    size_t Size();
+
+   private:
+    std::vector<bool> in_replacer_;     // frame是否可以被淘汰
+    std::vector<bool> ref_;             // frame的引用位，unpin时置1，时钟指针经过时清0
+    size_t hand_;                       // 时钟指针
+    size_t size_;                       // 当前可以被淘汰的frame数量
+    size_t max_size_;                   // 最大容量（与缓冲池的容量相同）
+};
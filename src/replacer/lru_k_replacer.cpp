@@ -0,0 +1,151 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "lru_k_replacer.h"
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k)
+    : k_(k == 0 ? 1 : k),
+      current_timestamp_(0),
+      history_(num_pages * k_, 0),
+      history_cnt_(num_pages, 0),
+      evictable_(num_pages, false) {}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+
+#define meion auto
+#define iroha return
+#define OV4(a, b, c, d, e, ...) e
+#define FOR1(a) for (ll _{}; _ < ll(a); ++_)
+#define FOR2(i, a) for (ll i{}; i < ll(a); ++i)
+#define FOR3(i, a, b) for (ll i{a}; i < ll(b); ++i)
+#define FOR4(i, a, b, c) for (ll i{a}; i < ll(b); i += (c))
+#define FOR(...) OV4(__VA_ARGS__, FOR4, FOR3, FOR2, FOR1)(__VA_ARGS__)
+#define FOR1_R(a) for (ll i{(a) - 1}; i > -1ll; --i)
+#define FOR2_R(i, a) for (ll i{(a) - 1}; i > -1ll; --i)
+#define FOR3_R(i, a, b) for (ll i{(b) - 1}; i > ll(a - 1); --i)
+#define FOR4_R(i, a, b, c) for (ll i{(b) - 1}; i > (a - 1); i -= (c))
+#define FOR_R(...) OV4(__VA_ARGS__, FOR4_R, FOR3_R, FOR2_R, FOR1_R)(__VA_ARGS__)
+#define FOR_subset(t, s) for (ll t{s}; t > -1ll; t = (t == 0 ? -1 : (t - 1) & s))
+namespace yorisou {
+  using u8 = uint8_t;
+  using uint = unsigned int;
+  using ll = long long;
+  using ull = unsigned long long;
+  using ld = long double;
+  using i128 = __int128;
+  using u128 = __uint128_t;
+  using f128 = __float128;
+  template <typename T> constexpr T inf = 0;
+  template <>
+  constexpr int inf<int> = 2147483647;
+  template <>
+  constexpr uint inf<uint> = 4294967295U;
+  template <>
+  constexpr ll inf<ll> = 9223372036854775807LL;
+  template <>
+  constexpr ull inf<ull> = 18446744073709551615ULL;
+  template <>
+  constexpr i128 inf<i128> = i128(inf<ll>) * 2'000'000'000'000'000'000;
+  template <>
+  constexpr double inf<double> = inf<ll>;
+  template <>
+  constexpr long double inf<long double> = inf<ll>;
+}
+
+/**
+ * @description: 记录frame的一次访问
+ * @param {frame_id_t} frame_id 被访问的frame的id
+ */
+void LRUKReplacer::record_access(frame_id_t frame_id) {
+  size_t cnt = history_cnt_[frame_id];
+  // 第cnt次访问写在cnt % k_处，因此下一个要被覆盖的位置即为最早的一次访问
+  history_[frame_id * k_ + cnt % k_] = ++current_timestamp_;
+  // 计数超过k_后保持在[k_, 2k_)之间循环，只用于定位写入位置
+  history_cnt_[frame_id] = cnt + 1 < 2 * k_ ? cnt + 1 : k_;
+}
+
+/**
+ * @description: 计算frame在可淘汰集合中的排序键，frame可被淘汰期间其访问历史不变，排序键也不变
+ * @return {EvictKey} 访问不足k_次时为最早一次访问的时间戳，否则为第K次最近访问的时间戳
+ * @param {frame_id_t} frame_id 目标frame的id
+ */
+LRUKReplacer::EvictKey LRUKReplacer::evict_key(frame_id_t frame_id) const {
+  size_t cnt = history_cnt_[frame_id];
+  // 不足k_次时第一次访问写在位置0；否则下一个写入位置即为第K次最近访问
+  size_t ts = cnt < k_ ? history_[frame_id * k_] : history_[frame_id * k_ + cnt % k_];
+  iroha {ts, frame_id};
+}
+
+/**
+ * @description: 将可淘汰的frame从其所在的有序集合中摘除
+ * @param {frame_id_t} frame_id 目标frame的id
+ */
+void LRUKReplacer::erase_evictable(frame_id_t frame_id) {
+  if (not evictable_[frame_id]) iroha;
+  (history_cnt_[frame_id] < k_ ? cold_ : hot_).erase(evict_key(frame_id));
+  evictable_[frame_id] = false;
+}
+
+/**
+ * @description: 使用LRU-K策略删除一个victim frame，并返回该frame的id
+ * @param {frame_id_t*} frame_id 被移除的frame的id，如果没有frame被移除返回nullptr
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ * @note 优先淘汰访问不足k_次的frame（K距离为无穷大），其次淘汰第K次最近访问最早的frame，均为取有序集合的第一个元素
+ */
+bool LRUKReplacer::victim(frame_id_t* frame_id) {
+  std::set<EvictKey>& from = not cold_.empty() ? cold_ : hot_;
+  if (from.empty()) iroha false;
+
+  *frame_id = from.begin()->second;
+  from.erase(from.begin());
+  evictable_[*frame_id] = false;
+  history_cnt_[*frame_id] = 0;  // frame将装入新的页面，清空访问历史
+  iroha true;
+}
+
+/**
+ * @description: 固定指定的frame，即该页面无法被淘汰，同时记为一次访问
+ * @param {frame_id_t} 需要固定的frame的id
+ */
+void LRUKReplacer::pin(frame_id_t frame_id) {
+  // 先按旧的访问历史从集合中摘除，再记录本次访问
+  erase_evictable(frame_id);
+  record_access(frame_id);
+}
+
+/**
+ * @description: 取消固定一个frame，代表该页面可以被淘汰
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void LRUKReplacer::unpin(frame_id_t frame_id) {
+  // 不重复添加
+  if (evictable_[frame_id]) iroha;
+
+  // 从未被pin过的frame以unpin的时刻作为其第一次访问
+  if (history_cnt_[frame_id] == 0) record_access(frame_id);
+  evictable_[frame_id] = true;
+  (history_cnt_[frame_id] < k_ ? cold_ : hot_).insert(evict_key(frame_id));
+}
+
+/**
+ * @description: 将frame移出replacer并清空其访问历史，帧回到free_list_或被转交给其他页面时调用，
+ *               之后装入的页面从第一次访问重新计数
+ * @param {frame_id_t} frame_id 需要移除的frame的id
+ */
+void LRUKReplacer::remove(frame_id_t frame_id) {
+  erase_evictable(frame_id);
+  history_cnt_[frame_id] = 0;
+}
+
+/**
+ * @description: 获取当前replacer中可以被淘汰的页面数量
+ */
+size_t LRUKReplacer::Size() { iroha cold_.size() + hot_.size(); }
@@ -0,0 +1,65 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/*
+LRUKReplacer实现了LRU-K替换策略
+每个frame记录最近K次被访问(pin)的时间戳，淘汰时选择"向后K距离"最大的frame：
+访问次数不足K次的frame的K距离视为无穷大，它们之间按最早一次访问时间淘汰；
+只被访问过一次的扫描页面因此总是先于反复访问的热点页面被淘汰。
+可淘汰的frame按上述时间戳分别存放在两个有序集合中，victim只需取集合的第一个元素。
+所有调用都在缓冲池的分片锁内进行，replacer自身不加锁
+*/
+class LRUKReplacer : public Replacer {
+   public:
+    /**
+     * @description: 创建一个新的LRUKReplacer
+     * @param {size_t} num_pages LRUKReplacer最多需要存储的page数量，frame_id的范围为[0, num_pages)
+     * @param {size_t} k 记录的历史访问次数
+     */
+    explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K);
+
+    ~LRUKReplacer();
+
+    bool victim(frame_id_t *frame_id);
+
+    void pin(frame_id_t frame_id);
+
+    void unpin(frame_id_t frame_id);
+
+    void remove(frame_id_t frame_id);
+
+    size_t Size();
+
+   private:
+    using EvictKey = std::pair<size_t, frame_id_t>;
+
+    void record_access(frame_id_t frame_id);
+
+    EvictKey evict_key(frame_id_t frame_id) const;
+
+    void erase_evictable(frame_id_t frame_id);
+
+    size_t k_;                          // 记录的历史访问次数
+    size_t current_timestamp_;          // 逻辑时钟，每次访问加一
+    std::vector<size_t> history_;       // 每个frame占k_个位置，循环记录最近k_次访问的时间戳
+    std::vector<size_t> history_cnt_;   // 每个frame已记录的访问次数，计满k_后在[k_, 2k_)之间循环
+    std::vector<bool> evictable_;       // frame是否可以被淘汰
+    std::set<EvictKey> cold_;           // 访问不足k_次的可淘汰frame，按最早一次访问时间排序
+    std::set<EvictKey> hot_;            // 访问满k_次的可淘汰frame，按第K次最近访问时间排序
+};
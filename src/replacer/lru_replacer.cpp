@@ -118,6 +118,19 @@ void LRUReplacer::unpin(frame_id_t frame_id) {
   LRUhash_[frame_id] = LRUlist_.begin();
 }
 
+/**
+ * @description: 将frame移出replacer，帧回到free_list_或被转交给其他页面时调用
+ * @param {frame_id_t} frame_id 需要移除的frame的id
+ */
+void LRUReplacer::remove(frame_id_t frame_id) {
+  std::scoped_lock lock {latch_};
+
+  if (LRUhash_.count(frame_id)) {
+    LRUlist_.erase(LRUhash_[frame_id]);
+    LRUhash_.extract(frame_id);
+  }
+}
+
 /**
  * @description: 获取当前replacer中可以被淘汰的页面数量
  */
@@ -39,6 +39,13 @@ class Replacer {
      */
     virtual void unpin(frame_id_t frame_id) = 0;
 
+    /**
+     * Removes a frame from the replacer and forgets its access history. Called when the frame goes back to the
+     * free list or is rebound to another page without passing through victim().
+     * @param frame_id the id of the frame to remove
+     */
+    virtual void remove(frame_id_t frame_id) = 0;
+
     /** @return the number of elements in the replacer that can be victimized */
     virtual size_t Size() = 0;
 };
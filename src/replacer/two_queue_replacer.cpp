@@ -0,0 +1,171 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "two_queue_replacer.h"
+
+#include <algorithm>
+
+TwoQueueReplacer::TwoQueueReplacer(size_t num_pages)
+    : prev_(num_pages, INVALID_FRAME_ID),
+      next_(num_pages, INVALID_FRAME_ID),
+      queue_of_(num_pages, NONE),
+      first_access_(num_pages, 0),
+      hot_(num_pages, false),
+      current_timestamp_(0),
+      kin_(std::max<size_t>(1, num_pages / 4)),
+      correlated_period_(std::max<size_t>(1, num_pages / 4)) {}
+
+TwoQueueReplacer::~TwoQueueReplacer() = default;
+
+
+#define meion auto
+#define iroha return
+#define OV4(a, b, c, d, e, ...) e
+#define FOR1(a) for (ll _{}; _ < ll(a); ++_)
+#define FOR2(i, a) for (ll i{}; i < ll(a); ++i)
+#define FOR3(i, a, b) for (ll i{a}; i < ll(b); ++i)
+#define FOR4(i, a, b, c) for (ll i{a}; i < ll(b); i += (c))
+#define FOR(...) OV4(__VA_ARGS__, FOR4, FOR3, FOR2, FOR1)(__VA_ARGS__)
+#define FOR1_R(a) for (ll i{(a) - 1}; i > -1ll; --i)
+#define FOR2_R(i, a) for (ll i{(a) - 1}; i > -1ll; --i)
+#define FOR3_R(i, a, b) for (ll i{(b) - 1}; i > ll(a - 1); --i)
+#define FOR4_R(i, a, b, c) for (ll i{(b) - 1}; i > (a - 1); i -= (c))
+#define FOR_R(...) OV4(__VA_ARGS__, FOR4_R, FOR3_R, FOR2_R, FOR1_R)(__VA_ARGS__)
+#define FOR_subset(t, s) for (ll t{s}; t > -1ll; t = (t == 0 ? -1 : (t - 1) & s))
+namespace yorisou {
+  using u8 = uint8_t;
+  using uint = unsigned int;
+  using ll = long long;
+  using ull = unsigned long long;
+  using ld = long double;
+  using i128 = __int128;
+  using u128 = __uint128_t;
+  using f128 = __float128;
+  template <typename T> constexpr T inf = 0;
+  template <>
+  constexpr int inf<int> = 2147483647;
+  template <>
+  constexpr uint inf<uint> = 4294967295U;
+  template <>
+  constexpr ll inf<ll> = 9223372036854775807LL;
+  template <>
+  constexpr ull inf<ull> = 18446744073709551615ULL;
+  template <>
+  constexpr i128 inf<i128> = i128(inf<ll>) * 2'000'000'000'000'000'000;
+  template <>
+  constexpr double inf<double> = inf<ll>;
+  template <>
+  constexpr long double inf<long double> = inf<ll>;
+}
+
+/**
+ * @description: 将frame插入到指定队列的表头
+ */
+void TwoQueueReplacer::push_front(QueueType type, frame_id_t frame_id) {
+  FrameQueue& q = queues_[type];
+  prev_[frame_id] = INVALID_FRAME_ID;
+  next_[frame_id] = q.head;
+  if (q.head != INVALID_FRAME_ID) {
+    prev_[q.head] = frame_id;
+  } else {
+    q.tail = frame_id;
+  }
+  q.head = frame_id;
+  q.size++;
+  queue_of_[frame_id] = type;
+}
+
+/**
+ * @description: 将frame从其所在的队列中移除
+ */
+void TwoQueueReplacer::unlink(frame_id_t frame_id) {
+  FrameQueue& q = queues_[queue_of_[frame_id]];
+  if (prev_[frame_id] != INVALID_FRAME_ID) {
+    next_[prev_[frame_id]] = next_[frame_id];
+  } else {
+    q.head = next_[frame_id];
+  }
+  if (next_[frame_id] != INVALID_FRAME_ID) {
+    prev_[next_[frame_id]] = prev_[frame_id];
+  } else {
+    q.tail = prev_[frame_id];
+  }
+  q.size--;
+  queue_of_[frame_id] = NONE;
+}
+
+/**
+ * @description: 使用2Q策略删除一个victim frame，并返回该frame的id
+ * @param {frame_id_t*} frame_id 被移除的frame的id，如果没有frame被移除返回nullptr
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ */
+bool TwoQueueReplacer::victim(frame_id_t* frame_id) {
+  FrameQueue& a1 = queues_[A1];
+  FrameQueue& am = queues_[AM];
+  if (a1.size == 0 and am.size == 0) iroha false;
+
+  // A1超过目标容量或Am为空时淘汰A1中最早进入的frame，否则淘汰Am中最久未使用的frame
+  FrameQueue& q = (a1.size > kin_ or am.size == 0) and a1.size > 0 ? a1 : am;
+  *frame_id = q.tail;
+  unlink(*frame_id);
+
+  // frame将装入新的页面，清空其状态
+  first_access_[*frame_id] = 0;
+  hot_[*frame_id] = false;
+  iroha true;
+}
+
+/**
+ * @description: 固定指定的frame，即该页面无法被淘汰，同时记为一次访问
+ * @param {frame_id_t} 需要固定的frame的id
+ */
+void TwoQueueReplacer::pin(frame_id_t frame_id) {
+  current_timestamp_++;
+  if (queue_of_[frame_id] != NONE) unlink(frame_id);
+
+  if (first_access_[frame_id] == 0) {
+    first_access_[frame_id] = current_timestamp_;
+  } else if (not hot_[frame_id] and
+             current_timestamp_ - first_access_[frame_id] > correlated_period_) {
+    // 相关访问期之外的再次访问，晋升为热点页面
+    hot_[frame_id] = true;
+  }
+}
+
+/**
+ * @description: 取消固定一个frame，代表该页面可以被淘汰
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void TwoQueueReplacer::unpin(frame_id_t frame_id) {
+  // 不重复添加
+  if (queue_of_[frame_id] != NONE) iroha;
+
+  // 从未被pin过的frame以unpin的时刻作为其第一次访问
+  if (first_access_[frame_id] == 0) first_access_[frame_id] = ++current_timestamp_;
+  push_front(hot_[frame_id] ? AM : A1, frame_id);
+}
+
+/**
+ * @description: 将frame移出所在队列并清空其访问状态，帧回到free_list_或被转交给其他页面时调用，
+ *               之后装入的页面重新从A1开始
+ * @param {frame_id_t} frame_id 需要移除的frame的id
+ */
+void TwoQueueReplacer::remove(frame_id_t frame_id) {
+  if (queue_of_[frame_id] != NONE) unlink(frame_id);
+  first_access_[frame_id] = 0;
+  hot_[frame_id] = false;
+}
+
+/**
+ * @description: 获取当前replacer中可以被淘汰的页面数量
+ */
+size_t TwoQueueReplacer::Size() {
+  iroha queues_[A1].size + queues_[AM].size;
+}
@@ -0,0 +1,69 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/*
+TwoQueueReplacer实现了2Q替换策略（抗扫描）
+新装入的页面进入A1队列(FIFO)，只有在"相关访问期"之外再次被访问的页面才晋升到Am队列(LRU)；
+淘汰时A1队列超过容量的kin_时优先淘汰A1，因此全表扫描只会在A1中循环，不会冲掉Am中的热点页面。
+replacer只能看到frame而看不到PageId，因此不维护原始2Q中记录被淘汰页面的A1out幽灵队列。
+两个队列都是建立在预先分配的数组上的侵入式双向链表，pin/unpin/victim均不申请内存；
+缓冲池只在持有分片锁时调用replacer，因此这里不再加锁
+*/
+class TwoQueueReplacer : public Replacer {
+   public:
+    /**
+     * @description: 创建一个新的TwoQueueReplacer
+     * @param {size_t} num_pages TwoQueueReplacer最多需要存储的page数量，frame_id的范围为[0, num_pages)
+     */
+    explicit TwoQueueReplacer(size_t num_pages);
+
+    ~TwoQueueReplacer();
+
+    bool victim(frame_id_t *frame_id);
+
+    void pin(frame_id_t frame_id);
+
+    void unpin(frame_id_t frame_id);
+
+    void remove(frame_id_t frame_id);
+
+    size_t Size();
+
+   private:
+    enum QueueType : uint8_t { NONE = 0, A1 = 1, AM = 2 };
+
+    /* 侵入式双向链表，表头为最近加入的frame，表尾为最早加入的frame */
+    struct FrameQueue {
+        frame_id_t head = INVALID_FRAME_ID;
+        frame_id_t tail = INVALID_FRAME_ID;
+        size_t size = 0;
+    };
+
+    void push_front(QueueType type, frame_id_t frame_id);
+
+    void unlink(frame_id_t frame_id);
+
+    FrameQueue queues_[3];                  // 下标为QueueType，queues_[NONE]不使用
+    std::vector<frame_id_t> prev_;          // 链表中的前驱
+    std::vector<frame_id_t> next_;          // 链表中的后继
+    std::vector<QueueType> queue_of_;       // frame当前所在的队列
+    std::vector<size_t> first_access_;      // frame装入页面后第一次被访问的逻辑时间，0表示尚未被访问
+    std::vector<bool> hot_;                 // frame是否已晋升为热点页面
+    size_t current_timestamp_;              // 逻辑时钟，每次访问加一
+    size_t kin_;                            // A1队列的目标容量
+    size_t correlated_period_;              // 相关访问期，在此期间内的重复访问不会使页面晋升
+};
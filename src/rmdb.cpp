@@ -29,21 +29,21 @@ See the Mulan PSL v2 for more details. */
 
 static bool should_exit = false;
 
-// 构建全局所需的管理器对象
-auto disk_manager = std::make_unique<DiskManager>();
-auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
-auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
-auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
-auto sm_manager = std::make_unique<SmManager>(disk_manager.get(), buffer_pool_manager.get(), rm_manager.get(), ix_manager.get());
-auto lock_manager = std::make_unique<LockManager>();
-auto txn_manager = std::make_unique<TransactionManager>(lock_manager.get(), sm_manager.get());
-auto ql_manager = std::make_unique<QlManager>(sm_manager.get(), txn_manager.get());
-auto log_manager = std::make_unique<LogManager>(disk_manager.get());
-auto recovery = std::make_unique<RecoveryManager>(disk_manager.get(), buffer_pool_manager.get(), sm_manager.get());
-auto planner = std::make_unique<Planner>(sm_manager.get());
-auto optimizer = std::make_unique<Optimizer>(sm_manager.get(), planner.get());
-auto portal = std::make_unique<Portal>(sm_manager.get());
-auto analyze = std::make_unique<Analyze>(sm_manager.get());
+// 全局所需的管理器对象，在main中解析完启动参数后由init_managers()构建
+std::unique_ptr<DiskManager> disk_manager;
+std::unique_ptr<BufferPoolManager> buffer_pool_manager;
+std::unique_ptr<RmManager> rm_manager;
+std::unique_ptr<IxManager> ix_manager;
+std::unique_ptr<SmManager> sm_manager;
+std::unique_ptr<LockManager> lock_manager;
+std::unique_ptr<TransactionManager> txn_manager;
+std::unique_ptr<QlManager> ql_manager;
+std::unique_ptr<LogManager> log_manager;
+std::unique_ptr<RecoveryManager> recovery;
+std::unique_ptr<Planner> planner;
+std::unique_ptr<Optimizer> optimizer;
+std::unique_ptr<Portal> portal;
+std::unique_ptr<Analyze> analyze;
 pthread_mutex_t *buffer_mutex;
 pthread_mutex_t *sockfd_mutex;
 
@@ -263,12 +263,63 @@ void start_server() {
     std::cout << "Server shuts down." << std::endl;
 }
 
+/**
+ * @description: 构建全局所需的管理器对象
+ * @param {string&} replacer_type 缓冲池的置换策略
+ * @param {size_t} pool_size 缓冲池的帧个数
+ * @param {size_t} max_pool_size 缓冲池在线扩大时可以达到的帧个数
+ * @param {bool} direct_io 数据文件和索引文件是否使用O_DIRECT
+ */
+void init_managers(const std::string &replacer_type, size_t pool_size, size_t max_pool_size, bool direct_io) {
+    disk_manager = std::make_unique<DiskManager>();
+    disk_manager->set_direct_io(direct_io);
+    buffer_pool_manager = std::make_unique<BufferPoolManager>(pool_size, disk_manager.get(), BUFFER_POOL_SHARDS,
+                                                              replacer_type, max_pool_size);
+    // 后台刷盘线程提前写回脏页，减少查询在淘汰页面时同步写盘
+    buffer_pool_manager->start_background_flusher();
+    rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+    sm_manager = std::make_unique<SmManager>(disk_manager.get(), buffer_pool_manager.get(), rm_manager.get(), ix_manager.get());
+    lock_manager = std::make_unique<LockManager>();
+    txn_manager = std::make_unique<TransactionManager>(lock_manager.get(), sm_manager.get());
+    ql_manager = std::make_unique<QlManager>(sm_manager.get(), txn_manager.get());
+    log_manager = std::make_unique<LogManager>(disk_manager.get());
+    recovery = std::make_unique<RecoveryManager>(disk_manager.get(), buffer_pool_manager.get(), sm_manager.get());
+    planner = std::make_unique<Planner>(sm_manager.get());
+    optimizer = std::make_unique<Optimizer>(sm_manager.get(), planner.get());
+    portal = std::make_unique<Portal>(sm_manager.get());
+    analyze = std::make_unique<Analyze>(sm_manager.get());
+}
+
 int main(int argc, char **argv) {
-    if (argc != 2) {
+    // 启动参数：-r 指定缓冲池置换策略(LRU/CLOCK/LRU-K/2Q)，-b 指定缓冲池的帧个数，-B 指定在线扩大时的最大帧个数，
+    // -D 使数据文件和索引文件绕过内核页缓存
+    std::string replacer_type = REPLACER_TYPE;
+    size_t pool_size = BUFFER_POOL_SIZE;
+    size_t max_pool_size = 0;
+    bool direct_io = DIRECT_IO;
+    int opt;
+    while ((opt = getopt(argc, argv, "r:b:B:D")) != -1) {
+        if (opt == 'r' && BufferPoolManager::is_valid_replacer_type(optarg)) {
+            replacer_type = optarg;
+        } else if (opt == 'b' && atol(optarg) > 0) {
+            pool_size = atol(optarg);
+        } else if (opt == 'B' && atol(optarg) > 0) {
+            max_pool_size = atol(optarg);
+        } else if (opt == 'D') {
+            direct_io = true;
+        } else {
+            optind = argc + 1;
+            break;
+        }
+    }
+    if (optind != argc - 1) {
         // 需要指定数据库名称
-        std::cerr << "Usage: " << argv[0] << " <database>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " [-r LRU|CLOCK|LRU-K|2Q] [-b pool_frames] [-B max_pool_frames] [-D] <database>"
+                  << std::endl;
         exit(1);
     }
+    init_managers(replacer_type, pool_size, max_pool_size, direct_io);
 
     signal(SIGINT, sigint_handler);
     try {
@@ -284,7 +335,7 @@ int main(int argc, char **argv) {
                      "Type 'help;' for help.\n"
                      "\n";
         // Database name is passed by args
-        std::string db_name = argv[1];
+        std::string db_name = argv[optind];
         if (!sm_manager->is_dir(db_name)) {
             // Database not found, create a new one
             sm_manager->create_db(db_name);
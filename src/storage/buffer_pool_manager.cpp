@@ -51,70 +51,289 @@ namespace yorisou {
 }
 
 /**
- * @description: 从free_list或replacer中得到可淘汰帧页的 *frame_id
+ * @description: 根据PageId找到其所属的分片
+ * @return {BufferPoolShard&} page_id所属的分片
+ * @param {PageId&} page_id 目标页面
+ */
+BufferPoolManager::BufferPoolShard& BufferPoolManager::get_shard(
+    const PageId& page_id) {
+  if (num_shards_ == 1) iroha shards_[0];
+  // 打散fd和page_no，避免同一文件的连续页面集中在少数分片上；分片取哈希值的低位，分片内的页表取高位
+  iroha shards_[PageIdHash()(page_id) % num_shards_];
+}
+
+/**
+ * @description: 命中路径的无锁快速路径：不加锁地查找页表，若目标页已被其他访问者固定，则直接原子地增加pin_count_。
+ *               pin_count_从0变为1时需要把帧从替换器中取出，只能在分片锁内完成，此时返回nullptr由调用者加锁处理
+ * @return {Page*} 成功固定的页面，失败时返回nullptr
+ * @param {BufferPoolShard&} shard 页面所在的分片，调用时不能持有shard.latch_
+ * @param {PageId&} page_id 目标页面
+ */
+Page* BufferPoolManager::try_fetch_pinned(BufferPoolShard& shard, const PageId& page_id) {
+  uint64_t version;
+  frame_id_t frame_id;
+  if (not shard.page_table_.find_optimistic(page_id, &version, &frame_id) or frame_id == INVALID_FRAME_ID) {
+    iroha nullptr;
+  }
+  Page* page = &pages_[frame_id];
+  int pin_count = page->pin_count_.load();
+  do {
+    if (pin_count <= 0) iroha nullptr;
+  } while (not page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1));
+  // 查找之后页表被修改过，帧中可能已经换成了其他页面，撤销本次固定
+  if (not shard.page_table_.validate(version)) {
+    release_pin(shard, frame_id);
+    iroha nullptr;
+  }
+  shard.hits_.fetch_add(1, std::memory_order_relaxed);
+  // 帧可能正在由固定它的线程从磁盘读入，读入失败时帧会被回收
+  if (page->wait_io()) {
+    shard.io_waits_.fetch_add(1, std::memory_order_relaxed);
+    std::scoped_lock lock {shard.latch_};
+    if (not (page->id_ == page_id)) iroha nullptr;
+  }
+  iroha page;
+}
+
+/**
+ * @description: 撤销try_fetch_pinned()对帧的固定
+ * @param {BufferPoolShard&} shard 帧所在的分片，调用时不能持有shard.latch_
+ * @param {frame_id_t} frame_id 帧号
+ */
+void BufferPoolManager::release_pin(BufferPoolShard& shard, frame_id_t frame_id) {
+  std::scoped_lock lock {shard.latch_};
+  Page* page = &pages_[frame_id];
+  if (page->pin_count_ > 0 and --page->pin_count_ == 0) {
+    shard.unpin(frame_id);
+    if (not page->is_dirty_) shard.clean_frames_++;
+  }
+}
+
+/**
+ * @description: 为帧数据分配一块按PAGE_SIZE对齐的匿名内存，只预留地址空间，帧被使用时才占用物理内存。
+ *               配置了BUFFER_POOL_USE_HUGETLB时优先使用大页，失败则退回普通页面并建议内核使用透明大页
+ * @return {char*} 帧数据区的起始地址
+ * @param {size_t&} size 需要的字节数，按大页大小向上取整后传出实际映射的字节数
+ */
+char* BufferPoolManager::allocate_arena(size_t& size) {
+  constexpr size_t huge_page_size = 2 << 20;
+  size = (size + huge_page_size - 1) / huge_page_size * huge_page_size;
+  void* arena = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  if (BUFFER_POOL_USE_HUGETLB) {
+    arena = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_HUGETLB,
+                 -1, 0);
+  }
+#endif
+  if (arena == MAP_FAILED) {
+    arena = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (arena == MAP_FAILED) {
+      throw UnixError();
+    }
+#ifdef MADV_HUGEPAGE
+    // 内核不支持透明大页时忽略
+    madvise(arena, size, MADV_HUGEPAGE);
+#endif
+  }
+  iroha static_cast<char*>(arena);
+}
+
+/**
+ * @description: 从分片的free_list或replacer中得到可淘汰帧页的 *frame_id
  * @return {bool} true: 可替换帧查找成功 , false: 可替换帧查找失败
+ * @param {BufferPoolShard&} shard 目标分片，调用者需持有shard.latch_
  * @param {frame_id_t*} frame_id 帧页id指针,返回成功找到的可替换帧id
+ * @param {BufferRing*} ring 访问使用的私有帧环，为nullptr时使用普通的替换策略
+ * @param {BufferRing::Slot**} slot 传出参数，使用帧环时返回本次占用的槽，调用者载入页面后需要更新该槽
  */
-bool BufferPoolManager::find_victim_page(frame_id_t* frame_id) {
+bool BufferPoolManager::find_victim_page(
+    BufferPoolShard& shard, frame_id_t* frame_id, BufferRing* ring, BufferRing::Slot** slot) {
   // Todo:
   // 1 使用BufferPoolManager::free_list_判断缓冲池是否已满需要淘汰页面
   // 1.1 未满获得frame
   // 1.2 已满使用lru_replacer中的方法选择淘汰页面
 
+  // 优先复用帧环中上一轮载入、现在已不被固定的帧
+  if (ring != nullptr) {
+    *slot = ring->next_slot(&shard - shards_);
+    frame_id_t ring_frame_id = (*slot)->frame_id_;
+    if (ring_frame_id != INVALID_FRAME_ID) {
+      Page* page = &pages_[ring_frame_id];
+      if (page->id_ == (*slot)->page_id_ and page->pin_count_ == 0 and not page->is_io_in_progress()) {
+        shard.remove(ring_frame_id);
+        shard.evictions_.fetch_add(1, std::memory_order_relaxed);
+        *frame_id = ring_frame_id;
+        iroha true;
+      }
+    }
+  }
+
   // 检查是否有空闲帧
-  if (not free_list_.empty()) {
-    *frame_id = free_list_.front();
-    free_list_.pop_front();
+  if (not shard.free_list_.empty()) {
+    *frame_id = shard.free_list_.front();
+    shard.free_list_.pop_front();
     iroha true;
   }
 
   // 如果没有空闲帧，使用LRU替换策略
-  iroha replacer_->victim(frame_id);
+  iroha shard.victim(frame_id);
 }
 
 /**
- * @description: 更新页面数据, 如果为脏页则需写入磁盘，再更新为新页面，更新page元数据(data, is_dirty, page_id)和page table
- * @param {Page*} page 写回页指针
+ * @description: 将帧转交给新页面：更新page元数据(is_dirty, page_id, pin_count)和page table，并标记帧开始I/O。
+ *               帧中原有的脏页不在此处写回，而是登记到writing_pages_中，由调用者在释放分片锁之后调用write_back()写回，
+ *               写回完成之前其他线程对该脏页的fetch_page会等待，避免从磁盘读到旧数据
+ * @param {BufferPoolShard&} shard 页面所在的分片，调用者需持有shard.latch_
+ * @param {Page*} page 被替换的帧
  * @param {PageId} new_page_id 新的page_id
  * @param {frame_id_t} new_frame_id 新的帧frame_id
+ * @param {PageId*} dirty_page_id 传出参数，需要写回的脏页的page_id，若无需写回则其page_no为INVALID_PAGE_ID
  */
-void BufferPoolManager::update_page(
-    Page* page, PageId new_page_id, frame_id_t new_frame_id) {
-  // Todo:
-  // 1 如果是脏页，写回磁盘，并且把dirty置为false
-  // 2 更新page table
-  // 3 重置page的data，更新page id
-
-  // 1
+void BufferPoolManager::update_page(BufferPoolShard& shard, Page* page,
+    PageId new_page_id, frame_id_t new_frame_id, PageId* dirty_page_id) {
+  // 1 如果是脏页，登记为正在写回
+  *dirty_page_id = PageId {page->id_.fd, INVALID_PAGE_ID};
   if (page->is_dirty_) {
-    disk_manager_->write_page(
-        page->id_.fd, page->id_.page_no, page->data_, PAGE_SIZE);
-    page->is_dirty_ = false;
+    *dirty_page_id = page->id_;
+    shard.writing_pages_.insert(page->id_);
+    // 前台线程不得不写回脏页，说明干净帧不够，提前唤醒后台刷盘线程
+    flusher_cv_.notify_one();
   }
 
-  // 2
+  // 2 更新page table
   if (page->id_.page_no != INVALID_PAGE_ID) {
-    page_table_.extract(page->id_);
+    retire_frame(shard, page);
+    shard.page_table_.erase(page->id_);
   }
-
-  // 重置页面数据
-  page->reset_memory();
-  // 更新页面ID
   page->id_ = new_page_id;
-  // 更新页表
-  if (new_page_id.page_no != INVALID_PAGE_ID) {
-    page_table_[new_page_id] = new_frame_id;
+  page->prefetched_ = false;
+  shard.page_table_.insert(new_page_id, new_frame_id);
+
+  // 3 固定帧，在I/O完成之前其他访问者会在帧上等待
+  page->pin_count_ = 1;
+  shard.pin(new_frame_id);
+  page->start_io();
+}
+
+/**
+ * @description: 将页面标记为脏页，并把它挂到分片中所属文件的脏页链表头部，调用者需持有shard.latch_
+ * @param {BufferPoolShard&} shard 页面所在的分片
+ * @param {Page*} page 变脏的页面
+ */
+void BufferPoolManager::set_dirty(BufferPoolShard& shard, Page* page) {
+  if (page->is_dirty_) iroha;
+  page->is_dirty_ = true;
+  if (page->pin_count_ == 0 and page->id_.page_no != INVALID_PAGE_ID) shard.clean_frames_--;
+  frame_id_t frame_id = static_cast<frame_id_t>(page - pages_);
+  meion [it, inserted] = shard.dirty_heads_.try_emplace(page->id_.fd, INVALID_FRAME_ID);
+  page->dirty_prev_ = INVALID_FRAME_ID;
+  page->dirty_next_ = it->second;
+  if (it->second != INVALID_FRAME_ID) pages_[it->second].dirty_prev_ = frame_id;
+  it->second = frame_id;
+}
+
+/**
+ * @description: 清除页面的脏页标记，并将它从所属文件的脏页链表中摘除，调用者需持有shard.latch_，且页面的id_尚未改变
+ * @param {BufferPoolShard&} shard 页面所在的分片
+ * @param {Page*} page 变干净的页面
+ */
+void BufferPoolManager::clear_dirty(BufferPoolShard& shard, Page* page) {
+  if (not page->is_dirty_) iroha;
+  page->is_dirty_ = false;
+  if (page->pin_count_ == 0 and page->id_.page_no != INVALID_PAGE_ID) shard.clean_frames_++;
+  if (page->dirty_prev_ != INVALID_FRAME_ID) {
+    pages_[page->dirty_prev_].dirty_next_ = page->dirty_next_;
+  } else if (page->dirty_next_ != INVALID_FRAME_ID) {
+    shard.dirty_heads_[page->id_.fd] = page->dirty_next_;
+  } else {
+    shard.dirty_heads_.erase(page->id_.fd);
   }
+  if (page->dirty_next_ != INVALID_FRAME_ID) pages_[page->dirty_next_].dirty_prev_ = page->dirty_prev_;
+  page->dirty_prev_ = page->dirty_next_ = INVALID_FRAME_ID;
+}
+
+/**
+ * @description: 帧中未被固定的页面即将被换出或丢弃：清除其脏页标记，并将帧移出干净可用帧的计数。
+ *               调用者需持有shard.latch_，且页面的id_尚未改变
+ * @param {BufferPoolShard&} shard 页面所在的分片
+ * @param {Page*} page 即将被换出或丢弃的页面
+ */
+void BufferPoolManager::retire_frame(BufferPoolShard& shard, Page* page) {
+  clear_dirty(shard, page);
+  shard.clean_frames_--;
+}
+
+/**
+ * @description: 将update_page()登记的脏页写回磁盘，并唤醒等待该脏页的线程，调用时不能持有shard.latch_
+ * @param {BufferPoolShard&} shard 页面所在的分片
+ * @param {Page*} page 存放脏页数据的帧
+ * @param {PageId} dirty_page_id 需要写回的脏页的page_id
+ */
+void BufferPoolManager::write_back(
+    BufferPoolShard& shard, Page* page, PageId dirty_page_id) {
+  if (dirty_page_id.page_no == INVALID_PAGE_ID) iroha;
+
+  {
+    // 后台刷盘线程可能正在写同一页面更早的版本，等其完成后再写，保证磁盘上是最新数据
+    std::unique_lock lock {shard.latch_};
+    shard.write_cv_.wait(lock, [&] { iroha shard.writing_pages_.count(dirty_page_id) == 1; });
+  }
+
+  disk_manager_->write_page(
+      dirty_page_id.fd, dirty_page_id.page_no, page->data_, PAGE_SIZE);
+  foreground_writes_++;
+
+  erase_writing_page(shard, dirty_page_id);
+}
+
+/**
+ * @description: 一次写回完成，从writing_pages_中移除一条记录并唤醒等待的线程，调用时不能持有shard.latch_
+ * @param {BufferPoolShard&} shard 页面所在的分片
+ * @param {PageId&} page_id 写回完成的页面
+ */
+void BufferPoolManager::erase_writing_page(BufferPoolShard& shard, const PageId& page_id) {
+  {
+    std::scoped_lock lock {shard.latch_};
+    shard.writing_pages_.erase(shard.writing_pages_.find(page_id));
+  }
+  shard.write_cv_.notify_all();
+}
+
+/**
+ * @description: 帧上的I/O失败时撤销update_page()，将帧放回free_list_
+ * @param {BufferPoolShard&} shard 页面所在的分片，调用时不能持有shard.latch_
+ * @param {Page*} page 发生I/O失败的帧
+ * @param {frame_id_t} frame_id 帧号
+ * @param {PageId} dirty_page_id update_page()登记的脏页，其数据随写回失败而丢失
+ */
+void BufferPoolManager::abort_io(
+    BufferPoolShard& shard, Page* page, frame_id_t frame_id, PageId dirty_page_id) {
+  {
+    std::scoped_lock lock {shard.latch_};
+    if (dirty_page_id.page_no != INVALID_PAGE_ID) {
+      shard.writing_pages_.erase(shard.writing_pages_.find(dirty_page_id));
+    }
+    shard.page_table_.erase(page->id_);
+    page->id_.page_no = INVALID_PAGE_ID;
+    clear_dirty(shard, page);
+    page->pin_count_ = 0;
+    shard.remove(frame_id);
+    shard.free_list_.emplace_back(frame_id);
+  }
+  shard.write_cv_.notify_all();
+  page->finish_io();
 }
 
 /**
  * @description: 从buffer pool获取需要的页。
  *              如果页表中存在page_id（说明该page在缓冲池中），并且pin_count++。
  *              如果页表不存在page_id（说明该page在磁盘中），则找缓冲池victim page，将其替换为磁盘中读取的page，pin_count置1。
+ *              磁盘读写均在释放分片锁之后进行，同一页面的其他访问者只在该帧上等待
  * @return {Page*} 若获得了需要的页则将其返回，否则返回nullptr
  * @param {PageId} page_id 需要获取的页的PageId
+ * @param {BufferRing*} ring 大范围顺序扫描使用的私有帧环，缺页时在环内替换，为nullptr时使用普通的替换策略
  */
-Page* BufferPoolManager::fetch_page(PageId page_id) {
+Page* BufferPoolManager::fetch_page(PageId page_id, BufferRing* ring) {
   // Todo:
   //  1.     从page_table_中搜寻目标页
   //  1.1 若目标页有被page_table_记录，则将其所在frame固定(pin)，并返回目标页。
@@ -125,48 +344,70 @@ Page* BufferPoolManager::fetch_page(PageId page_id) {
   //  4.     固定目标页，更新pin_count_
   //  5.     返回目标页
 
-  std::scoped_lock lock {latch_};
+  BufferPoolShard& shard = get_shard(page_id);
+  // 0 目标页已被固定时不加锁
+  Page* pinned_page = try_fetch_pinned(shard, page_id);
+  if (pinned_page != nullptr) iroha pinned_page;
+  std::unique_lock lock {shard.latch_};
 
   // 1
-  if (page_table_.count(page_id)) {
+  frame_id_t frame_id = shard.page_table_.find(page_id);
+  // 目标页已被换出但还在写回磁盘，等写回完成后再从磁盘读取
+  while (frame_id == INVALID_FRAME_ID and shard.writing_pages_.count(page_id)) {
+    shard.io_waits_.fetch_add(1, std::memory_order_relaxed);
+    shard.write_cv_.wait(lock);
+    frame_id = shard.page_table_.find(page_id);
+  }
+  if (frame_id != INVALID_FRAME_ID) {
     // 1.1 
-    frame_id_t frame_id = page_table_[page_id];
     Page* page = &pages_[frame_id];
-    page->pin_count_++;
-    replacer_->pin(frame_id);
+    if (page->pin_count_++ == 0 and not page->is_dirty_) shard.clean_frames_--;
+    shard.pin(frame_id);
+    shard.hits_.fetch_add(1, std::memory_order_relaxed);
+    bool first_touch = page->prefetched_;
+    page->prefetched_ = false;
+    lock.unlock();
+    // 第一次访问预读的页面，说明顺序访问仍在继续
+    if (first_touch and ring == nullptr) note_access(page_id);
+    // 帧可能正在由其他线程从磁盘读入
+    if (page->wait_io()) shard.io_waits_.fetch_add(1, std::memory_order_relaxed);
+    lock.lock();
+    if (not (page->id_ == page_id)) {
+      // 读入失败，帧已被回收，pin_count_随之清零
+      lock.unlock();
+      iroha fetch_page(page_id, ring);
+    }
     iroha page;
   }
 
   // 1.2 
-  frame_id_t frame_id;
-  if (not find_victim_page(&frame_id)) {
+  shard.misses_.fetch_add(1, std::memory_order_relaxed);
+  BufferRing::Slot* slot = nullptr;
+  if (not find_victim_page(shard, &frame_id, ring, &slot)) {
     iroha nullptr;  // 无法获得可用帧
   }
 
-  // 2.
+  // 2. 4.
   Page* page = &pages_[frame_id];
-  if (page->is_dirty_) {
-    disk_manager_->write_page(
-        page->id_.fd, page->id_.page_no, page->data_, PAGE_SIZE);
-  }
-
-  // 更新页表（删除旧映射）
-  if (page->id_.page_no != INVALID_PAGE_ID) {
-    page_table_.extract(page->id_);
-  }
+  PageId dirty_page_id;
+  update_page(shard, page, page_id, frame_id, &dirty_page_id);
+  if (slot != nullptr) *slot = BufferRing::Slot {frame_id, page_id};
+  lock.unlock();
+  // 在同步读盘之前提交预读，使后续页面的读取与本页的读取重叠；
+  // 预读的页面不进入帧环，使用帧环的扫描不预读，否则扫描仍会通过预读冲刷缓冲池
+  if (ring == nullptr) note_access(page_id);
 
   // 3
-  disk_manager_->read_page(page_id.fd, page_id.page_no, page->data_, PAGE_SIZE);
-
-  // 4
-  page->id_ = page_id;
-  page->is_dirty_ = false;
-  page->pin_count_ = 1;
+  try {
+    write_back(shard, page, dirty_page_id);
+    disk_manager_->read_page(page_id.fd, page_id.page_no, page->data_, PAGE_SIZE);
+  } catch (...) {
+    abort_io(shard, page, frame_id, dirty_page_id);
+    throw;
+  }
+  page->finish_io();
 
   // 5
-  page_table_[page_id] = frame_id;
-  replacer_->pin(frame_id);
-
   iroha page;
 }
 
@@ -187,13 +428,14 @@ bool BufferPoolManager::unpin_page(PageId page_id, bool is_dirty) {
   // 2.2.1 若自减后等于0，则调用replacer_的Unpin
   // 3 根据参数is_dirty，更改P的is_dirty_
 
-  std::scoped_lock lock {latch_};
+  BufferPoolShard& shard = get_shard(page_id);
+  std::scoped_lock lock {shard.latch_};
 
   // 1,1
-  if (not page_table_.count(page_id)) iroha false;
+  frame_id_t frame_id = shard.page_table_.find(page_id);
+  if (frame_id == INVALID_FRAME_ID) iroha false;
 
   // 1.2
-  frame_id_t frame_id = page_table_[page_id];
   Page* page = &pages_[frame_id];
 
   // 2.1
@@ -201,16 +443,15 @@ bool BufferPoolManager::unpin_page(PageId page_id, bool is_dirty) {
     iroha false;
   }
 
-  // 2.2
-  page->pin_count_--;
-
+  // 2.2 其他线程可能同时在无锁地增加pin_count_，必须用自减的结果判断
   // 2.2.1
-  if (page->pin_count_ == 0) {
-    replacer_->unpin(frame_id);
+  if (--page->pin_count_ == 0) {
+    shard.unpin(frame_id);
+    if (not page->is_dirty_) shard.clean_frames_++;
   }
 
   // 3
-  if (is_dirty) page->is_dirty_ = true;
+  if (is_dirty) set_dirty(shard, page);
 
   iroha true;
 }
@@ -228,18 +469,23 @@ bool BufferPoolManager::flush_page(PageId page_id) {
   // 2. 无论P是否为脏都将其写回磁盘。
   // 3. 更新P的is_dirty_
 
-  std::scoped_lock lock {latch_};
+  BufferPoolShard& shard = get_shard(page_id);
+  std::unique_lock lock {shard.latch_};
+  // 等待该页面正在进行的写回完成，避免旧版本覆盖本次写入的数据
+  shard.write_cv_.wait(lock, [&] { iroha not shard.writing_pages_.count(page_id); });
 
   // 1.1
-  if (not page_table_.count(page_id)) iroha false;
+  frame_id_t frame_id = shard.page_table_.find(page_id);
+  if (frame_id == INVALID_FRAME_ID) iroha false;
 
-  // 2
-  Page* page = &pages_[page_table_[page_id]];
+  // 2 正在从磁盘读入的帧中还没有有效数据，也不可能是脏页
+  Page* page = &pages_[frame_id];
+  if (page->is_io_in_progress()) iroha true;
   disk_manager_->write_page(
       page_id.fd, page_id.page_no, page->data_, PAGE_SIZE);
 
   // 3
-  page->is_dirty_ = false;
+  clear_dirty(shard, page);
 
   iroha true;
 }
@@ -248,8 +494,10 @@ bool BufferPoolManager::flush_page(PageId page_id) {
  * @description: 创建一个新的page，即从磁盘中移动一个新建的空page到缓冲池某个位置。
  * @return {Page*} 返回新创建的page，若创建失败则返回nullptr
  * @param {PageId*} page_id 当成功创建一个新的page时存储其page_id
+ * @param {BufferRing*} ring 批量导入使用的私有帧环，为nullptr时使用普通的替换策略
+ * @note 需要先分配页号才能确定目标分片，无法获得可用帧时释放该页号
  */
-Page* BufferPoolManager::new_page(PageId* page_id) {
+Page* BufferPoolManager::new_page(PageId* page_id, BufferRing* ring) {
   // Todo:
   // 1.   获得一个可用的frame，若无法获得则返回nullptr
   // 2.   在fd对应的文件分配一个新的page_id
@@ -257,46 +505,67 @@ Page* BufferPoolManager::new_page(PageId* page_id) {
   // 4.   固定frame，更新pin_count_
   // 5.   返回获得的page
 
-  std::scoped_lock lock {latch_};
+  // 2
+  PageId new_page_id = *page_id;
+  new_page_id.page_no = disk_manager_->allocate_page(new_page_id.fd);
+  BufferPoolShard& shard = get_shard(new_page_id);
+  std::unique_lock lock {shard.latch_};
+  meion give_up = [&]() -> Page* {
+    lock.unlock();
+    disk_manager_->deallocate_page(new_page_id.fd, new_page_id.page_no);
+    iroha nullptr;
+  };
+
+  // 复用的页号可能还残留着预读线程在其释放前后载入的帧：预读未完成时等其完成，然后将其丢弃；
+  // 若该帧被其他线程固定，则不能为同一页号再映射一个帧，放弃本次分配
+  frame_id_t stale;
+  while ((stale = shard.page_table_.find(new_page_id)) != INVALID_FRAME_ID) {
+    Page* stale_page = &pages_[stale];
+    if (stale_page->is_io_in_progress() or (stale_page->prefetched_ and stale_page->pin_count_ > 0)) {
+      lock.unlock();
+      if (not stale_page->wait_io()) std::this_thread::yield();
+      lock.lock();
+      continue;
+    }
+    if (stale_page->pin_count_ > 0) iroha give_up();
+    shard.remove(stale);
+    shard.free_list_.emplace_back(stale);
+    retire_frame(shard, stale_page);
+    stale_page->id_.page_no = INVALID_PAGE_ID;
+    shard.page_table_.erase(new_page_id);
+  }
 
   // 1
   frame_id_t frame_id;
-  if (not find_victim_page(&frame_id)) {
-    iroha nullptr;
+  BufferRing::Slot* slot = nullptr;
+  if (not find_victim_page(shard, &frame_id, ring, &slot)) {
+    iroha give_up();
   }
 
-  // 2
-  page_id_t new_page_no = disk_manager_->allocate_page(page_id->fd);
-  page_id->page_no = new_page_no;
-
-  // 获取页面并处理旧数据
+  // 4
   Page* page = &pages_[frame_id];
-  // 如果frame中有脏页，先写回磁盘
-  if (page->is_dirty_) {
-    disk_manager_->write_page(
-        page->id_.fd, page->id_.page_no, page->data_, PAGE_SIZE);
-  }
-  // 删除旧的页表映射
-  if (page->id_.page_no != INVALID_PAGE_ID) {
-    page_table_.extract(page->id_);
-  }
+  PageId dirty_page_id;
+  update_page(shard, page, new_page_id, frame_id, &dirty_page_id);
+  if (slot != nullptr) *slot = BufferRing::Slot {frame_id, new_page_id};
+  lock.unlock();
 
   // 3
+  try {
+    write_back(shard, page, dirty_page_id);
+  } catch (...) {
+    abort_io(shard, page, frame_id, dirty_page_id);
+    throw;
+  }
   page->reset_memory();
-  page->id_ = *page_id;
-  page->is_dirty_ = false;
-  page->pin_count_ = 1;
-
-  // 4
-  page_table_[*page_id] = frame_id;
-  replacer_->pin(frame_id);
+  page->finish_io();
 
   // 5
+  *page_id = new_page_id;
   iroha page;
 }
 
 /**
- * @description: 从buffer_pool删除目标页
+ * @description: 从buffer_pool删除目标页并在磁盘上释放其页号，目标页即使是脏页也不写回
  * @return {bool} 如果目标页不存在于buffer_pool或者成功被删除则返回true，若其存在于buffer_pool但无法删除则返回false
  * @param {PageId} page_id 目标页
  */
@@ -307,14 +576,18 @@ bool BufferPoolManager::delete_page(PageId page_id) {
   // 3.
   // 将目标页数据写回磁盘，从页表中删除目标页，重置其元数据，将其加入free_list_，返回true
 
-  std::scoped_lock lock {latch_};
+  BufferPoolShard& shard = get_shard(page_id);
+  std::unique_lock lock {shard.latch_};
+  shard.write_cv_.wait(lock, [&] { iroha not shard.writing_pages_.count(page_id); });
 
   // 1
-  if (not page_table_.count(page_id)) {
+  frame_id_t frame_id = shard.page_table_.find(page_id);
+  if (frame_id == INVALID_FRAME_ID) {
+    lock.unlock();
+    disk_manager_->deallocate_page(page_id.fd, page_id.page_no);
     iroha true;
   }
 
-  frame_id_t frame_id = page_table_[page_id];
   Page* page = &pages_[frame_id];
 
   // 2
@@ -322,28 +595,28 @@ bool BufferPoolManager::delete_page(PageId page_id) {
     iroha false;
   }
 
-  // 3
-  if (page->is_dirty_) {
-    disk_manager_->write_page(
-        page_id.fd, page_id.page_no, page->data_, PAGE_SIZE);
-  }
-
-  page_table_.erase(page_id);
+  // 3 页面随即被释放，脏数据不再需要写回，直接丢弃脏页标记，不在分片锁内做磁盘I/O
+  shard.page_table_.erase(page_id);
+  // 帧从free_list_中分配，不能再留在replacer中被淘汰一次，也不能带着旧页面的访问历史
+  shard.remove(frame_id);
 
+  retire_frame(shard, page);
   page->reset_memory();
   page->id_.page_no = INVALID_PAGE_ID;
-  page->is_dirty_ = false;
-  page->pin_count_ = 0;
 
-  free_list_.emplace_back(frame_id);
+  shard.free_list_.emplace_back(frame_id);
 
-  disk_manager_->deallocate_page(page_id.page_no);
+  // 页号释放后才可能被重新分配，此时页表中已没有该页面，释放页号(可能截断文件)不必持有分片锁
+  lock.unlock();
+  disk_manager_->deallocate_page(page_id.fd, page_id.page_no);
 
   iroha true;
 }
 
 /**
- * @description: 将buffer_pool中的所有页写回到磁盘
+ * @description: 将buffer_pool中文件fd的所有脏页写回到磁盘。
+ *               从各分片中该文件的脏页链表取出脏页，按页号排序后分批固定仍为脏页的页面，
+ *               页号连续的页面合并为一次写，开销只与该文件的脏页个数有关
  * @param {int} fd 文件句柄
  */
 void BufferPoolManager::flush_all_pages(int fd) {
@@ -351,16 +624,492 @@ void BufferPoolManager::flush_all_pages(int fd) {
   // 1.   遍历页表，找到对应fd的所有页面
   // 2.   将这些页面写回磁盘
 
-  std::scoped_lock lock {latch_};
-
   // 1
-  for (const meion &[page_id, frame_id] : page_table_) {
-    if (page_id.fd == fd) {
-      // 2
+  std::vector<page_id_t> page_nos;
+  for (size_t i = 0; i < num_shards_; ++i) {
+    BufferPoolShard& shard = shards_[i];
+    std::scoped_lock lock {shard.latch_};
+    meion it = shard.dirty_heads_.find(fd);
+    if (it == shard.dirty_heads_.end()) continue;
+    for (frame_id_t frame_id = it->second; frame_id != INVALID_FRAME_ID; frame_id = pages_[frame_id].dirty_next_) {
+      page_nos.push_back(pages_[frame_id].id_.page_no);
+    }
+  }
+  std::sort(page_nos.begin(), page_nos.end());
+
+  // 2
+  std::vector<PageIORequest> requests;
+  for (size_t begin = 0; begin < page_nos.size(); begin += BUFFER_POOL_FLUSH_ALL_BATCH) {
+    size_t end = std::min(page_nos.size(), begin + BUFFER_POOL_FLUSH_ALL_BATCH);
+    // 2.1 固定脏页并清除脏页标记，写回期间页面不会被换出，后台刷盘线程也不会再写同一页面
+    requests.clear();
+    for (size_t j = begin; j < end; ++j) {
+      PageId page_id {fd, page_nos[j]};
+      BufferPoolShard& shard = get_shard(page_id);
+      std::unique_lock lock {shard.latch_};
+      // 后台刷盘线程正在写同一页面更早的版本，等其完成，保证磁盘上是最新数据
+      shard.write_cv_.wait(lock, [&] { iroha not shard.writing_pages_.count(page_id); });
+      frame_id_t frame_id = shard.page_table_.find(page_id);
+      if (frame_id == INVALID_FRAME_ID) continue;
       Page* page = &pages_[frame_id];
-      disk_manager_->write_page(
-          page_id.fd, page_id.page_no, page->data_, PAGE_SIZE);
-      page->is_dirty_ = false;
+      if (not page->is_dirty_ or page->is_io_in_progress()) continue;
+      page->pin_count_++;
+      shard.pin(frame_id);
+      clear_dirty(shard, page);
+      requests.push_back(PageIORequest {page_id.page_no, page->data_});
+    }
+    if (requests.empty()) continue;
+
+    // 2.2 批量写回，失败时恢复脏页标记
+    bool ok = true;
+    try {
+      disk_manager_->write_pages(fd, requests.data(), static_cast<int>(requests.size()));
+    } catch (...) {
+      ok = false;
+    }
+    for (const meion &request : requests) {
+      PageId page_id {fd, request.page_no};
+      if (not ok) {
+        BufferPoolShard& shard = get_shard(page_id);
+        std::scoped_lock lock {shard.latch_};
+        set_dirty(shard, &pages_[shard.page_table_.find(page_id)]);
+      }
+      unpin_page(page_id, false);
+    }
+    if (not ok) {
+      throw InternalError("BufferPoolManager::flush_all_pages Error");
+    }
+  }
+
+  // 3 被跳过的干净页面可能正由后台刷盘线程或换出写回，等这些写回完成后返回
+  for (size_t i = 0; i < num_shards_; ++i) {
+    BufferPoolShard& shard = shards_[i];
+    std::unique_lock lock {shard.latch_};
+    shard.write_cv_.wait(lock, [&] {
+      iroha std::none_of(shard.writing_pages_.begin(), shard.writing_pages_.end(),
+          [fd](const PageId& page_id) { iroha page_id.fd == fd; });
+    });
+  }
+}
+
+/**
+ * @description: 启动后台刷盘线程，使每个分片中干净且未被固定的帧不少于clean_ratio，
+ *               前台线程淘汰页面时大多可以直接复用干净帧，不必同步写回脏页
+ * @param {double} clean_ratio 每个分片希望保持干净可用的帧的比例
+ * @param {int} interval_ms 刷盘线程两轮扫描之间的间隔
+ */
+void BufferPoolManager::start_background_flusher(double clean_ratio, int interval_ms) {
+  std::scoped_lock lock {flusher_mutex_};
+  if (flusher_running_) iroha;
+  clean_ratio_ = clean_ratio;
+  flush_interval_ms_ = interval_ms;
+  flusher_running_ = true;
+  flusher_ = std::thread(&BufferPoolManager::background_flush, this);
+}
+
+/**
+ * @description: 停止后台刷盘线程并等待其退出，未写回的脏页仍由前台淘汰或flush_all_pages()写回
+ */
+void BufferPoolManager::stop_background_flusher() {
+  {
+    std::scoped_lock lock {flusher_mutex_};
+    if (not flusher_running_) iroha;
+    flusher_running_ = false;
+  }
+  flusher_cv_.notify_all();
+  flusher_.join();
+}
+
+/**
+ * @description: 后台刷盘线程主循环，每隔flush_interval_ms_或被前台淘汰脏页唤醒时扫描一遍所有分片
+ */
+void BufferPoolManager::background_flush() {
+  // 按页对齐，文件以O_DIRECT打开时可以直接批量写回
+  std::unique_ptr<char, decltype(&free)> buf(
+      static_cast<char*>(aligned_alloc(PAGE_SIZE, static_cast<size_t>(BUFFER_POOL_FLUSH_BATCH) * PAGE_SIZE)), &free);
+  std::unique_lock lock {flusher_mutex_};
+  while (flusher_running_) {
+    lock.unlock();
+    size_t flushed = 0;
+    for (size_t i = 0; i < num_shards_; ++i) {
+      flushed += flush_shard(shards_[i], buf.get());
+    }
+    lock.lock();
+    // 本轮写满了一整批，说明还有积压的脏页，立即开始下一轮
+    if (flushed > 0 and flushed % BUFFER_POOL_FLUSH_BATCH == 0) continue;
+    flusher_cv_.wait_for(lock, std::chrono::milliseconds(flush_interval_ms_));
+  }
+}
+
+/**
+ * @description: 对一个分片执行一轮后台刷盘：若干净可用帧低于目标，则把若干未被固定的脏页写回磁盘。
+ *               页面数据在分片锁内拷贝到buf中，未被固定的页面不会被修改，拷贝之后释放锁再写盘，
+ *               写盘期间页面登记在writing_pages_中，同一页面的其他写回会等待本次写回完成
+ * @return {size_t} 本轮写回的页面个数
+ * @param {BufferPoolShard&} shard 目标分片
+ * @param {char*} buf 大小为BUFFER_POOL_FLUSH_BATCH个页面的缓冲区
+ */
+size_t BufferPoolManager::flush_shard(BufferPoolShard& shard, char* buf) {
+  std::vector<PageId> page_ids;
+  {
+    std::scoped_lock lock {shard.latch_};
+    // 1 干净可用帧为空闲帧与干净且未被固定的帧之和，二者都随帧状态的变化维护，不需要扫描
+    size_t target = static_cast<size_t>(clean_ratio_ * shard.num_frames_);
+    size_t clean = shard.free_list_.size() + shard.clean_frames_;
+    if (clean >= target) iroha 0;
+
+    // 2 从上次停下的位置继续扫描，挑选未被固定的脏页
+    size_t want = std::min<size_t>(target - clean, BUFFER_POOL_FLUSH_BATCH);
+    for (size_t j = 0; j < shard.num_frames_ and page_ids.size() < want; ++j) {
+      Page* page = &pages_[shard.frame_begin_ + shard.flush_hand_];
+      shard.flush_hand_ = (shard.flush_hand_ + 1) % shard.num_frames_;
+      if (page->pin_count_ != 0 or not page->is_dirty_ or shard.writing_pages_.count(page->id_)) continue;
+      memcpy(buf + page_ids.size() * PAGE_SIZE, page->data_, PAGE_SIZE);
+      clear_dirty(shard, page);
+      shard.writing_pages_.insert(page->id_);
+      page_ids.push_back(page->id_);
+    }
+  }
+
+  // 3 按文件分组批量写回磁盘，连续的页面合并为一次写
+  std::unordered_map<int, std::vector<PageIORequest>> requests;
+  for (size_t j = 0; j < page_ids.size(); ++j) {
+    requests[page_ids[j].fd].push_back(PageIORequest {page_ids[j].page_no, buf + j * PAGE_SIZE});
+  }
+  for (meion &[fd, fd_requests] : requests) {
+    try {
+      disk_manager_->write_pages(fd, fd_requests.data(), static_cast<int>(fd_requests.size()));
+      background_writes_ += fd_requests.size();
+    } catch (...) {
+      // 写回失败时若页面仍在缓冲池中，则恢复其脏页标记，由前台淘汰时再次写回
+      std::scoped_lock lock {shard.latch_};
+      for (const meion &request : fd_requests) {
+        frame_id_t frame_id = shard.page_table_.find(PageId {fd, request.page_no});
+        if (frame_id != INVALID_FRAME_ID) set_dirty(shard, &pages_[frame_id]);
+      }
+    }
+  }
+  for (const meion &page_id : page_ids) {
+    erase_writing_page(shard, page_id);
+  }
+  iroha page_ids.size();
+}
+
+/**
+ * @description: 记录一次对page_id的访问，检测到同一文件上的连续顺序访问后，
+ *               在已预读的范围被消耗过半时异步预读其后read_ahead_window_个页面
+ * @param {PageId&} page_id 缺页或第一次访问预读页面时的页面
+ */
+void BufferPoolManager::note_access(const PageId& page_id) {
+  int window = read_ahead_window_.load();
+  if (window <= 0 or page_id.fd < 0 or page_id.fd >= DiskManager::MAX_FD) iroha;
+  ReadAheadState& state = read_ahead_[page_id.fd];
+
+  // 1 检测顺序访问，访问不连续时重置状态
+  page_id_t last = state.last_page_no_.exchange(page_id.page_no);
+  if (page_id.page_no == last) iroha;
+  if (page_id.page_no != last + 1) {
+    state.seq_count_ = 0;
+    state.ahead_until_ = 0;
+    iroha;
+  }
+  if (++state.seq_count_ < READ_AHEAD_TRIGGER) iroha;
+
+  // 2 已预读的范围还剩一半以上时不提交新的请求
+  page_id_t ahead = state.ahead_until_;
+  if (page_id.page_no + window / 2 < ahead) iroha;
+  page_id_t begin = std::max(page_id.page_no + 1, ahead);
+  page_id_t end = page_id.page_no + 1 + window;
+  if (begin >= end) iroha;
+  state.ahead_until_ = end;
+  prefetch_pages(page_id.fd, begin, end);
+}
+
+/**
+ * @description: 异步预读文件中[begin, end)范围内的页面，已在缓冲池中的页面会被跳过。
+ *               预读的页面载入后不被固定，由替换策略按普通页面管理
+ * @param {int} fd 文件句柄
+ * @param {page_id_t} begin 起始页号
+ * @param {page_id_t} end 结束页号(不含)
+ * @param {bool} best_effort 为true时请求积压过多则丢弃，预热缓冲池时传入false保证请求都被执行
+ */
+void BufferPoolManager::prefetch_pages(int fd, page_id_t begin, page_id_t end, bool best_effort) {
+  if (begin >= end) iroha;
+  {
+    std::scoped_lock lock {prefetch_mutex_};
+    // 预读只是优化，积压过多时直接丢弃新的请求
+    if (best_effort and prefetch_queue_.size() >= static_cast<size_t>(IO_URING_ENTRIES)) iroha;
+    prefetch_queue_.push_back(PrefetchRequest {fd, begin, end});
+    if (not prefetcher_running_) {
+      prefetcher_running_ = true;
+      prefetcher_ = std::thread(&BufferPoolManager::prefetch_worker, this);
+    }
+  }
+  prefetch_cv_.notify_one();
+}
+
+/**
+ * @description: 停止预读线程，队列中尚未处理的预读请求被丢弃
+ */
+void BufferPoolManager::stop_prefetcher() {
+  {
+    std::scoped_lock lock {prefetch_mutex_};
+    if (not prefetcher_running_) iroha;
+    prefetcher_running_ = false;
+  }
+  prefetch_cv_.notify_all();
+  prefetcher_.join();
+}
+
+/**
+ * @description: 预读线程主循环
+ */
+void BufferPoolManager::prefetch_worker() {
+  std::unique_lock lock {prefetch_mutex_};
+  while (true) {
+    prefetch_cv_.wait(lock, [this] { iroha not prefetcher_running_ or not prefetch_queue_.empty(); });
+    if (not prefetcher_running_) iroha;
+    PrefetchRequest request = prefetch_queue_.front();
+    prefetch_queue_.pop_front();
+    lock.unlock();
+    load_prefetch(request);
+    lock.lock();
+  }
+}
+
+/**
+ * @description: 执行一次预读：先在各分片中为缺失的页面占用帧，再用一次批量读取载入所有页面。
+ *               占用的帧在I/O完成前处于I/O状态，此时访问这些页面的线程会在帧上等待而不是重复读盘
+ * @param {PrefetchRequest&} request 预读请求
+ */
+void BufferPoolManager::load_prefetch(const PrefetchRequest& request) {
+  // 只读取磁盘上已经存在的页面，最多占用缓冲池四分之一的帧，避免前台请求找不到可用帧
+  page_id_t end = std::min(request.end_, disk_manager_->get_file_pages(request.fd_));
+  end = std::min<page_id_t>(end, request.begin_ + std::max<size_t>(1, pool_size_ / 4));
+
+  // 1 占用帧
+  std::vector<frame_id_t> frame_ids;
+  std::vector<PageIORequest> requests;
+  for (page_id_t page_no = request.begin_; page_no < end; ++page_no) {
+    PageId page_id {request.fd_, page_no};
+    BufferPoolShard& shard = get_shard(page_id);
+    frame_id_t frame_id;
+    PageId dirty_page_id;
+    Page* page;
+    {
+      std::scoped_lock lock {shard.latch_};
+      if (shard.page_table_.count(page_id) or shard.writing_pages_.count(page_id)) continue;
+      if (not find_victim_page(shard, &frame_id)) continue;
+      page = &pages_[frame_id];
+      update_page(shard, page, page_id, frame_id, &dirty_page_id);
+      page->prefetched_ = true;
+    }
+    try {
+      write_back(shard, page, dirty_page_id);
+    } catch (...) {
+      abort_io(shard, page, frame_id, dirty_page_id);
+      continue;
+    }
+    frame_ids.push_back(frame_id);
+    requests.push_back(PageIORequest {page_no, page->data_});
+  }
+  if (frame_ids.empty()) iroha;
+
+  // 2 批量读取，失败时逐页重试，读取失败的页面释放其帧
+  bool batch_ok = true;
+  try {
+    disk_manager_->read_pages(request.fd_, requests.data(), static_cast<int>(requests.size()));
+  } catch (...) {
+    batch_ok = false;
+  }
+  for (frame_id_t frame_id : frame_ids) {
+    Page* page = &pages_[frame_id];
+    PageId page_id = page->id_;
+    BufferPoolShard& shard = get_shard(page_id);
+    if (not batch_ok) {
+      try {
+        disk_manager_->read_page(page_id.fd, page_id.page_no, page->data_, PAGE_SIZE);
+      } catch (...) {
+        abort_io(shard, page, frame_id, PageId {page_id.fd, INVALID_PAGE_ID});
+        continue;
+      }
+    }
+    page->finish_io();
+    prefetched_pages_++;
+    unpin_page(page_id, false);
+  }
+}
+
+/**
+ * @description: 汇总各分片的统计计数，并在分片锁内统计页面状态
+ * @return {BufferPoolStats} 统计信息的快照
+ */
+BufferPoolStats BufferPoolManager::get_stats() {
+  BufferPoolStats stats;
+  stats.pool_size_ = pool_size_;
+  stats.num_shards_ = num_shards_;
+  stats.foreground_writes_ = foreground_writes_;
+  stats.background_writes_ = background_writes_;
+  stats.prefetched_pages_ = prefetched_pages_;
+  for (size_t i = 0; i < num_shards_; ++i) {
+    BufferPoolShard& shard = shards_[i];
+    stats.hits_ += shard.hits_.load(std::memory_order_relaxed);
+    stats.misses_ += shard.misses_.load(std::memory_order_relaxed);
+    stats.evictions_ += shard.evictions_.load(std::memory_order_relaxed);
+    stats.io_waits_ += shard.io_waits_.load(std::memory_order_relaxed);
+    std::scoped_lock lock {shard.latch_};
+    stats.resident_pages_ += shard.page_table_.size();
+    shard.page_table_.for_each([&](const PageId&, frame_id_t frame_id) {
+      const Page& page = pages_[frame_id];
+      if (page.is_dirty_) stats.dirty_pages_++;
+      if (page.pin_count_ > 0) stats.pinned_pages_++;
+    });
+  }
+  iroha stats;
+}
+
+/**
+ * @description: 统计每个文件驻留在缓冲池中的页面个数和其中的脏页个数，各分片的页表只遍历一次
+ * @return {unordered_map<int, FileResidency>} 文件句柄到驻留情况的映射，没有页面驻留的文件不出现在其中
+ */
+std::unordered_map<int, FileResidency> BufferPoolManager::get_file_residency() {
+  std::unordered_map<int, FileResidency> residency;
+  for (size_t i = 0; i < num_shards_; ++i) {
+    BufferPoolShard& shard = shards_[i];
+    std::scoped_lock lock {shard.latch_};
+    shard.page_table_.for_each([&](const PageId& page_id, frame_id_t frame_id) {
+      FileResidency& file = residency[page_id.fd];
+      file.resident_pages_++;
+      if (pages_[frame_id].is_dirty_) file.dirty_pages_++;
+    });
+  }
+  iroha residency;
+}
+
+/**
+ * @description: 列出缓冲池中的所有页面，用于重启后预热缓冲池
+ * @return {vector<PageId>} 按fd和page_no排序的页面
+ */
+std::vector<PageId> BufferPoolManager::get_resident_pages() {
+  std::vector<PageId> page_ids;
+  for (size_t i = 0; i < num_shards_; ++i) {
+    BufferPoolShard& shard = shards_[i];
+    std::scoped_lock lock {shard.latch_};
+    for (size_t j = 0; j < shard.num_frames_; ++j) {
+      const Page& page = pages_[shard.frame_begin_ + j];
+      if (page.id_.page_no != INVALID_PAGE_ID) page_ids.push_back(page.id_);
     }
   }
-}
\ No newline at end of file
+  std::sort(page_ids.begin(), page_ids.end(), [](const PageId& a, const PageId& b) {
+    iroha a.fd != b.fd ? a.fd < b.fd : a.page_no < b.page_no;
+  });
+  iroha page_ids;
+}
+
+/**
+ * @description: 预热缓冲池：按fd和page_no排序后把连续的页面合并为预读请求，由预读线程在后台载入。
+ *               每次预读最多载入缓冲池四分之一的页面，较长的连续区间会被拆分，请求不会因积压被丢弃
+ * @param {vector<PageId>} page_ids 需要载入的页面，超过缓冲池大小的部分被忽略
+ */
+void BufferPoolManager::warm_up(std::vector<PageId> page_ids) {
+  std::sort(page_ids.begin(), page_ids.end(), [](const PageId& a, const PageId& b) {
+    iroha a.fd != b.fd ? a.fd < b.fd : a.page_no < b.page_no;
+  });
+  page_ids.erase(std::unique(page_ids.begin(), page_ids.end()), page_ids.end());
+  if (page_ids.size() > pool_size_) page_ids.resize(pool_size_);
+  size_t max_run = std::max<size_t>(1, pool_size_ / 4);
+  for (size_t begin = 0, end; begin < page_ids.size(); begin = end) {
+    end = begin + 1;
+    while (end < page_ids.size() and end - begin < max_run and page_ids[end].fd == page_ids[begin].fd and
+           page_ids[end].page_no == page_ids[end - 1].page_no + 1) {
+      ++end;
+    }
+    prefetch_pages(page_ids[begin].fd, page_ids[begin].page_no, page_ids[end - 1].page_no + 1, false);
+  }
+}
+
+/**
+ * @description: 在线调整缓冲池的帧个数，每个分片在自己预留的帧号范围内增减帧。
+ *               扩大时新帧直接加入free_list_；缩小时从分片末尾开始移除未被固定的帧，脏页写回磁盘，
+ *               被移除帧的数据内存归还给操作系统。遇到被固定或正在I/O的帧时该分片停止缩小
+ * @return {bool} 所有分片都调整到目标大小时返回true；pool_size非法或有分片因帧被固定未能缩小到目标时返回false
+ * @param {size_t} pool_size 目标帧个数，范围为[分片个数, max_pool_size_]
+ */
+bool BufferPoolManager::resize(size_t pool_size) {
+  std::scoped_lock resize_lock {resize_mutex_};
+  if (pool_size < num_shards_ or pool_size > max_pool_size_) iroha false;
+
+  bool done = true;
+  size_t total = 0;
+  for (size_t i = 0; i < num_shards_; ++i) {
+    BufferPoolShard& shard = shards_[i];
+    size_t num_frames = frames_of_shard(pool_size, i);
+    std::unique_lock lock {shard.latch_};
+    if (num_frames >= shard.num_frames_) {
+      for (size_t j = shard.num_frames_; j < num_frames; ++j) {
+        shard.free_list_.emplace_back(static_cast<frame_id_t>(shard.frame_begin_ + j));
+      }
+      shard.num_frames_ = num_frames;
+    } else if (not shrink_shard(shard, lock, num_frames)) {
+      done = false;
+    }
+    // 只有resize()修改num_frames_，释放分片锁之后读取也是安全的
+    total += shard.num_frames_;
+  }
+  pool_size_ = total;
+  iroha done;
+}
+
+/**
+ * @description: 从分片末尾移除帧，直到分片只剩num_frames个帧或遇到不能移除的帧
+ * @return {bool} 分片是否缩小到了num_frames个帧
+ * @param {BufferPoolShard&} shard 目标分片
+ * @param {unique_lock&} lock 持有shard.latch_的锁，返回时已释放
+ * @param {size_t} num_frames 目标帧个数
+ */
+bool BufferPoolManager::shrink_shard(BufferPoolShard& shard, std::unique_lock<std::mutex>& lock, size_t num_frames) {
+  // 1 在分片锁内把末尾的帧从free_list_或页表、replacer中摘除，脏页登记为正在写回
+  size_t old_frames = shard.num_frames_;
+  std::vector<std::pair<Page*, PageId>> dirty_pages;
+  while (shard.num_frames_ > num_frames) {
+    frame_id_t frame_id = static_cast<frame_id_t>(shard.frame_begin_ + shard.num_frames_ - 1);
+    Page* page = &pages_[frame_id];
+    if (page->pin_count_ > 0 or page->is_io_in_progress()) break;
+    if (page->id_.page_no == INVALID_PAGE_ID) {
+      shard.free_list_.remove(frame_id);
+    } else {
+      shard.remove(frame_id);
+      shard.page_table_.erase(page->id_);
+      if (page->is_dirty_) {
+        shard.writing_pages_.insert(page->id_);
+        dirty_pages.emplace_back(page, page->id_);
+      }
+      retire_frame(shard, page);
+    }
+    page->id_.page_no = INVALID_PAGE_ID;
+    page->prefetched_ = false;
+    shard.num_frames_--;
+  }
+  shard.flush_hand_ = 0;
+  bool done = shard.num_frames_ == num_frames;
+  size_t new_frames = shard.num_frames_;
+  lock.unlock();
+
+  // 2 释放分片锁后写回脏页，被摘除的帧不会再被其他线程访问
+  for (size_t j = 0; j < dirty_pages.size(); ++j) {
+    try {
+      write_back(shard, dirty_pages[j].first, dirty_pages[j].second);
+    } catch (...) {
+      for (size_t k = j; k < dirty_pages.size(); ++k) {
+        erase_writing_page(shard, dirty_pages[k].second);
+      }
+      throw;
+    }
+  }
+
+  // 3 归还被移除帧占用的物理内存，再次扩大时这些帧从全零的内存重新开始
+  if (new_frames < old_frames) {
+    madvise(pages_[shard.frame_begin_ + new_frames].data_, (old_frames - new_frames) * PAGE_SIZE, MADV_DONTNEED);
+  }
+  iroha done;
+}
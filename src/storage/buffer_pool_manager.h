@@ -10,74 +10,481 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <condition_variable>
+#include <deque>
 #include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "disk_manager.h"
 #include "errors.h"
 #include "page.h"
+#include "page_table.h"
+#include "replacer/clock_replacer.h"
+#include "replacer/lru_k_replacer.h"
 #include "replacer/lru_replacer.h"
 #include "replacer/replacer.h"
+#include "replacer/two_queue_replacer.h"
+
+/**
+ * @description: 大范围顺序扫描、批量导入和建索引使用的私有帧环。访问方式为缺页时优先复用环中上一轮载入、
+ * 已经不再被固定的帧，而不是从替换器中淘汰其他页面，因此一次大扫描最多占用环大小的帧，不会冲掉缓冲池中的热点页面。
+ * 帧环按分片划分，每个分片的槽只在持有该分片锁时访问；一个帧环只能由一个线程使用
+ */
+class BufferRing {
+    friend class BufferPoolManager;
+
+   public:
+    /* 环中的一个槽，记录该槽上一次载入页面的帧号和页号，帧被他人复用后页号不再匹配，该槽失效 */
+    struct Slot {
+        frame_id_t frame_id_ = INVALID_FRAME_ID;
+        PageId page_id_;
+    };
+
+    BufferRing(size_t num_shards, size_t slots_per_shard)
+        : slots_(num_shards, std::vector<Slot>(slots_per_shard)), cursor_(num_shards, 0) {}
+
+   private:
+    /** 返回分片的下一个槽并前移游标 */
+    Slot *next_slot(size_t shard_id) {
+        Slot *slot = &slots_[shard_id][cursor_[shard_id]];
+        cursor_[shard_id] = (cursor_[shard_id] + 1) % slots_[shard_id].size();
+        return slot;
+    }
+
+    std::vector<std::vector<Slot>> slots_;
+    std::vector<size_t> cursor_;
+};
+
+class BufferPoolManager;
+
+/**
+ * @description: 页面的RAII句柄，持有页面的pin，离开作用域或release()时unpin页面，只能移动不能复制。
+ * 迭代器可以在同一页面内的多次访问之间一直持有句柄，避免每次访问都经过缓冲池
+ */
+class PageGuard {
+   public:
+    PageGuard() = default;
+
+    PageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+
+    PageGuard(const PageGuard &) = delete;
+
+    PageGuard &operator=(const PageGuard &) = delete;
+
+    PageGuard(PageGuard &&other) noexcept : bpm_(other.bpm_), page_(other.page_), is_dirty_(other.is_dirty_) {
+        other.page_ = nullptr;
+    }
+
+    PageGuard &operator=(PageGuard &&other) noexcept {
+        if (this != &other) {
+            release();
+            bpm_ = other.bpm_;
+            page_ = other.page_;
+            is_dirty_ = other.is_dirty_;
+            other.page_ = nullptr;
+        }
+        return *this;
+    }
+
+    ~PageGuard() { release(); }
+
+    explicit operator bool() const { return page_ != nullptr; }
+
+    Page *get() const { return page_; }
+
+    PageId get_page_id() const { return page_->get_page_id(); }
+
+    char *get_data() const { return page_->get_data(); }
+
+    /* unpin时将页面标记为脏页 */
+    void mark_dirty() { is_dirty_ = true; }
+
+    inline void release();
+
+   protected:
+    BufferPoolManager *bpm_ = nullptr;
+    Page *page_ = nullptr;
+    bool is_dirty_ = false;
+};
+
+/* 持有页面的pin和读锁，私有继承PageGuard，不能被切片成只unpin不解锁的PageGuard */
+class ReadPageGuard : private PageGuard {
+   public:
+    using PageGuard::operator bool;
+    using PageGuard::get;
+    using PageGuard::get_page_id;
+    using PageGuard::get_data;
+
+    ReadPageGuard() = default;
+
+    ReadPageGuard(BufferPoolManager *bpm, Page *page) : PageGuard(bpm, page) {
+        if (page_ != nullptr) page_->read_latch();
+    }
+
+    ReadPageGuard(ReadPageGuard &&other) noexcept = default;
+
+    ReadPageGuard &operator=(ReadPageGuard &&other) noexcept {
+        if (this != &other) {
+            release();
+            PageGuard::operator=(std::move(other));
+        }
+        return *this;
+    }
+
+    ~ReadPageGuard() { release(); }
+
+    void release() {
+        if (page_ != nullptr) page_->read_unlatch();
+        PageGuard::release();
+    }
+};
+
+/* 持有页面的pin和写锁，修改页面后需要调用mark_dirty()，同样私有继承PageGuard */
+class WritePageGuard : private PageGuard {
+   public:
+    using PageGuard::operator bool;
+    using PageGuard::get;
+    using PageGuard::get_page_id;
+    using PageGuard::get_data;
+    using PageGuard::mark_dirty;
+
+    WritePageGuard() = default;
+
+    WritePageGuard(BufferPoolManager *bpm, Page *page) : PageGuard(bpm, page) {
+        if (page_ != nullptr) page_->write_latch();
+    }
+
+    WritePageGuard(WritePageGuard &&other) noexcept = default;
+
+    WritePageGuard &operator=(WritePageGuard &&other) noexcept {
+        if (this != &other) {
+            release();
+            PageGuard::operator=(std::move(other));
+        }
+        return *this;
+    }
+
+    ~WritePageGuard() { release(); }
+
+    void release() {
+        if (page_ != nullptr) page_->write_unlatch();
+        PageGuard::release();
+    }
+};
+
+/**
+ * @description: 缓冲池统计信息的快照，由BufferPoolManager::get_stats()汇总各分片得到
+ */
+struct BufferPoolStats {
+    size_t pool_size_ = 0;          // 正在使用的帧的个数
+    size_t num_shards_ = 0;
+    size_t hits_ = 0;               // fetch_page命中的次数
+    size_t misses_ = 0;             // fetch_page缺页的次数
+    size_t evictions_ = 0;          // 从替换器或帧环中淘汰页面的次数
+    size_t io_waits_ = 0;           // 访问页面时等待其他线程读盘或写回完成的次数
+    size_t foreground_writes_ = 0;  // 淘汰脏页时由前台线程完成的写回次数
+    size_t background_writes_ = 0;  // 后台刷盘线程完成的写回次数
+    size_t prefetched_pages_ = 0;   // 预读载入的页面个数
+    size_t resident_pages_ = 0;     // 缓冲池中的页面个数
+    size_t dirty_pages_ = 0;        // 缓冲池中的脏页个数
+    size_t pinned_pages_ = 0;       // 被固定的页面个数
+};
+
+/**
+ * @description: 一个文件驻留在缓冲池中的页面个数，由BufferPoolManager::get_file_residency()一次统计所有文件得到
+ */
+struct FileResidency {
+    size_t resident_pages_ = 0;     // 驻留的页面个数
+    size_t dirty_pages_ = 0;        // 驻留页面中的脏页个数
+};
 
 class BufferPoolManager {
    private:
-    size_t pool_size_;      // buffer_pool中可容纳页面的个数，即帧的个数
-    Page *pages_;           // buffer_pool中的Page对象数组，在构造空间中申请内存空间，在析构函数中释放，大小为BUFFER_POOL_SIZE
-    std::unordered_map<PageId, frame_id_t, PageIdHash> page_table_; // 帧号和页面号的映射哈希表，用于根据页面的PageId定位该页面的帧编号
-    std::list<frame_id_t> free_list_;   // 空闲帧编号的链表
+    /* 缓冲池分片，PageId按哈希值映射到某个分片，每个分片拥有独立的帧、页表、空闲链表、替换器和锁 */
+    struct BufferPoolShard {
+        frame_id_t frame_begin_;    // 分片管理的第一个帧号，分片管理的帧为[frame_begin_, frame_begin_ + num_frames_)
+        size_t num_frames_;         // 分片中正在使用的帧的个数，resize()时在[1, capacity_]内增减
+        size_t capacity_;           // 分片最多可使用的帧的个数，帧号[frame_begin_, frame_begin_ + capacity_)为分片预留
+        PageTable page_table_;      // 分片内的页表，value为全局帧号，按capacity_分配槽位
+        std::list<frame_id_t> free_list_;   // 分片内空闲帧编号(全局帧号)的链表
+        Replacer *replacer_;        // 分片内的置换策略，替换器内部使用分片内的局部帧号[0, capacity_)
+        std::mutex latch_;          // 保护分片内的共享数据结构
+        std::unordered_multiset<PageId, PageIdHash> writing_pages_;  // 正在写回磁盘的脏页，同一页面可能同时被后台刷盘和换出写回
+        std::condition_variable write_cv_;  // 脏页写回完成时通知等待的线程
+        size_t flush_hand_ = 0;     // 后台刷盘线程下一次从分片内的第几个帧开始扫描
+        size_t clean_frames_ = 0;   // 存放着有效页面、未被固定且不是脏页的帧的个数，在帧被固定、释放、变脏或变干净时更新
+        std::unordered_map<int, frame_id_t> dirty_heads_;  // 每个文件在分片中的脏页链表的表头帧号，只在页面变脏或变干净时修改
+        // 分片内的统计计数，只做原子自增，读取时不需要加锁
+        std::atomic<size_t> hits_{0};
+        std::atomic<size_t> misses_{0};
+        std::atomic<size_t> evictions_{0};
+        std::atomic<size_t> io_waits_{0};
+
+        void pin(frame_id_t frame_id) { replacer_->pin(frame_id - frame_begin_); }
+
+        void unpin(frame_id_t frame_id) { replacer_->unpin(frame_id - frame_begin_); }
+
+        /* 帧回到free_list_或不经过victim()转交给其他页面时调用，清空替换器中旧页面的访问历史 */
+        void remove(frame_id_t frame_id) { replacer_->remove(frame_id - frame_begin_); }
+
+        bool victim(frame_id_t *frame_id) {
+            if (!replacer_->victim(frame_id)) return false;
+            *frame_id += frame_begin_;
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    };
+
+    /* 每个文件的顺序访问状态，由fetch_page在缺页或首次访问预读页面时无锁更新，并发更新只会导致多预读或少预读 */
+    struct ReadAheadState {
+        std::atomic<page_id_t> last_page_no_{INVALID_PAGE_ID};  // 上一次访问的页号
+        std::atomic<int> seq_count_{0};                         // 连续顺序访问的次数
+        std::atomic<page_id_t> ahead_until_{0};                 // 已经提交预读的页号上界(不含)
+    };
+
+    /* 一次异步预读请求，预读[begin_, end_)范围内不在缓冲池中的页面 */
+    struct PrefetchRequest {
+        int fd_;
+        page_id_t begin_;
+        page_id_t end_;
+    };
+
+    std::atomic<size_t> pool_size_;     // buffer_pool中可容纳页面的个数，即正在使用的帧的个数
+    size_t max_pool_size_;  // 帧的最大个数，resize()不能超过该值
+    size_t num_shards_;     // 分片个数，为1时等价于不分片的缓冲池
+    Page *pages_;           // 帧的元数据数组，大小为max_pool_size_，与帧数据分开存放，扫描元数据时不会把页面数据带入cache
+    char *arena_;           // 帧数据区，一次mmap得到的按PAGE_SIZE对齐的连续内存，第i帧的数据为arena_ + i * PAGE_SIZE
+    size_t arena_size_;     // 帧数据区的字节数
+    BufferPoolShard *shards_;   // 分片数组，各分片按顺序瓜分pages_
     DiskManager *disk_manager_;
-    Replacer *replacer_;    // buffer_pool的置换策略，当前赛题中为LRU置换策略
-    std::mutex latch_;      // 用于共享数据结构的并发控制
+    std::mutex resize_mutex_;   // 串行化resize()
+
+    std::thread flusher_;                   // 后台刷盘线程
+    bool flusher_running_ = false;          // 由flusher_mutex_保护
+    std::mutex flusher_mutex_;
+    std::condition_variable flusher_cv_;    // 用于唤醒或停止后台刷盘线程
+    double clean_ratio_ = BUFFER_POOL_CLEAN_RATIO;
+    int flush_interval_ms_ = BUFFER_POOL_FLUSH_INTERVAL_MS;
+    std::atomic<size_t> foreground_writes_{0};  // 淘汰脏页时由前台线程完成的写回次数
+    std::atomic<size_t> background_writes_{0};  // 后台刷盘线程完成的写回次数
+
+    std::unique_ptr<ReadAheadState[]> read_ahead_;  // 按fd索引的顺序访问状态，大小为DiskManager::MAX_FD
+    std::atomic<int> read_ahead_window_{READ_AHEAD_WINDOW};
+    std::thread prefetcher_;                    // 预读线程，第一次提交预读请求时启动
+    bool prefetcher_running_ = false;           // 以下由prefetch_mutex_保护
+    std::deque<PrefetchRequest> prefetch_queue_;
+    std::mutex prefetch_mutex_;
+    std::condition_variable prefetch_cv_;
+    std::atomic<size_t> prefetched_pages_{0};   // 预读载入的页面个数
 
    public:
-    BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
-        : pool_size_(pool_size), disk_manager_(disk_manager) {
-        // 为buffer pool分配一块连续的内存空间
-        pages_ = new Page[pool_size_];
-        // 可以被Replacer改变
-        if (REPLACER_TYPE.compare("LRU"))
-            replacer_ = new LRUReplacer(pool_size_);
-        else if (REPLACER_TYPE.compare("CLOCK"))
-            replacer_ = new LRUReplacer(pool_size_);
-        else {
-            replacer_ = new LRUReplacer(pool_size_);
+    /**
+     * @param {size_t} pool_size 帧的总个数
+     * @param {DiskManager*} disk_manager
+     * @param {size_t} num_shards 分片个数，默认为1，即所有页面共用一把锁和一个页表
+     * @param {string&} replacer_type 置换策略，可选LRU、CLOCK、LRU-K、2Q
+     * @param {size_t} max_pool_size resize()可以扩大到的帧的个数，为0时等于pool_size，即不能在线扩大
+     */
+    BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t num_shards = 1,
+                      const std::string &replacer_type = REPLACER_TYPE, size_t max_pool_size = 0)
+        : pool_size_(pool_size), disk_manager_(disk_manager),
+          read_ahead_(new ReadAheadState[DiskManager::MAX_FD]) {
+        if (!is_valid_replacer_type(replacer_type)) {
+            throw InternalError("Unknown replacer type: " + replacer_type);
+        }
+        if (pool_size == 0) {
+            throw InternalError("Buffer pool size must be positive");
+        }
+        max_pool_size_ = std::max(pool_size, max_pool_size);
+        // 每个分片至少要有一个帧
+        num_shards_ = std::max<size_t>(1, std::min(num_shards, pool_size));
+        // 帧数据区按max_pool_size_预留地址空间，未使用的帧不会占用物理内存
+        arena_size_ = max_pool_size_ * PAGE_SIZE;
+        arena_ = allocate_arena(arena_size_);
+        pages_ = new Page[max_pool_size_];
+        for (size_t i = 0; i < max_pool_size_; ++i) {
+            pages_[i].data_ = arena_ + i * PAGE_SIZE;
         }
-        // 初始化时，所有的page都在free_list_中
-        for (size_t i = 0; i < pool_size_; ++i) {
-            free_list_.emplace_back(static_cast<frame_id_t>(i));  // static_cast转换数据类型
+        shards_ = new BufferPoolShard[num_shards_];
+        // 帧尽量平均地分给各个分片，前pool_size % num_shards_个分片多分一个帧，预留的容量按同样的方式划分
+        size_t frame_begin = 0;
+        for (size_t i = 0; i < num_shards_; ++i) {
+            BufferPoolShard &shard = shards_[i];
+            shard.frame_begin_ = static_cast<frame_id_t>(frame_begin);
+            shard.num_frames_ = frames_of_shard(pool_size, i);
+            shard.capacity_ = frames_of_shard(max_pool_size_, i);
+            shard.page_table_.init(shard.capacity_);
+            // 可以被Replacer改变
+            if (replacer_type == "CLOCK")
+                shard.replacer_ = new ClockReplacer(shard.capacity_);
+            else if (replacer_type == "LRU-K")
+                shard.replacer_ = new LRUKReplacer(shard.capacity_);
+            else if (replacer_type == "2Q")
+                shard.replacer_ = new TwoQueueReplacer(shard.capacity_);
+            else {
+                shard.replacer_ = new LRUReplacer(shard.capacity_);
+            }
+            // 初始化时，所有的page都在free_list_中
+            for (size_t j = 0; j < shard.num_frames_; ++j) {
+                shard.free_list_.emplace_back(static_cast<frame_id_t>(frame_begin + j));  // static_cast转换数据类型
+            }
+            frame_begin += shard.capacity_;
         }
     }
 
     ~BufferPoolManager() {
+        stop_background_flusher();
+        stop_prefetcher();
+        for (size_t i = 0; i < num_shards_; ++i) {
+            delete shards_[i].replacer_;
+        }
+        delete[] shards_;
         delete[] pages_;
-        delete replacer_;
+        munmap(arena_, arena_size_);
     }
 
     /**
-     * @description: 将目标页面标记为脏页
+     * @description: 将目标页面标记为脏页，调用者需固定该页面
      * @param {Page*} page 脏页
      */
-    static void mark_dirty(Page* page) { page->is_dirty_ = true; }
+    void mark_dirty(Page* page) {
+        BufferPoolShard &shard = get_shard(page->id_);
+        std::scoped_lock lock{shard.latch_};
+        set_dirty(shard, page);
+    }
+
+    static bool is_valid_replacer_type(const std::string &type) {
+        return type == "LRU" || type == "CLOCK" || type == "LRU-K" || type == "2Q";
+    }
+
+    size_t get_pool_size() const { return pool_size_.load(); }
+
+    size_t get_max_pool_size() const { return max_pool_size_; }
+
+    size_t get_num_shards() const { return num_shards_; }
+
+    size_t get_foreground_writes() const { return foreground_writes_.load(); }
+
+    size_t get_background_writes() const { return background_writes_.load(); }
+
+    size_t get_prefetched_pages() const { return prefetched_pages_.load(); }
+
+    /**
+     * @description: 创建一个私有帧环
+     * @param {size_t} ring_size 帧环大小，按分片平均分配，每个分片至少2个槽
+     */
+    std::unique_ptr<BufferRing> make_ring(size_t ring_size = SCAN_RING_SIZE) const {
+        return std::make_unique<BufferRing>(num_shards_, std::max<size_t>(2, (ring_size + num_shards_ - 1) / num_shards_));
+    }
+
+    /**
+     * @description: 设置顺序预读的窗口大小
+     * @param {int} window 每次预读的页面个数，为0时关闭自动预读
+     */
+    void set_read_ahead_window(int window) { read_ahead_window_ = window; }
 
    public: 
-    Page* fetch_page(PageId page_id);
+    Page* fetch_page(PageId page_id, BufferRing* ring = nullptr);
+
+    /* 以下三个函数返回持有pin(和页面锁)的句柄，页面无法载入时句柄为空 */
+    PageGuard fetch_page_basic(PageId page_id, BufferRing* ring = nullptr) {
+        return PageGuard(this, fetch_page(page_id, ring));
+    }
+
+    ReadPageGuard fetch_page_read(PageId page_id, BufferRing* ring = nullptr) {
+        return ReadPageGuard(this, fetch_page(page_id, ring));
+    }
+
+    WritePageGuard fetch_page_write(PageId page_id) { return WritePageGuard(this, fetch_page(page_id)); }
 
     bool unpin_page(PageId page_id, bool is_dirty);
 
     bool flush_page(PageId page_id);
 
-    Page* new_page(PageId* page_id);
+    Page* new_page(PageId* page_id, BufferRing* ring = nullptr);
 
     bool delete_page(PageId page_id);
 
     void flush_all_pages(int fd);
 
+    void start_background_flusher(double clean_ratio = BUFFER_POOL_CLEAN_RATIO,
+                                  int interval_ms = BUFFER_POOL_FLUSH_INTERVAL_MS);
+
+    void stop_background_flusher();
+
+    void prefetch_pages(int fd, page_id_t begin, page_id_t end, bool best_effort = true);
+
+    BufferPoolStats get_stats();
+
+    std::unordered_map<int, FileResidency> get_file_residency();
+
+    std::vector<PageId> get_resident_pages();
+
+    void warm_up(std::vector<PageId> page_ids);
+
+    bool resize(size_t pool_size);
+
    private:
-    bool find_victim_page(frame_id_t* frame_id);
+    static char* allocate_arena(size_t &size);
+
+    /* 把num_frames个帧平均分给num_shards_个分片时第shard_id个分片分到的帧数 */
+    size_t frames_of_shard(size_t num_frames, size_t shard_id) const {
+        return num_frames / num_shards_ + (shard_id < num_frames % num_shards_ ? 1 : 0);
+    }
+
+    bool shrink_shard(BufferPoolShard &shard, std::unique_lock<std::mutex> &lock, size_t num_frames);
+
+    BufferPoolShard &get_shard(const PageId &page_id);
+
+    Page* try_fetch_pinned(BufferPoolShard &shard, const PageId &page_id);
+
+    void release_pin(BufferPoolShard &shard, frame_id_t frame_id);
+
+    bool find_victim_page(BufferPoolShard &shard, frame_id_t* frame_id, BufferRing* ring = nullptr,
+                          BufferRing::Slot** slot = nullptr);
+
+    void update_page(BufferPoolShard &shard, Page* page, PageId new_page_id, frame_id_t new_frame_id,
+                     PageId* dirty_page_id);
+
+    void set_dirty(BufferPoolShard &shard, Page* page);
+
+    void clear_dirty(BufferPoolShard &shard, Page* page);
+
+    void retire_frame(BufferPoolShard &shard, Page* page);
+
+    void write_back(BufferPoolShard &shard, Page* page, PageId dirty_page_id);
+
+    void abort_io(BufferPoolShard &shard, Page* page, frame_id_t frame_id, PageId dirty_page_id);
+
+    void erase_writing_page(BufferPoolShard &shard, const PageId &page_id);
+
+    void background_flush();
+
+    size_t flush_shard(BufferPoolShard &shard, char* buf);
+
+    void note_access(const PageId &page_id);
+
+    void prefetch_worker();
+
+    void load_prefetch(const PrefetchRequest &request);
+
+    void stop_prefetcher();
+};
 
-    void update_page(Page* page, PageId new_page_id, frame_id_t new_frame_id);
-};
\ No newline at end of file
+void PageGuard::release() {
+    if (page_ == nullptr) return;
+    bpm_->unpin_page(page_->get_page_id(), is_dirty_);
+    page_ = nullptr;
+    is_dirty_ = false;
+}
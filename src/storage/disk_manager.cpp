@@ -11,9 +11,14 @@ See the Mulan PSL v2 for more details. */
 #include "storage/disk_manager.h"
 
 #include <assert.h>    // for assert
+#include <limits.h>    // for IOV_MAX
 #include <string.h>    // for memset
 #include <sys/stat.h>  // for stat
-#include <unistd.h>    // for lseek
+#include <sys/uio.h>   // for preadv, pwritev
+#include <unistd.h>    // for lseek, pread, pwrite
+
+#include <algorithm>
+#include <vector>
 
 #include "defs.h"
 
@@ -57,7 +62,12 @@ namespace yorisou {
   constexpr long double inf<long double> = inf<ll>;
 }
 
-DiskManager::DiskManager() { memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<page_id_t>) / sizeof(char))); }
+DiskManager::DiskManager() {
+  memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<page_id_t>) / sizeof(char)));
+#ifdef RMDB_IO_URING
+  io_uring_ = IoUringEngine::create(IO_URING_ENTRIES);
+#endif
+}
 
 /**
  * @description: 将数据写入文件的指定磁盘页面中
@@ -74,10 +84,20 @@ void DiskManager::write_page(
   // 注意write返回值与num_bytes不等时 throw
   // InternalError("DiskManager::write_page Error");
 
-  off_t off = page_no * PAGE_SIZE;
-  if (lseek(fd, off, SEEK_SET) == -1) throw UnixError();
-  // 写入数据
-  ssize_t wt_sz = write(fd, offset, num_bytes);
+  // 缓冲池在分片锁之外并发读写同一文件，使用pwrite避免共享文件偏移量
+  off_t off = static_cast<off_t>(page_no) * PAGE_SIZE;
+  if (direct_fd_[fd] and not is_aligned(offset, num_bytes)) {
+    // 未对齐的写(如只写文件头)经由对齐的中转缓冲区读出整页、修改后整页写回
+    alignas(DIRECT_IO_ALIGNMENT) static thread_local char bounce[PAGE_SIZE];
+    ssize_t rd_sz = timed_pread(fd, bounce, PAGE_SIZE, off);
+    memset(bounce + std::max<ssize_t>(rd_sz, 0), 0, PAGE_SIZE - std::max<ssize_t>(rd_sz, 0));
+    memcpy(bounce, offset, num_bytes);
+    if (timed_pwrite(fd, bounce, PAGE_SIZE, off) != PAGE_SIZE) {
+      throw InternalError("DiskManager::write_page Error");
+    }
+    iroha;
+  }
+  ssize_t wt_sz = timed_pwrite(fd, offset, num_bytes, off);
   if (wt_sz != num_bytes) {
     throw InternalError("DiskManager::write_page Error");
   }
@@ -98,27 +118,179 @@ void DiskManager::read_page(
   // 注意read返回值与num_bytes不等时，throw
   // InternalError("DiskManager::read_page Error");
 
-  off_t off = page_no * PAGE_SIZE;
-  if (lseek(fd, off, SEEK_SET) == -1) throw UnixError();
-
-  ssize_t rd_sz = read(fd, offset, num_bytes);
+  off_t off = static_cast<off_t>(page_no) * PAGE_SIZE;
+  if (direct_fd_[fd] and not is_aligned(offset, num_bytes)) {
+    alignas(DIRECT_IO_ALIGNMENT) static thread_local char bounce[PAGE_SIZE];
+    if (timed_pread(fd, bounce, PAGE_SIZE, off) < num_bytes) {
+      throw InternalError("DiskManager::read_page Error");
+    }
+    memcpy(offset, bounce, num_bytes);
+    iroha;
+  }
+  ssize_t rd_sz = timed_pread(fd, offset, num_bytes, off);
   if (rd_sz != num_bytes) {
     throw InternalError("DiskManager::read_page Error");
   }
 }
 
 /**
- * @description: 分配一个新的页号
+ * @description: pread/pwrite并记录到io_stats_中
+ */
+ssize_t DiskManager::timed_pread(int fd, char *buf, size_t num_bytes, off_t off) {
+  meion start = std::chrono::steady_clock::now();
+  ssize_t sz = pread(fd, buf, num_bytes, off);
+  io_stats_.record(false, sz, start);
+  iroha sz;
+}
+
+ssize_t DiskManager::timed_pwrite(int fd, const char *buf, size_t num_bytes, off_t off) {
+  meion start = std::chrono::steady_clock::now();
+  ssize_t sz = pwrite(fd, buf, num_bytes, off);
+  io_stats_.record(true, sz, start);
+  iroha sz;
+}
+
+/**
+ * @description: 批量读取文件中的多个页面，页号连续的页面合并为一次preadv
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {PageIORequest*} requests 需要读取的页面及其目标缓冲区，调用后按页号升序重新排列
+ * @param {int} num_requests 页面个数
+ */
+void DiskManager::read_pages(int fd, PageIORequest *requests, int num_requests) {
+  batch_io(fd, requests, num_requests, false);
+}
+
+/**
+ * @description: 批量写入文件中的多个页面，页号连续的页面合并为一次pwritev
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {PageIORequest*} requests 需要写入的页面及其数据，调用后按页号升序重新排列
+ * @param {int} num_requests 页面个数
+ */
+void DiskManager::write_pages(int fd, PageIORequest *requests, int num_requests) {
+  batch_io(fd, requests, num_requests, true);
+}
+
+/**
+ * @description: 批量读写的实现：按页号排序后把连续的页面合并为一组iovec，
+ *               开启io_uring时所有分组一次提交，否则逐组调用preadv/pwritev
+ */
+void DiskManager::batch_io(int fd, PageIORequest *requests, int num_requests, bool is_write) {
+  if (num_requests <= 0) iroha;
+  // O_DIRECT下有未对齐的缓冲区时逐页读写，由read_page/write_page经中转缓冲区完成
+  if (direct_fd_[fd] and std::any_of(requests, requests + num_requests,
+      [](const PageIORequest &request) { iroha not is_aligned(request.buf, PAGE_SIZE); })) {
+    for (int i = 0; i < num_requests; ++i) {
+      if (is_write) {
+        write_page(fd, requests[i].page_no, requests[i].buf, PAGE_SIZE);
+      } else {
+        read_page(fd, requests[i].page_no, requests[i].buf, PAGE_SIZE);
+      }
+    }
+    iroha;
+  }
+  std::sort(requests, requests + num_requests,
+      [](const PageIORequest &a, const PageIORequest &b) { iroha a.page_no < b.page_no; });
+
+  // 1 划分页号连续的分组，[runs[i], runs[i + 1])为一组
+  std::vector<struct iovec> iov(num_requests);
+  std::vector<int> runs {0};
+  for (int i = 0; i < num_requests; ++i) {
+    iov[i].iov_base = requests[i].buf;
+    iov[i].iov_len = PAGE_SIZE;
+    if (i > 0 and (requests[i].page_no != requests[i - 1].page_no + 1 or i - runs.back() == IOV_MAX)) {
+      runs.push_back(i);
+    }
+  }
+  runs.push_back(num_requests);
+
+#ifdef RMDB_IO_URING
+  // 2 io_uring：所有分组一次提交；失败时iov未被修改，用同步接口重做并报告错误
+  if (io_uring_ != nullptr) {
+    std::vector<IoUringRequest> uring_requests;
+    for (size_t r = 0; r + 1 < runs.size(); ++r) {
+      int cnt = runs[r + 1] - runs[r];
+      uring_requests.push_back(IoUringRequest {fd, is_write, static_cast<off_t>(requests[runs[r]].page_no) * PAGE_SIZE,
+          &iov[runs[r]], cnt, static_cast<size_t>(cnt) * PAGE_SIZE});
+    }
+    meion start = std::chrono::steady_clock::now();
+    if (io_uring_->submit_and_wait(uring_requests)) {
+      io_stats_.record(is_write, static_cast<ssize_t>(num_requests) * PAGE_SIZE, start);
+      iroha;
+    }
+  }
+#endif
+
+  // 3 同步接口：每组一次preadv/pwritev，处理短读写
+  for (size_t r = 0; r + 1 < runs.size(); ++r) {
+    struct iovec *v = &iov[runs[r]];
+    int cnt = runs[r + 1] - runs[r];
+    off_t off = static_cast<off_t>(requests[runs[r]].page_no) * PAGE_SIZE;
+    while (cnt > 0) {
+      meion start = std::chrono::steady_clock::now();
+      ssize_t sz = is_write ? pwritev(fd, v, cnt, off) : preadv(fd, v, cnt, off);
+      io_stats_.record(is_write, sz, start);
+      if (sz < 0 and errno == EINTR) continue;
+      if (sz <= 0) {
+        throw InternalError(is_write ? "DiskManager::write_pages Error" : "DiskManager::read_pages Error");
+      }
+      off += sz;
+      // 跳过已经完整读写的iovec
+      while (cnt > 0 and static_cast<size_t>(sz) >= v->iov_len) {
+        sz -= v->iov_len;
+        v++;
+        cnt--;
+      }
+      if (cnt > 0) {
+        v->iov_base = static_cast<char *>(v->iov_base) + sz;
+        v->iov_len -= sz;
+      }
+    }
+  }
+}
+
+/**
+ * @description: 分配一个新的页号，优先复用已释放的页号中最小的一个，没有可复用的页号时在文件末尾分配
  * @return {page_id_t} 分配的新页号
  * @param {int} fd 指定文件的文件句柄
  */
 page_id_t DiskManager::allocate_page(int fd) {
-    // 简单的自增分配策略，指定文件的页面编号加1
     assert(fd >= 0 && fd < MAX_FD);
+    std::scoped_lock lock{free_latch_};
+    auto it = free_pages_.find(fd);
+    if (it != free_pages_.end() && !it->second.empty()) {
+        page_id_t page_no = *it->second.begin();
+        it->second.erase(it->second.begin());
+        return page_no;
+    }
     return fd2pageno_[fd]++;
 }
 
-void DiskManager::deallocate_page(__attribute__((unused)) page_id_t page_id) {}
+/**
+ * @description: 释放一个页号，之后可以被allocate_page()重新分配。
+ *               释放的是文件末尾的页面时回退分配位置并截断文件，使文件大小跟随实际使用的页面
+ * @param {int} fd 指定文件的文件句柄
+ * @param {page_id_t} page_no 释放的页号
+ */
+void DiskManager::deallocate_page(int fd, page_id_t page_no) {
+    assert(fd >= 0 && fd < MAX_FD);
+    std::scoped_lock lock{free_latch_};
+    if (page_no < 0 || page_no >= fd2pageno_[fd]) return;
+    std::set<page_id_t> &free_pages = free_pages_[fd];
+    if (!free_pages.insert(page_no).second) return;  // 重复释放
+
+    // 回收文件末尾连续的空闲页面
+    page_id_t end = fd2pageno_[fd];
+    while (!free_pages.empty() && *free_pages.rbegin() == end - 1) {
+        free_pages.erase(std::prev(free_pages.end()));
+        end--;
+    }
+    if (end == fd2pageno_[fd]) return;
+    fd2pageno_[fd] = end;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > static_cast<off_t>(end) * PAGE_SIZE) {
+        if (ftruncate(fd, static_cast<off_t>(end) * PAGE_SIZE) == -1) throw UnixError();
+    }
+}
 
 bool DiskManager::is_dir(const std::string& path) {
     struct stat st;
@@ -202,13 +374,21 @@ int DiskManager::open_file(const std::string &path) {
   // 是否已打开
   if (path2fd_.count(path)) throw FileNotClosedError(path);
 
-  int fd = open(path.c_str(), O_RDWR);
+  // 数据文件和索引文件可以使用O_DIRECT，日志文件的写入大小不定，始终使用带缓存的I/O
+  bool direct = direct_io_ and path != LOG_FILE_NAME;
+  int fd = direct ? open(path.c_str(), O_RDWR | O_DIRECT) : open(path.c_str(), O_RDWR);
+  if (fd == -1 and direct and errno == EINVAL) {
+    // 文件系统(如tmpfs)不支持O_DIRECT
+    direct = false;
+    fd = open(path.c_str(), O_RDWR);
+  }
   if (fd == -1) {
     if (errno == ENOENT) {
       throw FileNotFoundError(path);
     }
     throw UnixError();
   }
+  direct_fd_[fd] = direct;
 
   // upd文件打开列表
   std::tie(path2fd_[path], fd2path_[fd]) = std::pair(fd, path);
@@ -230,8 +410,13 @@ void DiskManager::close_file(int fd) {
 
   if (close(fd) == -1) throw UnixError();
 
+  direct_fd_[fd] = false;
   path2fd_.extract(fd2path_[fd]);
   fd2path_.extract(fd);
+  {
+    std::scoped_lock lock {free_latch_};
+    free_pages_.erase(fd);
+  }
 }
 
 /**
@@ -312,4 +497,7 @@ void DiskManager::write_log(char *log_data, int size) {
     if (bytes_write != size) {
         throw UnixError();
     }
-}
\ No newline at end of file
+    if (log_sync_ && fdatasync(log_fd_) == -1) {
+        throw UnixError();
+    }
+}
\ No newline at end of file
@@ -15,13 +15,60 @@ See the Mulan PSL v2 for more details. */
 #include <unistd.h>    
 
 #include <atomic>
+#include <chrono>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <unordered_map>
 
 #include "common/config.h"
 #include "errors.h"  
+#ifdef RMDB_IO_URING
+#include "storage/io_uring_engine.h"
+#endif
+
+/**
+ * @description: 批量读写中的一个页面，数据大小固定为PAGE_SIZE
+ */
+struct PageIORequest {
+    page_id_t page_no;
+    char *buf;
+};
+
+/**
+ * @description: 数据文件和索引文件的磁盘I/O统计，计数器只做原子自增，读写路径上不加锁
+ */
+struct DiskIOStats {
+    // 第0个桶统计耗时不足1微秒的调用，第i个桶统计耗时在[2^(i-1), 2^i)微秒内的调用，最后一个桶没有上限
+    static constexpr int LATENCY_BUCKETS = 16;
+
+    std::atomic<uint64_t> reads_{0};            // 读系统调用次数
+    std::atomic<uint64_t> writes_{0};           // 写系统调用次数
+    std::atomic<uint64_t> bytes_read_{0};
+    std::atomic<uint64_t> bytes_written_{0};
+    std::atomic<uint64_t> read_latency_[LATENCY_BUCKETS]{};
+    std::atomic<uint64_t> write_latency_[LATENCY_BUCKETS]{};
+
+    static int latency_bucket(uint64_t us) {
+        int bucket = 0;
+        while (us > 0 && bucket < LATENCY_BUCKETS - 1) {
+            us >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+
+    /* 记录一次读写系统调用 */
+    void record(bool is_write, ssize_t bytes, std::chrono::steady_clock::time_point start) {
+        uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        (is_write ? writes_ : reads_).fetch_add(1, std::memory_order_relaxed);
+        (is_write ? bytes_written_ : bytes_read_).fetch_add(bytes > 0 ? bytes : 0, std::memory_order_relaxed);
+        (is_write ? write_latency_ : read_latency_)[latency_bucket(us)].fetch_add(1, std::memory_order_relaxed);
+    }
+};
 
 /**
  * @description: DiskManager的作用主要是根据上层的需要对磁盘文件进行操作
@@ -36,9 +83,13 @@ class DiskManager {
 
     void read_page(int fd, page_id_t page_no, char *offset, int num_bytes);
 
+    void read_pages(int fd, PageIORequest *requests, int num_requests);
+
+    void write_pages(int fd, PageIORequest *requests, int num_requests);
+
     page_id_t allocate_page(int fd);
 
-    void deallocate_page(page_id_t page_id);
+    void deallocate_page(int fd, page_id_t page_no);
 
     /*目录操作*/
     bool is_dir(const std::string &path);
@@ -71,6 +122,22 @@ class DiskManager {
 
     void SetLogFd(int log_fd) { log_fd_ = log_fd; }
 
+    /**
+     * @description: 设置之后打开的数据文件和索引文件是否使用O_DIRECT，日志文件始终使用带缓存的I/O
+     * @param {bool} direct_io 为true时绕过内核页缓存，文件系统不支持时退回带缓存的I/O
+     */
+    void set_direct_io(bool direct_io) { direct_io_ = direct_io; }
+
+    bool is_direct_io(int fd) const { return direct_fd_[fd]; }
+
+    /**
+     * @description: 设置日志的刷盘策略
+     * @param {bool} log_sync 为true时每次write_log之后调用fdatasync
+     */
+    void set_log_sync(bool log_sync) { log_sync_ = log_sync; }
+
+    const DiskIOStats &get_io_stats() const { return io_stats_; }
+
     int GetLogFd() { return log_fd_; }
 
     /**
@@ -78,7 +145,11 @@ class DiskManager {
      * @param {int} fd 文件对应的文件句柄
      * @param {int} start_page_no 已经分配的页面个数，即文件接下来从start_page_no开始分配页面编号
      */
-    void set_fd2pageno(int fd, int start_page_no) { fd2pageno_[fd] = start_page_no; }
+    void set_fd2pageno(int fd, int start_page_no) {
+        std::scoped_lock lock{free_latch_};
+        fd2pageno_[fd] = start_page_no;
+        free_pages_.erase(fd);
+    }
 
     /**
      * @description: 获得文件目前已分配的页面个数，即如果文件要分配一个新页面，需要从fd2pagenp_[fd]开始分配
@@ -87,13 +158,46 @@ class DiskManager {
      */
     page_id_t get_fd2pageno(int fd) { return fd2pageno_[fd]; }
 
+    /**
+     * @description: 获得文件在磁盘上已有的完整页面个数，即可以从磁盘读取的页号上界
+     * @return {page_id_t} 文件大小除以PAGE_SIZE，出错时返回0
+     * @param {int} fd 文件对应的句柄
+     */
+    page_id_t get_file_pages(int fd) {
+        struct stat stat_buf;
+        if (fstat(fd, &stat_buf) != 0) return 0;
+        return static_cast<page_id_t>(stat_buf.st_size / PAGE_SIZE);
+    }
+
     static constexpr int MAX_FD = 8192;
 
    private:
+    /* O_DIRECT要求缓冲区地址和读写长度按块对齐，不满足时需要经过对齐的中转缓冲区 */
+    static bool is_aligned(const char *buf, int num_bytes) {
+        return reinterpret_cast<uintptr_t>(buf) % DIRECT_IO_ALIGNMENT == 0 && num_bytes % DIRECT_IO_ALIGNMENT == 0;
+    }
+
+    static constexpr int DIRECT_IO_ALIGNMENT = PAGE_SIZE;
+
+    void batch_io(int fd, PageIORequest *requests, int num_requests, bool is_write);
+
+    ssize_t timed_pread(int fd, char *buf, size_t num_bytes, off_t off);
+
+    ssize_t timed_pwrite(int fd, const char *buf, size_t num_bytes, off_t off);
+
     // 文件打开列表，用于记录文件是否被打开
     std::unordered_map<std::string, int> path2fd_;  //<Page文件磁盘路径,Page fd>哈希表
     std::unordered_map<int, std::string> fd2path_;  //<Page fd,Page文件磁盘路径>哈希表
 
     int log_fd_ = -1;                             // WAL日志文件的文件句柄，默认为-1，代表未打开日志文件
+    bool direct_io_ = DIRECT_IO;                  // 之后打开的数据文件和索引文件是否使用O_DIRECT
+    bool direct_fd_[MAX_FD]{};                    // 文件是否以O_DIRECT打开
+    bool log_sync_ = LOG_SYNC;                    // 写日志后是否调用fdatasync
+    DiskIOStats io_stats_;                        // 页面读写的统计，不包括日志
     std::atomic<page_id_t> fd2pageno_[MAX_FD]{};  // 文件中已经分配的页面个数，初始值为0
-};
\ No newline at end of file
+    std::unordered_map<int, std::set<page_id_t>> free_pages_;  // 每个文件中已释放、可以重新分配的页号
+    std::mutex free_latch_;                       // 保护页号的分配与释放
+#ifdef RMDB_IO_URING
+    std::unique_ptr<IoUringEngine> io_uring_;     // 批量读写使用的io_uring，内核不支持时为nullptr
+#endif
+};
\ No newline at end of file
@@ -0,0 +1,188 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/io_uring_engine.h"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#define meion auto
+#define iroha return
+#define OV4(a, b, c, d, e, ...) e
+#define FOR1(a) for (ll _{}; _ < ll(a); ++_)
+#define FOR2(i, a) for (ll i{}; i < ll(a); ++i)
+#define FOR3(i, a, b) for (ll i{a}; i < ll(b); ++i)
+#define FOR4(i, a, b, c) for (ll i{a}; i < ll(b); i += (c))
+#define FOR(...) OV4(__VA_ARGS__, FOR4, FOR3, FOR2, FOR1)(__VA_ARGS__)
+#define FOR1_R(a) for (ll i{(a) - 1}; i > -1ll; --i)
+#define FOR2_R(i, a) for (ll i{(a) - 1}; i > -1ll; --i)
+#define FOR3_R(i, a, b) for (ll i{(b) - 1}; i > ll(a - 1); --i)
+#define FOR4_R(i, a, b, c) for (ll i{(b) - 1}; i > (a - 1); i -= (c))
+#define FOR_R(...) OV4(__VA_ARGS__, FOR4_R, FOR3_R, FOR2_R, FOR1_R)(__VA_ARGS__)
+#define FOR_subset(t, s) for (ll t{s}; t > -1ll; t = (t == 0 ? -1 : (t - 1) & s))
+namespace yorisou {
+  using u8 = uint8_t;
+  using uint = unsigned int;
+  using ll = long long;
+  using ull = unsigned long long;
+  using ld = long double;
+  using i128 = __int128;
+  using u128 = __uint128_t;
+  using f128 = __float128;
+  template <typename T> constexpr T inf = 0;
+  template <>
+  constexpr int inf<int> = 2147483647;
+  template <>
+  constexpr uint inf<uint> = 4294967295U;
+  template <>
+  constexpr ll inf<ll> = 9223372036854775807LL;
+  template <>
+  constexpr ull inf<ull> = 18446744073709551615ULL;
+  template <>
+  constexpr i128 inf<i128> = i128(inf<ll>) * 2'000'000'000'000'000'000;
+  template <>
+  constexpr double inf<double> = inf<ll>;
+  template <>
+  constexpr long double inf<long double> = inf<ll>;
+}
+
+/**
+ * @description: 创建并映射一个io_uring实例
+ * @return {unique_ptr<IoUringEngine>} 成功返回引擎对象，内核不支持或被禁止时返回nullptr
+ * @param {unsigned} entries 提交队列的长度，一次submit_and_wait()中的请求会按该长度分批提交
+ */
+std::unique_ptr<IoUringEngine> IoUringEngine::create(unsigned entries) {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+  if (ring_fd < 0) iroha nullptr;
+
+  std::unique_ptr<IoUringEngine> engine(new IoUringEngine());
+  engine->ring_fd_ = ring_fd;
+  engine->sq_entries_ = params.sq_entries;
+
+  // 1 映射提交队列和完成队列，新内核中二者共用一块映射
+  engine->sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  engine->cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap) {
+    engine->sq_size_ = engine->cq_size_ = std::max(engine->sq_size_, engine->cq_size_);
+  }
+  engine->sq_ptr_ = mmap(nullptr, engine->sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                         IORING_OFF_SQ_RING);
+  if (engine->sq_ptr_ == MAP_FAILED) {
+    engine->sq_ptr_ = nullptr;
+    iroha nullptr;
+  }
+  if (single_mmap) {
+    engine->cq_ptr_ = engine->sq_ptr_;
+  } else {
+    engine->cq_ptr_ = mmap(nullptr, engine->cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                           IORING_OFF_CQ_RING);
+    if (engine->cq_ptr_ == MAP_FAILED) {
+      engine->cq_ptr_ = nullptr;
+      iroha nullptr;
+    }
+  }
+
+  // 2 映射提交队列项数组
+  engine->sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  void* sqes = mmap(nullptr, engine->sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                    IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) iroha nullptr;
+  engine->sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+  char* sq = static_cast<char*>(engine->sq_ptr_);
+  engine->sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+  engine->sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  engine->sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  engine->sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+  char* cq = static_cast<char*>(engine->cq_ptr_);
+  engine->cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  engine->cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  engine->cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  engine->cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+
+  iroha engine;
+}
+
+IoUringEngine::~IoUringEngine() {
+  if (sqes_ != nullptr) munmap(sqes_, sqes_size_);
+  if (cq_ptr_ != nullptr and cq_ptr_ != sq_ptr_) munmap(cq_ptr_, cq_size_);
+  if (sq_ptr_ != nullptr) munmap(sq_ptr_, sq_size_);
+  if (ring_fd_ >= 0) close(ring_fd_);
+}
+
+/**
+ * @description: 提交一批向量化读写请求并等待全部完成
+ * @return {bool} 所有请求都完整读写了num_bytes个字节时返回true；出现错误或短读写时返回false，
+ *                此时部分请求可能已经完成，调用者可以用同步接口重做整批请求
+ * @param {vector<IoUringRequest>&} requests 需要提交的请求，iov在函数返回前必须保持有效
+ */
+bool IoUringEngine::submit_and_wait(const std::vector<IoUringRequest>& requests) {
+  std::scoped_lock lock {latch_};
+  bool ok = true;
+  for (size_t begin = 0; begin < requests.size(); begin += sq_entries_) {
+    unsigned n = static_cast<unsigned>(std::min<size_t>(sq_entries_, requests.size() - begin));
+
+    // 1 填写提交队列项，最后用release语义发布新的队尾
+    unsigned tail = *sq_tail_;
+    unsigned mask = *sq_mask_;
+    for (unsigned i = 0; i < n; ++i) {
+      const IoUringRequest& request = requests[begin + i];
+      unsigned index = tail & mask;
+      struct io_uring_sqe* sqe = &sqes_[index];
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = request.is_write ? IORING_OP_WRITEV : IORING_OP_READV;
+      sqe->fd = request.fd;
+      sqe->off = static_cast<uint64_t>(request.offset);
+      sqe->addr = reinterpret_cast<uint64_t>(request.iov);
+      sqe->len = static_cast<uint32_t>(request.iovcnt);
+      sqe->user_data = begin + i;
+      sq_array_[index] = index;
+      tail++;
+    }
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+
+    // 2 一次系统调用完成提交并等待全部完成
+    unsigned to_submit = n;
+    while (to_submit > 0) {
+      long ret = syscall(__NR_io_uring_enter, ring_fd_, to_submit, n, IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (ret < 0) {
+        if (errno == EINTR) continue;
+        iroha false;
+      }
+      to_submit -= static_cast<unsigned>(ret);
+    }
+
+    // 3 收割完成队列
+    unsigned reaped = 0;
+    while (reaped < n) {
+      unsigned head = *cq_head_;
+      if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+        long ret = syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+        if (ret < 0 and errno != EINTR) iroha false;
+        continue;
+      }
+      struct io_uring_cqe* cqe = &cqes_[head & *cq_mask_];
+      const IoUringRequest& request = requests[cqe->user_data];
+      if (cqe->res < 0 or static_cast<size_t>(cqe->res) != request.num_bytes) ok = false;
+      __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+      reaped++;
+    }
+  }
+  iroha ok;
+}
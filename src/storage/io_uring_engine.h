@@ -0,0 +1,67 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <sys/uio.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @description: 一次向量化读写请求，对应io_uring中的一个IORING_OP_READV/IORING_OP_WRITEV
+ */
+struct IoUringRequest {
+    int fd;
+    bool is_write;
+    off_t offset;
+    const struct iovec *iov;
+    int iovcnt;
+    size_t num_bytes;  // 期望读写的字节数，用于检查短读写
+};
+
+/**
+ * @description: 基于io_uring的批量磁盘I/O引擎，直接使用io_uring_setup/io_uring_enter系统调用，不依赖liburing。
+ * 一批请求一次性放入提交队列，再从完成队列中收割结果，提交与等待之间不需要逐个系统调用。
+ * 内核不支持io_uring时create()返回nullptr，由调用者回退到同步的preadv/pwritev
+ */
+class IoUringEngine {
+   public:
+    static std::unique_ptr<IoUringEngine> create(unsigned entries);
+
+    ~IoUringEngine();
+
+    bool submit_and_wait(const std::vector<IoUringRequest> &requests);
+
+   private:
+    IoUringEngine() = default;
+
+    int ring_fd_ = -1;
+    unsigned sq_entries_ = 0;
+
+    void *sq_ptr_ = nullptr;
+    size_t sq_size_ = 0;
+    void *cq_ptr_ = nullptr;
+    size_t cq_size_ = 0;
+    struct io_uring_sqe *sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+
+    unsigned *sq_head_ = nullptr;
+    unsigned *sq_tail_ = nullptr;
+    unsigned *sq_mask_ = nullptr;
+    unsigned *sq_array_ = nullptr;
+    unsigned *cq_head_ = nullptr;
+    unsigned *cq_tail_ = nullptr;
+    unsigned *cq_mask_ = nullptr;
+    struct io_uring_cqe *cqes_ = nullptr;
+
+    std::mutex latch_;  // 提交队列和完成队列只能被一个线程同时使用
+};
@@ -10,6 +10,12 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <shared_mutex>
+
 #include "common/config.h"
 
 /**
@@ -30,13 +36,23 @@ struct PageId {
     }
 
     inline int64_t Get() const {
-        return (static_cast<int64_t>(fd << 16) | page_no);
+        return static_cast<int64_t>((static_cast<uint64_t>(static_cast<uint32_t>(fd)) << 32) |
+                                    static_cast<uint32_t>(page_no));
     }
 };
 
-// PageId的自定义哈希算法, 用于构建unordered_map<PageId, frame_id_t, PageIdHash>
+// PageId的自定义哈希算法, 用于构建unordered_map<PageId, frame_id_t, PageIdHash>和缓冲池的页表
+// 将fd和page_no拼接为64位整数后用MurmurHash3的fmix64打散，高位和低位都分布均匀
 struct PageIdHash {
-    size_t operator()(const PageId &x) const { return (x.fd << 16) | x.page_no; }
+    size_t operator()(const PageId &x) const {
+        uint64_t h = static_cast<uint64_t>(x.Get());
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
 };
 
 template <>
@@ -53,7 +69,7 @@ class Page {
 
    public:
     
-    Page() { reset_memory(); }
+    Page() = default;
 
     ~Page() = default;
 
@@ -71,6 +87,15 @@ class Page {
 
     inline void set_page_lsn(lsn_t page_lsn) { memcpy(get_data() + OFFSET_LSN, &page_lsn, sizeof(lsn_t)); }
 
+    /* 页面读写锁，由持有pin的上层调用者使用，保护data_中的内容，与缓冲池内部的锁相互独立 */
+    void read_latch() { rwlatch_.lock_shared(); }
+
+    void read_unlatch() { rwlatch_.unlock_shared(); }
+
+    void write_latch() { rwlatch_.lock(); }
+
+    void write_unlatch() { rwlatch_.unlock(); }
+
    private:
     void reset_memory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }  // 将data_的PAGE_SIZE个字节填充为0
 
@@ -78,13 +103,55 @@ class Page {
     PageId id_;
 
     /** The actual data that is stored within a page.
-     *  该页面在bufferPool中的偏移地址
+     *  该页面在bufferPool中的偏移地址，指向BufferPoolManager帧数据区中按PAGE_SIZE对齐的一帧
      */
-    char data_[PAGE_SIZE] = {};
+    char *data_ = nullptr;
 
     /** 脏页判断 */
     bool is_dirty_ = false;
 
-    /** The pin count of this page. */
-    int pin_count_ = 0;
+    /** 所在分片中同一文件的脏页组成侵入式双向链表，这里是链表中前后两个脏页的帧号，只在分片锁内修改 */
+    frame_id_t dirty_prev_ = INVALID_FRAME_ID;
+    frame_id_t dirty_next_ = INVALID_FRAME_ID;
+
+    /** 页面由预读载入且尚未被访问过，第一次被访问时用于延续顺序访问的检测 */
+    bool prefetched_ = false;
+
+    /** The pin count of this page.
+     *  从0变为正数只能在分片锁内进行，已被固定的页面可以不加锁地原子递增 */
+    std::atomic<int> pin_count_ = 0;
+
+    /** 页面读写锁 */
+    std::shared_mutex rwlatch_;
+
+    /** 帧正在进行磁盘读写时为true，此时data_中的内容尚不可用，访问者需在io_cv_上等待 */
+    std::atomic<bool> io_in_progress_ = false;
+    std::mutex io_mutex_;
+    std::condition_variable io_cv_;
+
+    /** 标记帧开始磁盘I/O，调用者需持有帧所在分片的锁 */
+    void start_io() {
+        std::scoped_lock lock{io_mutex_};
+        io_in_progress_ = true;
+    }
+
+    /** 标记帧的磁盘I/O完成，唤醒所有等待该帧的访问者 */
+    void finish_io() {
+        {
+            std::scoped_lock lock{io_mutex_};
+            io_in_progress_ = false;
+        }
+        io_cv_.notify_all();
+    }
+
+    /** 等待帧的磁盘I/O完成，返回是否真的发生了等待 */
+    bool wait_io() {
+        if (!io_in_progress_.load(std::memory_order_acquire)) return false;
+        std::unique_lock lock{io_mutex_};
+        if (!io_in_progress_) return false;
+        io_cv_.wait(lock, [this] { return !io_in_progress_; });
+        return true;
+    }
+
+    bool is_io_in_progress() { return io_in_progress_.load(std::memory_order_acquire); }
 };
\ No newline at end of file
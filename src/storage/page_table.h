@@ -0,0 +1,184 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "common/config.h"
+#include "page.h"
+
+/**
+ * @description: 缓冲池分片的页表，PageId到帧号的开放定址哈希表(线性探测)。
+ * 槽位连续存放在一个数组中，容量为2的幂且不小于帧个数的两倍，创建后不再扩容，查找和修改都不需要分配内存。
+ * 修改操作由调用者持有分片锁串行化，并在修改前后各递增一次版本号；查找既可以在分片锁内调用find()，
+ * 也可以不加锁地调用find_optimistic()，比较查找前后的版本号来判断结果是否有效(seqlock)。
+ */
+class PageTable {
+   public:
+    PageTable() = default;
+
+    /**
+     * @description: 按帧个数分配槽位，清空页表
+     * @param {size_t} num_frames 页表最多容纳的页面个数
+     */
+    void init(size_t num_frames) {
+        size_t capacity = 2;
+        while (capacity < 2 * num_frames) capacity <<= 1;
+        slots_.reset(new Slot[capacity]);
+        mask_ = capacity - 1;
+        shift_ = 64;
+        for (size_t c = capacity; c > 1; c >>= 1) shift_--;
+        size_ = 0;
+    }
+
+    size_t size() const { return size_; }
+
+    size_t count(const PageId &page_id) const { return find(page_id) != INVALID_FRAME_ID; }
+
+    /**
+     * @description: 查找页面所在的帧，调用者需持有分片锁
+     * @return {frame_id_t} 页面所在的帧号，不在页表中时返回INVALID_FRAME_ID
+     */
+    frame_id_t find(const PageId &page_id) const {
+        uint64_t key = make_key(page_id);
+        for (size_t i = bucket(page_id);; i = (i + 1) & mask_) {
+            uint64_t slot_key = slots_[i].key_.load(std::memory_order_relaxed);
+            if (slot_key == key) return slots_[i].frame_id_.load(std::memory_order_relaxed);
+            if (slot_key == EMPTY_KEY) return INVALID_FRAME_ID;
+        }
+    }
+
+    /**
+     * @description: 不加锁地查找页面所在的帧
+     * @return {bool} 查找期间页表没有被修改则返回true，此时*frame_id有效；否则返回false，调用者应加锁重试
+     * @param {PageId&} page_id 目标页面
+     * @param {uint64_t*} version 传出参数，查找时的版本号，之后可以用validate()判断页表是否被修改过
+     * @param {frame_id_t*} frame_id 传出参数，页面所在的帧号，不在页表中时为INVALID_FRAME_ID
+     */
+    bool find_optimistic(const PageId &page_id, uint64_t *version, frame_id_t *frame_id) const {
+        *version = version_.load(std::memory_order_acquire);
+        if (*version & 1) return false;
+        uint64_t key = make_key(page_id);
+        *frame_id = INVALID_FRAME_ID;
+        // 修改过程中探测序列可能不以空槽结束，最多探测一圈
+        for (size_t i = bucket(page_id), n = 0; n <= mask_; i = (i + 1) & mask_, ++n) {
+            uint64_t slot_key = slots_[i].key_.load(std::memory_order_relaxed);
+            if (slot_key == key) {
+                *frame_id = slots_[i].frame_id_.load(std::memory_order_relaxed);
+                break;
+            }
+            if (slot_key == EMPTY_KEY) break;
+        }
+        return validate(*version);
+    }
+
+    /**
+     * @description: 判断自find_optimistic()返回version以来页表是否没有被修改过
+     */
+    bool validate(uint64_t version) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return version_.load(std::memory_order_relaxed) == version;
+    }
+
+    /**
+     * @description: 登记页面所在的帧，页面已存在时更新其帧号，调用者需持有分片锁
+     */
+    void insert(const PageId &page_id, frame_id_t frame_id) {
+        uint64_t key = make_key(page_id);
+        size_t i = bucket(page_id);
+        while (true) {
+            uint64_t slot_key = slots_[i].key_.load(std::memory_order_relaxed);
+            if (slot_key == key || slot_key == EMPTY_KEY) break;
+            i = (i + 1) & mask_;
+        }
+        begin_write();
+        if (slots_[i].key_.load(std::memory_order_relaxed) == EMPTY_KEY) size_++;
+        slots_[i].frame_id_.store(frame_id, std::memory_order_relaxed);
+        slots_[i].key_.store(key, std::memory_order_relaxed);
+        end_write();
+    }
+
+    /**
+     * @description: 移除页面，之后的槽位向前移动填补空位(backward shift)，不使用墓碑，调用者需持有分片锁
+     */
+    void erase(const PageId &page_id) {
+        uint64_t key = make_key(page_id);
+        size_t i = bucket(page_id);
+        while (true) {
+            uint64_t slot_key = slots_[i].key_.load(std::memory_order_relaxed);
+            if (slot_key == key) break;
+            if (slot_key == EMPTY_KEY) return;
+            i = (i + 1) & mask_;
+        }
+        begin_write();
+        for (size_t j = (i + 1) & mask_;; j = (j + 1) & mask_) {
+            uint64_t slot_key = slots_[j].key_.load(std::memory_order_relaxed);
+            if (slot_key == EMPTY_KEY) break;
+            // 槽位j的理想位置home不在(i, j]之间时，可以移动到空位i
+            size_t home = bucket(slot_key);
+            if (((j - home) & mask_) >= ((j - i) & mask_)) {
+                slots_[i].frame_id_.store(slots_[j].frame_id_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                slots_[i].key_.store(slot_key, std::memory_order_relaxed);
+                i = j;
+            }
+        }
+        slots_[i].key_.store(EMPTY_KEY, std::memory_order_relaxed);
+        slots_[i].frame_id_.store(INVALID_FRAME_ID, std::memory_order_relaxed);
+        size_--;
+        end_write();
+    }
+
+    /**
+     * @description: 遍历页表中的所有页面，调用者需持有分片锁
+     * @param {F&&} f 对每个页面调用f(PageId, frame_id_t)
+     */
+    template <typename F>
+    void for_each(F &&f) const {
+        for (size_t i = 0; i <= mask_; ++i) {
+            uint64_t slot_key = slots_[i].key_.load(std::memory_order_relaxed);
+            if (slot_key == EMPTY_KEY) continue;
+            f(PageId{static_cast<int>(slot_key >> 32), static_cast<page_id_t>(slot_key & 0xffffffffULL)},
+              slots_[i].frame_id_.load(std::memory_order_relaxed));
+        }
+    }
+
+   private:
+    /* 槽位为16字节，一个cache line容纳4个槽位 */
+    struct Slot {
+        std::atomic<uint64_t> key_{EMPTY_KEY};
+        std::atomic<frame_id_t> frame_id_{INVALID_FRAME_ID};
+    };
+
+    static constexpr uint64_t EMPTY_KEY = ~0ULL;  // fd和page_no都为-1，不会是有效页面
+
+    static uint64_t make_key(const PageId &page_id) { return static_cast<uint64_t>(page_id.Get()); }
+
+    /* 分片由哈希值的低位选出，页表取高位作为槽位下标，避免同一分片的页面集中在部分槽位 */
+    size_t bucket(const PageId &page_id) const { return PageIdHash()(page_id) >> shift_; }
+
+    size_t bucket(uint64_t key) const {
+        return bucket(PageId{static_cast<int>(key >> 32), static_cast<page_id_t>(key & 0xffffffffULL)});
+    }
+
+    void begin_write() {
+        version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void end_write() { version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_ = 0;
+    int shift_ = 64;
+    size_t size_ = 0;
+    std::atomic<uint64_t> version_{0};  // 奇数表示正在修改
+};
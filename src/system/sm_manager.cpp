@@ -13,7 +13,12 @@ See the Mulan PSL v2 for more details. */
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <climits>
+#include <cstring>
+#include <exception>
 #include <fstream>
+#include <functional>
+#include <thread>
 
 #include "index/ix.h"
 #include "record/rm.h"
@@ -85,7 +90,24 @@ void SmManager::drop_db(const std::string& db_name) {
  * @param {string&} db_name 数据库名称，与文件夹同名
  */
 void SmManager::open_db(const std::string& db_name) {
-    
+    if (!is_dir(db_name)) {
+        throw DatabaseNotFoundError(db_name);
+    }
+    if (chdir(db_name.c_str()) < 0) {
+        throw UnixError();
+    }
+    std::ifstream ifs(DB_META_NAME);
+    ifs >> db_;
+    for (auto &entry : db_.tabs_) {
+        auto &tab = entry.second;
+        fhs_.emplace(tab.name, rm_manager_->open_file(tab.name));
+        for (auto &index : tab.indexes) {
+            ihs_.emplace(ix_manager_->get_index_name(tab.name, index.cols), ix_manager_->open_index(tab.name, index.cols));
+        }
+    }
+    if (warm_restart_) {
+        load_buffer_pool();
+    }
 }
 
 /**
@@ -101,7 +123,70 @@ void SmManager::flush_meta() {
  * @description: 关闭数据库并把数据落盘
  */
 void SmManager::close_db() {
-    
+    if (warm_restart_) {
+        dump_buffer_pool();
+    }
+    flush_meta();
+    for (auto &entry : fhs_) {
+        rm_manager_->close_file(entry.second.get());
+    }
+    for (auto &entry : ihs_) {
+        ix_manager_->close_index(entry.second.get());
+    }
+    fhs_.clear();
+    ihs_.clear();
+    db_.name_.clear();
+    db_.tabs_.clear();
+    if (chdir("..") < 0) {
+        throw UnixError();
+    }
+}
+
+/**
+ * @description: 把缓冲池中属于当前数据库表和索引的页面记录到BUFFER_POOL_DUMP_NAME中，
+ *               每行为"文件名 页号"，文件句柄在重启后会变化，因此记录文件名
+ */
+void SmManager::dump_buffer_pool() {
+    std::unordered_map<int, std::string> fd2name;
+    for (auto &entry : fhs_) {
+        fd2name[entry.second->GetFd()] = entry.first;
+    }
+    for (auto &entry : ihs_) {
+        fd2name[entry.second->get_fd()] = entry.first;
+    }
+    std::ofstream ofs(BUFFER_POOL_DUMP_NAME);
+    for (auto &page_id : buffer_pool_manager_->get_resident_pages()) {
+        auto it = fd2name.find(page_id.fd);
+        if (it != fd2name.end()) {
+            ofs << it->second << " " << page_id.page_no << "\n";
+        }
+    }
+}
+
+/**
+ * @description: 读取上次关闭时记录的页面，交给缓冲池在后台按文件和页号顺序预读，不阻塞数据库的打开
+ */
+void SmManager::load_buffer_pool() {
+    std::ifstream ifs(BUFFER_POOL_DUMP_NAME);
+    if (!ifs) {
+        return;
+    }
+    std::vector<PageId> page_ids;
+    std::string name;
+    page_id_t page_no;
+    size_t limit = buffer_pool_manager_->get_pool_size();
+    while (page_ids.size() < limit && ifs >> name >> page_no) {
+        int fd;
+        if (fhs_.count(name)) {
+            fd = fhs_[name]->GetFd();
+        } else if (ihs_.count(name)) {
+            fd = ihs_[name]->get_fd();
+        } else {
+            continue;  // 表或索引已被删除
+        }
+        page_ids.push_back(PageId{fd, page_no});
+    }
+    buffer_pool_manager_->warm_up(std::move(page_ids));
 }
 
 /**
@@ -125,6 +210,103 @@ void SmManager::show_tables(Context* context) {
     outfile.close();
 }
 
+/**
+ * @description: 显示缓冲池和磁盘I/O的统计信息，以及每张表和每个索引驻留在缓冲池中的页面个数
+ * @param {Context*} context 
+ */
+void SmManager::show_buffer_stats(Context* context) {
+    BufferPoolStats stats = buffer_pool_manager_->get_stats();
+    const DiskIOStats &io = disk_manager_->get_io_stats();
+    size_t accesses = stats.hits_ + stats.misses_;
+    char hit_ratio[32];
+    snprintf(hit_ratio, sizeof(hit_ratio), "%.4f", accesses == 0 ? 0.0 : static_cast<double>(stats.hits_) / accesses);
+    std::vector<std::pair<std::string, std::string>> metrics = {
+        {"pool_size", std::to_string(stats.pool_size_)},
+        {"shards", std::to_string(stats.num_shards_)},
+        {"resident_pages", std::to_string(stats.resident_pages_)},
+        {"dirty_pages", std::to_string(stats.dirty_pages_)},
+        {"pinned_pages", std::to_string(stats.pinned_pages_)},
+        {"hits", std::to_string(stats.hits_)},
+        {"misses", std::to_string(stats.misses_)},
+        {"hit_ratio", hit_ratio},
+        {"evictions", std::to_string(stats.evictions_)},
+        {"io_waits", std::to_string(stats.io_waits_)},
+        {"fg_writes", std::to_string(stats.foreground_writes_)},
+        {"bg_writes", std::to_string(stats.background_writes_)},
+        {"prefetched", std::to_string(stats.prefetched_pages_)},
+        {"disk_reads", std::to_string(io.reads_.load())},
+        {"disk_writes", std::to_string(io.writes_.load())},
+        {"bytes_read", std::to_string(io.bytes_read_.load())},
+        {"bytes_written", std::to_string(io.bytes_written_.load())},
+    };
+    // 只输出非空的延迟桶，如read<4us表示耗时在[2us, 4us)内的读
+    for (int is_write = 0; is_write < 2; is_write++) {
+        for (int i = 0; i < DiskIOStats::LATENCY_BUCKETS; i++) {
+            uint64_t count = (is_write ? io.write_latency_ : io.read_latency_)[i].load();
+            if (count == 0) continue;
+            std::string name = is_write ? "write" : "read";
+            if (i == DiskIOStats::LATENCY_BUCKETS - 1) {
+                name += ">=" + std::to_string(1ull << (i - 1)) + "us";
+            } else {
+                name += "<" + std::to_string(1ull << i) + "us";
+            }
+            metrics.emplace_back(name, std::to_string(count));
+        }
+    }
+
+    RecordPrinter printer(2);
+    printer.print_separator(context);
+    printer.print_record({"Metric", "Value"}, context);
+    printer.print_separator(context);
+    for (auto &metric : metrics) {
+        printer.print_record({metric.first, metric.second}, context);
+    }
+    printer.print_separator(context);
+
+    // 各表和索引的驻留情况
+    RecordPrinter file_printer(3);
+    file_printer.print_separator(context);
+    file_printer.print_record({"File", "Resident", "Dirty"}, context);
+    file_printer.print_separator(context);
+    auto residency = buffer_pool_manager_->get_file_residency();
+    auto print_file = [&](const std::string &name, int fd) {
+        FileResidency &file = residency[fd];
+        file_printer.print_record({name, std::to_string(file.resident_pages_), std::to_string(file.dirty_pages_)},
+                                  context);
+    };
+    for (auto &entry : fhs_) {
+        print_file(entry.first, entry.second->GetFd());
+    }
+    for (auto &entry : ihs_) {
+        print_file(entry.first, entry.second->get_fd());
+    }
+    file_printer.print_separator(context);
+}
+
+/**
+ * @description: 在线调整缓冲池的帧个数并输出调整后的大小。缩小时遇到被固定的帧会提前停止，
+ *               此时输出的pool_size大于目标值，可以稍后重试
+ * @param {int} pool_size 目标帧个数，范围为[分片个数, 启动时-B指定的最大帧个数]
+ * @param {Context*} context
+ */
+void SmManager::set_buffer_pool_size(int pool_size, Context* context) {
+    size_t min_size = buffer_pool_manager_->get_num_shards();
+    size_t max_size = buffer_pool_manager_->get_max_pool_size();
+    if (pool_size < 0 || static_cast<size_t>(pool_size) < min_size || static_cast<size_t>(pool_size) > max_size) {
+        throw InternalError("Buffer pool size must be between " + std::to_string(min_size) + " and " +
+                            std::to_string(max_size) + " frames");
+    }
+    buffer_pool_manager_->resize(pool_size);
+
+    RecordPrinter printer(2);
+    printer.print_separator(context);
+    printer.print_record({"Metric", "Value"}, context);
+    printer.print_separator(context);
+    printer.print_record({"pool_size", std::to_string(buffer_pool_manager_->get_pool_size())}, context);
+    printer.print_record({"max_pool_size", std::to_string(max_size)}, context);
+    printer.print_separator(context);
+}
+
 /**
  * @description: 显示表的元数据
  * @param {string&} tab_name 表名称
@@ -192,13 +374,60 @@ void SmManager::drop_table(const std::string& tab_name, Context* context) {
 }
 
 /**
- * @description: 创建索引
+ * @description: 创建索引。经私有帧环扫描表中所有记录，(key, rid)经外部排序后自底向上批量构建B+树，
+ * 不逐条调用insert_entry()；构建失败(如出现重复key)时删除索引文件
  * @param {string&} tab_name 表的名称
  * @param {vector<string>&} col_names 索引包含的字段名称
  * @param {Context*} context
  */
 void SmManager::create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context) {
-    
+    TabMeta& tab = db_.get_table(tab_name);
+    if (tab.is_index(col_names)) {
+        throw IndexExistsError(tab_name, col_names);
+    }
+    std::vector<ColMeta> cols;
+    std::vector<ColType> col_types;
+    std::vector<int> col_lens;
+    int col_tot_len = 0;
+    for (auto& col_name : col_names) {
+        cols.push_back(*tab.get_col(col_name));
+        col_types.push_back(cols.back().type);
+        col_lens.push_back(cols.back().len);
+        col_tot_len += cols.back().len;
+    }
+    std::string index_name = ix_manager_->get_index_name(tab_name, cols);
+    ix_manager_->create_index(tab_name, cols);
+    auto ih = ix_manager_->open_index(tab_name, cols);
+    try {
+        IxSorter sorter(col_types, col_lens, index_name + ".sort", IX_SORT_BUFFER_SIZE);
+        std::vector<char> key(col_tot_len);
+        // 全表扫描只在私有帧环内替换页面，不把整张表刷进缓冲池
+        auto ring = buffer_pool_manager_->make_ring();
+        for (RmScan scan(fhs_.at(tab_name).get(), ring.get()); !scan.is_end(); scan.next()) {
+            RmRecordView rec = scan.record_view();
+            int offset = 0;
+            for (auto& col : cols) {
+                memcpy(key.data() + offset, rec.data + col.offset, col.len);
+                offset += col.len;
+            }
+            sorter.add(key.data(), scan.rid());
+        }
+        sorter.finish();
+        ih->bulk_build(&sorter);
+    } catch (...) {
+        ix_manager_->close_index(ih.get());
+        ix_manager_->destroy_index(tab_name, cols);
+        throw;
+    }
+
+    IndexMeta index = {.tab_name = tab_name, .col_tot_len = col_tot_len, .col_num = static_cast<int>(cols.size()),
+                       .cols = cols};
+    tab.indexes.push_back(index);
+    for (auto& col : cols) {
+        tab.get_col(col.name)->index = true;
+    }
+    ihs_.emplace(index_name, std::move(ih));
+    flush_meta();
 }
 
 /**
@@ -219,4 +448,311 @@ void SmManager::drop_index(const std::string& tab_name, const std::vector<std::s
  */
 void SmManager::drop_index(const std::string& tab_name, const std::vector<ColMeta>& cols, Context* context) {
     
-}
\ No newline at end of file
+}
+
+/**
+ * @description: 把csv中的一个字段转换为对应字段类型的二进制值，写入记录中该字段的位置
+ * @param {char*} begin 字段的起始位置
+ * @param {char*} end 字段的结束位置
+ * @param {ColMeta&} col 字段元数据
+ * @param {char*} dst 记录中该字段的起始地址，调用者已将记录清零
+ */
+static void parse_csv_field(const char* begin, const char* end, const ColMeta& col, char* dst) {
+    size_t len = end - begin;
+    if (col.type == TYPE_STRING) {
+        if (len > static_cast<size_t>(col.len)) {
+            throw StringOverflowError();
+        }
+        memcpy(dst, begin, len);
+        return;
+    }
+    // 数值字段拷贝到以'\0'结尾的缓冲区后用strtol/strtof解析，允许首尾空白
+    char num[64];
+    while (len > 0 && isspace(static_cast<unsigned char>(begin[len - 1]))) len--;
+    if (len == 0 || len >= sizeof(num)) {
+        throw IncompatibleTypeError(coltype2str(col.type), coltype2str(TYPE_STRING));
+    }
+    memcpy(num, begin, len);
+    num[len] = '\0';
+    char* num_end;
+    errno = 0;
+    if (col.type == TYPE_INT) {
+        long val = strtol(num, &num_end, 10);
+        if (*num_end != '\0' || errno == ERANGE || val < INT_MIN || val > INT_MAX) {
+            throw IncompatibleTypeError(coltype2str(col.type), coltype2str(TYPE_STRING));
+        }
+        int int_val = static_cast<int>(val);
+        memcpy(dst, &int_val, sizeof(int));
+    } else {
+        float float_val = strtof(num, &num_end);
+        if (*num_end != '\0' || errno == ERANGE) {
+            throw IncompatibleTypeError(coltype2str(col.type), coltype2str(TYPE_STRING));
+        }
+        memcpy(dst, &float_val, sizeof(float));
+    }
+}
+
+/**
+ * @description: 解析csv中的一行，按表的字段顺序写入一条记录。
+ * 字段以','分隔，可以用双引号包围，引号内的'"'写作'""'；不支持引号内换行
+ * @param {char*} begin 行的起始位置
+ * @param {char*} end 行的结束位置，不包含'\n'
+ * @param {TabMeta&} tab 表的元数据
+ * @param {char*} rec 记录的起始地址，调用者已将记录清零
+ */
+static void parse_csv_line(const char* begin, const char* end, const TabMeta& tab, char* rec) {
+    if (end > begin && end[-1] == '\r') end--;
+    const char* p = begin;
+    std::string unquoted;
+    for (size_t i = 0; i < tab.cols.size(); i++) {
+        if (i > 0) {
+            if (p == end || *p != ',') {
+                throw InvalidValueCountError();
+            }
+            p++;
+        }
+        const char* field_begin = p;
+        const char* field_end;
+        if (p != end && *p == '"') {
+            unquoted.clear();
+            for (p++;; p++) {
+                if (p == end) {
+                    throw InternalError("Unterminated quoted field in csv");
+                }
+                if (*p == '"') {
+                    if (p + 1 == end || p[1] != '"') break;
+                    p++;
+                }
+                unquoted.push_back(*p);
+            }
+            p++;
+            field_begin = unquoted.data();
+            field_end = field_begin + unquoted.size();
+        } else {
+            while (p != end && *p != ',') p++;
+            field_end = p;
+        }
+        parse_csv_field(field_begin, field_end, tab.cols[i], rec + tab.cols[i].offset);
+    }
+    if (p != end) {
+        throw InvalidValueCountError();
+    }
+}
+
+/**
+ * @description: 判断csv的第一行是否为表头，即第一个字段等于表的第一个字段名称(不区分大小写)
+ */
+static bool is_csv_header(const char* begin, const char* end, const TabMeta& tab) {
+    const char* field_end = begin;
+    while (field_end != end && *field_end != ',' && *field_end != '\n' && *field_end != '\r') field_end++;
+    std::string field(begin, field_end);
+    if (field.size() >= 2 && field.front() == '"' && field.back() == '"') {
+        field = field.substr(1, field.size() - 2);
+    }
+    return !tab.cols.empty() && strcasecmp(field.c_str(), tab.cols[0].name.c_str()) == 0;
+}
+
+/* 一个解析线程负责的csv片段，解析结果为连续存放的记录 */
+struct CsvChunk {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    std::vector<char> records;
+    int num_records = 0;
+    std::exception_ptr error;
+};
+
+/**
+ * @description: 逐行解析csv片段，跳过空行；异常保存在chunk->error中，由调用线程重新抛出
+ */
+static void parse_csv_chunk(CsvChunk* chunk, const TabMeta& tab, int record_size) {
+    try {
+        const char* p = chunk->begin;
+        while (p < chunk->end) {
+            const char* eol = static_cast<const char*>(memchr(p, '\n', chunk->end - p));
+            if (eol == nullptr) eol = chunk->end;
+            if (eol != p && !(eol - p == 1 && *p == '\r')) {
+                size_t off = chunk->records.size();
+                chunk->records.resize(off + record_size);
+                parse_csv_line(p, eol, tab, chunk->records.data() + off);
+                chunk->num_records++;
+            }
+            p = eol + 1;
+        }
+    } catch (...) {
+        chunk->error = std::current_exception();
+    }
+}
+
+/**
+ * @description: 从头读入csv文件，按LOAD_DATA_BLOCK_SIZE分块，每块在行边界处切成多个片段由多个线程并行解析，
+ * 按文件顺序把解析好的片段交给consume；第一行是表头时跳过。任一片段解析失败时抛出异常，该块不会交给consume
+ * @param {ifstream&} ifs 以二进制方式打开的csv文件
+ * @param {TabMeta&} tab 表的元数据
+ * @param {int} record_size 记录的长度
+ * @param {function} consume 处理一个解析好的片段
+ */
+static void scan_csv(std::ifstream& ifs, const TabMeta& tab, int record_size,
+                     const std::function<void(CsvChunk&)>& consume) {
+    const int num_threads =
+        std::max(1, std::min(LOAD_DATA_THREADS, static_cast<int>(std::thread::hardware_concurrency())));
+    ifs.clear();
+    ifs.seekg(0);
+    std::vector<char> block;
+    size_t carry = 0;  // 上一块末尾不完整的行，已移动到block开头
+    bool first_block = true;
+    while (true) {
+        block.resize(carry + LOAD_DATA_BLOCK_SIZE);
+        ifs.read(block.data() + carry, LOAD_DATA_BLOCK_SIZE);
+        const size_t size = carry + static_cast<size_t>(ifs.gcount());
+        const bool eof = ifs.gcount() < LOAD_DATA_BLOCK_SIZE;
+        // 本轮只解析到最后一个完整的行
+        size_t parse_end = size;
+        if (!eof) {
+            const char* last = static_cast<const char*>(memrchr(block.data(), '\n', size));
+            parse_end = last == nullptr ? 0 : last - block.data() + 1;
+        }
+        const char* begin = block.data();
+        const char* end = begin + parse_end;
+        if (first_block && parse_end > 0) {
+            first_block = false;
+            if (is_csv_header(begin, end, tab)) {
+                const char* eol = static_cast<const char*>(memchr(begin, '\n', end - begin));
+                begin = eol == nullptr ? end : eol + 1;
+            }
+        }
+
+        // 在行边界处把[begin, end)切成num_threads个片段
+        std::vector<CsvChunk> chunks(num_threads);
+        const char* p = begin;
+        for (int t = 0; t < num_threads; t++) {
+            chunks[t].begin = p;
+            if (t + 1 < num_threads) {
+                const char* target = p + (end - p) / (num_threads - t);
+                const char* eol = static_cast<const char*>(memchr(target, '\n', end - target));
+                p = eol == nullptr ? end : eol + 1;
+            } else {
+                p = end;
+            }
+            chunks[t].end = p;
+        }
+        std::vector<std::thread> threads;
+        for (int t = 1; t < num_threads; t++) {
+            if (chunks[t].begin != chunks[t].end) {
+                threads.emplace_back(parse_csv_chunk, &chunks[t], std::cref(tab), record_size);
+            }
+        }
+        parse_csv_chunk(&chunks[0], tab, record_size);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (auto& chunk : chunks) {
+            if (chunk.error) {
+                std::rethrow_exception(chunk.error);
+            }
+        }
+        for (auto& chunk : chunks) {
+            if (chunk.num_records > 0) {
+                consume(chunk);
+            }
+        }
+
+        if (eof) break;
+        carry = size - parse_end;
+        memmove(block.data(), block.data() + parse_end, carry);
+    }
+}
+
+/**
+ * @description: 把csv文件批量装载到表中。
+ * 解析出的记录由RmFileHandle::bulk_load_records()直接组装成满页、顺序写盘，不逐条经过insert_record()；
+ * 表上的索引在全部记录写入后建立：key经IxSorter外部排序，空索引直接bulk_build()，非空索引按key顺序插入。
+ * 表上有索引时先完整解析一遍文件，只对key排序并检查是否互相重复或与索引中已有的key重复(IxIndexHandle::has_duplicate())，
+ * 格式错误或重复key在写入任何页面之前抛出异常，表和索引都不变；第二遍重新解析并写入记录。
+ * 表上没有索引时只解析一遍，某一块解析失败时之前的块已经写入。装载不写日志，也不能被事务回滚
+ * @param {string&} file_name csv文件路径，第一行可以是表头
+ * @param {string&} tab_name 表名称
+ * @param {Context*} context
+ */
+void SmManager::load_data(const std::string& file_name, const std::string& tab_name, Context* context) {
+    TabMeta& tab = db_.get_table(tab_name);
+    RmFileHandle* fh = fhs_.at(tab_name).get();
+    std::ifstream ifs(file_name, std::ios::binary);
+    if (!ifs.is_open()) {
+        throw FileNotFoundError(file_name);
+    }
+    const int record_size = fh->get_file_hdr().record_size;
+
+    std::vector<IxIndexHandle*> ihs;
+    for (auto& index : tab.indexes) {
+        ihs.push_back(ihs_.at(ix_manager_->get_index_name(tab_name, index.cols)).get());
+    }
+    // 每个索引用一个IxSorter收集(key, rid)，key按需排序或溢出到临时文件，不在内存中保存全部key
+    auto make_sorters = [&](const std::string& suffix) {
+        std::vector<std::unique_ptr<IxSorter>> sorters;
+        for (auto& index : tab.indexes) {
+            std::vector<ColType> col_types;
+            std::vector<int> col_lens;
+            for (auto& col : index.cols) {
+                col_types.push_back(col.type);
+                col_lens.push_back(col.len);
+            }
+            sorters.push_back(std::make_unique<IxSorter>(
+                col_types, col_lens, ix_manager_->get_index_name(tab_name, index.cols) + suffix, IX_SORT_BUFFER_SIZE));
+        }
+        return sorters;
+    };
+    std::vector<char> key(IX_MAX_COL_LEN);
+    auto add_keys = [&](std::vector<std::unique_ptr<IxSorter>>& sorters, const CsvChunk& chunk, const Rid* rids) {
+        for (size_t i = 0; i < tab.indexes.size(); i++) {
+            for (int r = 0; r < chunk.num_records; r++) {
+                const char* rec = chunk.records.data() + static_cast<size_t>(r) * record_size;
+                int off = 0;
+                for (auto& col : tab.indexes[i].cols) {
+                    memcpy(key.data() + off, rec + col.offset, col.len);
+                    off += col.len;
+                }
+                sorters[i]->add(key.data(), rids == nullptr ? Rid{RM_NO_PAGE, -1} : rids[r]);
+            }
+        }
+    };
+
+    // 第一遍：只检查格式和唯一性，记录还没有位置，rid不参与检查
+    if (!tab.indexes.empty()) {
+        auto sorters = make_sorters(".check");
+        scan_csv(ifs, tab, record_size, [&](CsvChunk& chunk) { add_keys(sorters, chunk, nullptr); });
+        for (size_t i = 0; i < tab.indexes.size(); i++) {
+            sorters[i]->finish();
+            if (ihs[i]->has_duplicate(sorters[i].get())) {
+                throw IndexDuplicateKeyError();
+            }
+            sorters[i].reset();
+        }
+    }
+
+    // 第二遍：按文件顺序写入各片段的记录，并把索引key交给对应的sorter
+    // 第二遍中途失败(如写盘出错)时，之前的块已经写入表中，先为它们建立索引再抛出异常
+    auto sorters = make_sorters(".load");
+    std::exception_ptr error;
+    try {
+        scan_csv(ifs, tab, record_size, [&](CsvChunk& chunk) {
+            std::vector<Rid> rids = fh->bulk_load_records(chunk.records.data(), chunk.num_records);
+            add_keys(sorters, chunk, rids.data());
+        });
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    // 空索引自底向上批量构建，非空索引按key顺序插入，相邻的插入落在同一个叶子结点上
+    for (size_t i = 0; i < tab.indexes.size(); i++) {
+        sorters[i]->finish();
+        if (ihs[i]->can_bulk_build()) {
+            ihs[i]->bulk_build(sorters[i].get());
+        } else if (ihs[i]->insert_sorted(sorters[i].get(), context->txn_) != sorters[i]->size()) {
+            throw IndexDuplicateKeyError();
+        }
+        sorters[i].reset();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
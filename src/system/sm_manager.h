@@ -35,6 +35,7 @@ class SmManager {
     BufferPoolManager* buffer_pool_manager_;
     RmManager* rm_manager_;
     IxManager* ix_manager_;
+    bool warm_restart_ = BUFFER_POOL_WARM_RESTART;  // 关闭时是否记录缓冲池中的页面，打开时据此预热缓冲池
 
    public:
     SmManager(DiskManager* disk_manager, BufferPoolManager* buffer_pool_manager, RmManager* rm_manager,
@@ -64,8 +65,14 @@ class SmManager {
 
     void flush_meta();
 
+    void set_warm_restart(bool warm_restart) { warm_restart_ = warm_restart; }
+
     void show_tables(Context* context);
 
+    void show_buffer_stats(Context* context);
+
+    void set_buffer_pool_size(int pool_size, Context* context);
+
     void desc_table(const std::string& tab_name, Context* context);
 
     void create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context);
@@ -77,4 +84,11 @@ class SmManager {
     void drop_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
     
     void drop_index(const std::string& tab_name, const std::vector<ColMeta>& col_names, Context* context);
+
+    void load_data(const std::string& file_name, const std::string& tab_name, Context* context);
+
+   private:
+    void dump_buffer_pool();
+
+    void load_buffer_pool();
 };
\ No newline at end of file
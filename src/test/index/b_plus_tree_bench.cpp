@@ -0,0 +1,110 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+// B+树的多线程吞吐测试：预先插入num_keys个int key，然后多个线程执行点查，或90%点查+10%插入
+// 缓冲池足够容纳整棵树，测量的是下降路径上加锁和结点内查找的开销
+// 用法: b_plus_tree_bench [num_keys] [ops_per_thread] [max_threads]
+
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "index/ix.h"
+
+const std::string BENCH_DB_NAME = "BPlusTreeBench_db";
+const std::string BENCH_FILE_NAME = "bench_table";
+
+/**
+ * @brief 用num_threads个线程各执行ops_per_thread次操作，insert_percent为插入所占的百分比
+ * 插入的key从next_key开始递增分配，不与已有key重复
+ * @return 每秒完成的操作数
+ */
+double run_bench(IxIndexHandle *ih, int num_keys, int num_threads, int ops_per_thread, int insert_percent,
+                 std::atomic<int> *next_key) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int tid = 0; tid < num_threads; tid++) {
+        threads.emplace_back([=]() {
+            Transaction txn(tid);
+            std::mt19937 rng(tid);
+            std::vector<Rid> rids;
+            for (int i = 0; i < ops_per_thread; i++) {
+                if (static_cast<int>(rng() % 100) < insert_percent) {
+                    int key = next_key->fetch_add(1);
+                    ih->insert_entry(reinterpret_cast<const char *>(&key), Rid{key / 1000, key % 1000}, &txn);
+                } else {
+                    int key = static_cast<int>(rng() % num_keys);
+                    rids.clear();
+                    if (!ih->get_value(reinterpret_cast<const char *>(&key), &rids, &txn)) {
+                        fprintf(stderr, "key %d not found\n", key);
+                        exit(1);
+                    }
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(num_threads) * ops_per_thread / elapsed.count();
+}
+
+int main(int argc, char **argv) {
+    int num_keys = argc > 1 ? atoi(argv[1]) : 1000000;
+    int ops_per_thread = argc > 2 ? atoi(argv[2]) : 200000;
+    int max_threads = argc > 3 ? atoi(argv[3]) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(65536, disk_manager.get());
+    auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
+    if (disk_manager->is_dir(BENCH_DB_NAME)) {
+        disk_manager->destroy_dir(BENCH_DB_NAME);
+    }
+    disk_manager->create_dir(BENCH_DB_NAME);
+    if (chdir(BENCH_DB_NAME.c_str()) < 0) {
+        throw UnixError();
+    }
+
+    std::vector<ColMeta> cols = {{BENCH_FILE_NAME, "id", TYPE_INT, sizeof(int), 0, true}};
+    ix_manager->create_index(BENCH_FILE_NAME, cols);
+    auto ih = ix_manager->open_index(BENCH_FILE_NAME, cols);
+    std::vector<int> keys(num_keys);
+    for (int i = 0; i < num_keys; i++) {
+        keys[i] = i;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+    for (int key : keys) {
+        ih->insert_entry(reinterpret_cast<const char *>(&key), Rid{key / 1000, key % 1000}, nullptr);
+    }
+
+    std::atomic<int> next_key{num_keys};
+    printf("%10s %8s %16s\n", "insert%", "threads", "ops/s");
+    for (int insert_percent : {0, 10}) {
+        for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+            double ops = run_bench(ih.get(), num_keys, num_threads, ops_per_thread, insert_percent, &next_key);
+            printf("%10d %8d %16.0f\n", insert_percent, num_threads, ops);
+        }
+    }
+
+    ix_manager->close_index(ih.get());
+    if (chdir("..") < 0) {
+        throw UnixError();
+    }
+    disk_manager->destroy_dir(BENCH_DB_NAME);
+    return 0;
+}
@@ -0,0 +1,296 @@
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#include "system/sm.h"
+#undef private
+
+#include "record/rm.h"
+#include "storage/buffer_pool_manager.h"
+
+const std::string TEST_DB_NAME = "BPlusTreeBulkBuildTest_db";
+const std::string TEST_FILE_NAME = "table1";
+const std::vector<std::string> TEST_COL = {"col1"};
+
+class BPlusTreeBulkBuildTests : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<RmManager> rm_;
+    std::unique_ptr<SmManager> sm_;
+
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(256, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        rm_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_.get(), ix_manager_.get());
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            disk_manager_->destroy_dir(TEST_DB_NAME);
+        }
+        sm_->create_db(TEST_DB_NAME);
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+        std::vector<ColDef> coldef;
+        coldef.push_back({"col1", TYPE_INT, 4});
+        coldef.push_back({"col2", TYPE_INT, 4});
+        sm_->create_table(TEST_FILE_NAME, coldef, nullptr);
+    }
+
+    void TearDown() override {
+        for (auto &entry : sm_->ihs_) {
+            ix_manager_->close_index(entry.second.get());
+        }
+        sm_->ihs_.clear();
+        for (auto &entry : sm_->fhs_) {
+            rm_->close_file(entry.second.get());
+        }
+        sm_->fhs_.clear();
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+        disk_manager_->destroy_dir(TEST_DB_NAME);
+    }
+
+    /**
+     * @brief 向表中插入num_records条记录，col1为打乱顺序的keys，col2为col1的相反数
+     * @return key到rid的映射，按key排序
+     */
+    std::vector<std::pair<int, Rid>> insert_records(const std::vector<int> &keys) {
+        RmFileHandle *fh = sm_->fhs_.at(TEST_FILE_NAME).get();
+        std::vector<char> buf(keys.size() * 8);
+        for (size_t i = 0; i < keys.size(); i++) {
+            int col2 = -keys[i];
+            memcpy(buf.data() + i * 8, &keys[i], 4);
+            memcpy(buf.data() + i * 8 + 4, &col2, 4);
+        }
+        std::vector<Rid> rids = fh->insert_records(buf.data(), static_cast<int>(keys.size()), nullptr);
+        std::vector<std::pair<int, Rid>> expected;
+        for (size_t i = 0; i < keys.size(); i++) {
+            expected.emplace_back(keys[i], rids[i]);
+        }
+        std::sort(expected.begin(), expected.end(),
+                  [](const std::pair<int, Rid> &a, const std::pair<int, Rid> &b) { return a.first < b.first; });
+        return expected;
+    }
+
+    /**
+     * @brief dfs检查只有根结点没有父结点、结点大小，以及内部结点的分隔key不大于第i个孩子中的key、大于第i-1个孩子中的key
+     * @return 子树中叶子结点的层数
+     */
+    int check_tree(IxIndexHandle *ih, page_id_t page_no, page_id_t parent, int *num_leaves) {
+        IxNodeHandle *node = ih->fetch_node(page_no);
+        EXPECT_EQ(parent == IX_NO_PAGE, node->is_root_page());
+        EXPECT_LT(node->get_size(), node->get_max_size());
+        if (parent != IX_NO_PAGE) {
+            EXPECT_GE(node->get_size(), node->get_min_size());
+        }
+        int depth = 0;
+        if (node->is_leaf_page()) {
+            (*num_leaves)++;
+        } else {
+            for (int i = 0; i < node->get_size(); i++) {
+                IxNodeHandle *child = ih->fetch_node(node->value_at(i));
+                if (i > 0 && child->get_size() > child->first_key_idx()) {
+                    EXPECT_LE(node->key_at(i), child->key_at(child->first_key_idx()));
+                }
+                if (i + 1 < node->get_size()) {
+                    EXPECT_LT(child->key_at(child->get_size() - 1), node->key_at(i + 1));
+                }
+                buffer_pool_manager_->unpin_page(child->get_page_id(), false);
+                int child_depth = check_tree(ih, node->value_at(i), page_no, num_leaves);
+                if (i > 0) {
+                    EXPECT_EQ(depth, child_depth);
+                }
+                depth = child_depth;
+            }
+            depth++;
+        }
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
+        return depth;
+    }
+};
+
+/**
+ * @brief 内存预算很小时外部排序写出多个run并归并，输出按(key, rid)有序且不丢失键值对
+ */
+TEST_F(BPlusTreeBulkBuildTests, SorterTest) {
+    const int num_entries = 10000;
+    std::mt19937 rng(0);
+    std::vector<std::pair<int, Rid>> entries;
+    for (int i = 0; i < num_entries; i++) {
+        entries.emplace_back(static_cast<int>(rng() % 1000) - 500, Rid{i / 100, i % 100});
+    }
+    for (size_t budget : {static_cast<size_t>(IX_SORT_BUFFER_SIZE), static_cast<size_t>(12 * 500)}) {
+        IxSorter sorter({TYPE_INT}, {4}, "sorter_test", budget);
+        for (auto &entry : entries) {
+            sorter.add(reinterpret_cast<const char *>(&entry.first), entry.second);
+        }
+        sorter.finish();
+        EXPECT_EQ(static_cast<size_t>(num_entries), sorter.size());
+        if (budget < static_cast<size_t>(IX_SORT_BUFFER_SIZE)) {
+            EXPECT_EQ(static_cast<size_t>(num_entries / 500), sorter.num_runs());
+        } else {
+            EXPECT_EQ(0u, sorter.num_runs());
+        }
+        std::vector<std::pair<int, Rid>> sorted = entries;
+        std::sort(sorted.begin(), sorted.end(), [](const std::pair<int, Rid> &a, const std::pair<int, Rid> &b) {
+            if (a.first != b.first) return a.first < b.first;
+            if (a.second.page_no != b.second.page_no) return a.second.page_no < b.second.page_no;
+            return a.second.slot_no < b.second.slot_no;
+        });
+        const char *key;
+        Rid rid;
+        for (auto &entry : sorted) {
+            ASSERT_TRUE(sorter.next(&key, &rid));
+            EXPECT_EQ(entry.first, ix_decode_int(key));
+            EXPECT_EQ(entry.second, rid);
+        }
+        EXPECT_FALSE(sorter.next(&key, &rid));
+    }
+}
+
+/**
+ * @brief 在已有数据的表上创建索引，B+树自底向上构建：结构正确、结点按填充率装满、叶子链表和扫描顺序正确
+ */
+TEST_F(BPlusTreeBulkBuildTests, CreateIndexTest) {
+    const int num_records = 200000;
+    std::vector<int> keys(num_records);
+    for (int i = 0; i < num_records; i++) {
+        keys[i] = 2 * i - num_records;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(1));
+    auto expected = insert_records(keys);
+
+    sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr);
+    EXPECT_TRUE(sm_->db_.get_table(TEST_FILE_NAME).is_index(TEST_COL));
+    EXPECT_TRUE(ix_manager_->exists(TEST_FILE_NAME, TEST_COL));
+    EXPECT_THROW(sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr), IndexExistsError);
+    IxIndexHandle *ih = sm_->ihs_.at(ix_manager_->get_index_name(TEST_FILE_NAME, TEST_COL)).get();
+
+    // 叶子个数由按前缀压缩后的容量和填充率决定，页面连续分配没有浪费
+    int num_leaves = 0;
+    int depth = check_tree(ih, ih->file_hdr_->root_page_, IX_NO_PAGE, &num_leaves);
+    const int min_leaf_keys = static_cast<int>((IxNodeHandle::max_size(ih->file_hdr_, 0) - 1) * IX_BULK_FILL_FACTOR);
+    EXPECT_LE(num_leaves, (num_records + min_leaf_keys - 1) / min_leaf_keys);
+    // 内部结点按分隔key的公共前缀压缩，层数不超过不压缩时的层数
+    const int per_node = min_leaf_keys;
+    int max_depth = 0;
+    for (int nodes = num_leaves; nodes > 1; nodes = (nodes + per_node - 1) / per_node) {
+        max_depth++;
+    }
+    EXPECT_LE(depth, max_depth);
+    EXPECT_EQ(ih->file_hdr_->num_pages_, disk_manager_->get_fd2pageno(ih->fd_));
+
+    // 叶子链表
+    int leaves_in_list = 0;
+    page_id_t prev = IX_LEAF_HEADER_PAGE;
+    for (page_id_t leaf_no = ih->file_hdr_->first_leaf_; leaf_no != IX_LEAF_HEADER_PAGE; leaves_in_list++) {
+        IxNodeHandle *leaf = ih->fetch_node(leaf_no);
+        EXPECT_EQ(prev, leaf->get_prev_leaf());
+        prev = leaf_no;
+        leaf_no = leaf->get_next_leaf();
+        buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+        delete leaf;
+    }
+    EXPECT_EQ(num_leaves, leaves_in_list);
+    EXPECT_EQ(prev, ih->file_hdr_->last_leaf_);
+
+    // 扫描整个索引，得到按key排序的rid
+    IxScan scan(ih, ih->leaf_begin(), ih->leaf_end(), buffer_pool_manager_.get());
+    size_t i = 0;
+    for (; !scan.is_end(); scan.next(), i++) {
+        ASSERT_LT(i, expected.size());
+        EXPECT_EQ(expected[i].second, scan.rid());
+    }
+    EXPECT_EQ(expected.size(), i);
+}
+
+/**
+ * @brief 空表上创建索引得到空的B+树；存在重复key时创建失败，不留下索引文件和元数据
+ */
+TEST_F(BPlusTreeBulkBuildTests, EmptyAndDuplicateTest) {
+    sm_->create_index(TEST_FILE_NAME, {"col2"}, nullptr);
+    IxIndexHandle *ih = sm_->ihs_.at(ix_manager_->get_index_name(TEST_FILE_NAME, {"col2"})).get();
+    EXPECT_EQ(IX_INIT_ROOT_PAGE, ih->file_hdr_->root_page_);
+    EXPECT_EQ(IX_INIT_NUM_PAGES, ih->file_hdr_->num_pages_);
+
+    insert_records({1, 2, 3, 2});
+    EXPECT_THROW(sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr), IndexDuplicateKeyError);
+    EXPECT_FALSE(sm_->db_.get_table(TEST_FILE_NAME).is_index(TEST_COL));
+    EXPECT_FALSE(ix_manager_->exists(TEST_FILE_NAME, TEST_COL));
+}
+
+/**
+ * @brief bulk_build()在最后一个key重复时失败，初始页面和文件头不变，索引仍为空；
+ * has_duplicate()发现sorter中相邻的重复key和与索引中已有key的重复，insert_sorted()返回实际插入的个数
+ */
+TEST_F(BPlusTreeBulkBuildTests, DuplicateCheckTest) {
+    sm_->create_index(TEST_FILE_NAME, {"col2"}, nullptr);
+    IxIndexHandle *ih = sm_->ihs_.at(ix_manager_->get_index_name(TEST_FILE_NAME, {"col2"})).get();
+    const int num_keys = 5000;
+    // keys为[0, num_keys)中的偶数，extra追加在末尾
+    auto make_sorter = [&](const std::string &name, const std::vector<int> &extra) {
+        auto sorter = std::make_unique<IxSorter>(std::vector<ColType>{TYPE_INT}, std::vector<int>{4}, name,
+                                                 IX_SORT_BUFFER_SIZE);
+        for (int key = 0; key < num_keys; key += 2) {
+            sorter->add(reinterpret_cast<const char *>(&key), Rid{key / 100, key % 100});
+        }
+        for (int key : extra) {
+            sorter->add(reinterpret_cast<const char *>(&key), Rid{key / 100, key % 100});
+        }
+        sorter->finish();
+        return sorter;
+    };
+
+    auto sorter = make_sorter("dup_build", {num_keys - 2});
+    EXPECT_THROW(ih->bulk_build(sorter.get()), IndexDuplicateKeyError);
+    EXPECT_TRUE(ih->can_bulk_build());
+    EXPECT_EQ(IX_INIT_ROOT_PAGE, ih->file_hdr_->root_page_);
+    EXPECT_EQ(IX_INIT_NUM_PAGES, ih->file_hdr_->num_pages_);
+
+    sorter = make_sorter("dup_empty", {num_keys / 2});
+    EXPECT_TRUE(ih->has_duplicate(sorter.get()));
+    sorter = make_sorter("unique_empty", {});
+    EXPECT_FALSE(ih->has_duplicate(sorter.get()));
+    sorter = make_sorter("build", {});
+    ih->bulk_build(sorter.get());
+    EXPECT_FALSE(ih->can_bulk_build());
+
+    // 索引非空时与已有的key比较：奇数不重复，任意一个偶数重复
+    auto odd_sorter = [&](const std::string &name, const std::vector<int> &extra) {
+        auto sorter = std::make_unique<IxSorter>(std::vector<ColType>{TYPE_INT}, std::vector<int>{4}, name,
+                                                 IX_SORT_BUFFER_SIZE);
+        for (int key = 1; key < num_keys; key += 2) {
+            sorter->add(reinterpret_cast<const char *>(&key), Rid{key / 100, key % 100});
+        }
+        for (int key : extra) {
+            sorter->add(reinterpret_cast<const char *>(&key), Rid{key / 100, key % 100});
+        }
+        sorter->finish();
+        return sorter;
+    };
+    sorter = odd_sorter("odd", {-1, num_keys + 1});
+    EXPECT_FALSE(ih->has_duplicate(sorter.get()));
+    for (int dup : {0, num_keys / 2, num_keys - 2}) {
+        sorter = odd_sorter("odd_dup", {dup});
+        EXPECT_TRUE(ih->has_duplicate(sorter.get())) << dup;
+    }
+
+    sorter = odd_sorter("odd_insert", {0, num_keys - 2});
+    EXPECT_EQ(static_cast<size_t>(num_keys / 2), ih->insert_sorted(sorter.get(), nullptr));
+    std::vector<Rid> result;
+    for (int key = 0; key < num_keys; key++) {
+        EXPECT_TRUE(ih->get_value(reinterpret_cast<const char *>(&key), &result, nullptr)) << key;
+    }
+}
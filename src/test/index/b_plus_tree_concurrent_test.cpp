@@ -69,6 +69,10 @@ class BPlusTreeConcurrentTest : public ::testing::Test {
         sm_->create_table(TEST_FILE_NAME, coldef, nullptr);
         sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr);
         assert(ix_manager_->exists(TEST_FILE_NAME, TEST_COL));
+        // create_index()之后索引文件由sm_打开，先关闭再由测试自己打开
+        std::string index_name = ix_manager_->get_index_name(TEST_FILE_NAME, TEST_COL);
+        ix_manager_->close_index(sm_->ihs_.at(index_name).get());
+        sm_->ihs_.erase(index_name);
         // 打开测试文件
         ih_ = ix_manager_->open_index(TEST_FILE_NAME, TEST_COL);
         assert(ih_ != nullptr);
@@ -103,7 +107,7 @@ class BPlusTreeConcurrentTest : public ::testing::Test {
                 << "max_size=" << leaf->get_max_size() << ",min_size=" << leaf->get_min_size() << "</TD></TR>\n";
             out << "<TR>";
             for (int i = 0; i < leaf->get_size(); i++) {
-                out << "<TD>" << *reinterpret_cast<int*>(leaf->get_key(i)) << "</TD>\n";
+                out << "<TD>" << leaf->key_at(i) << "</TD>\n";
             }
             out << "</TR>";
             // Print table end
@@ -116,11 +120,6 @@ class BPlusTreeConcurrentTest : public ::testing::Test {
                     << "};\n";
             }
 
-            // Print parent links if there is a parent
-            if (leaf->get_parent_page_no() != INVALID_PAGE_ID) {
-                out << internal_prefix << leaf->get_parent_page_no() << ":p" << leaf->get_page_no() << " -> " << leaf_prefix
-                    << leaf->get_page_no() << ";\n";
-            }
         } else {
             IxNodeHandle *inner = node;
             // Print node name
@@ -147,15 +146,13 @@ class BPlusTreeConcurrentTest : public ::testing::Test {
             out << "</TR>";
             // Print table end
             out << "</TABLE>>];\n";
-            // Print Parent link
-            if (inner->get_parent_page_no() != INVALID_PAGE_ID) {
-                out << internal_prefix << inner->get_parent_page_no() << ":p" << inner->get_page_no() << " -> "
-                    << internal_prefix << inner->get_page_no() << ";\n";
-            }
             // Print leaves
             for (int i = 0; i < inner->get_size(); i++) {
                 IxNodeHandle *child_node = ih->fetch_node(inner->value_at(i));
                 ToGraph(ih, child_node, bpm, out);  // 继续递归
+                // Print link to the child
+                out << internal_prefix << inner->get_page_no() << ":p" << child_node->get_page_no() << " -> "
+                    << (child_node->is_leaf_page() ? leaf_prefix : internal_prefix) << child_node->get_page_no() << ";\n";
                 if (i > 0) {
                     IxNodeHandle *sibling_node = ih->fetch_node(inner->value_at(i - 1));
                     if (!sibling_node->is_leaf_page() && !child_node->is_leaf_page()) {
@@ -220,7 +217,7 @@ class BPlusTreeConcurrentTest : public ::testing::Test {
     }
 
     /**
-     * @brief dfs遍历整个树，检查孩子结点的第一个和最后一个key是否正确
+     * @brief dfs遍历整个树，检查孩子结点的第一个和最后一个key与分隔key的大小关系
      *
      * @param ih 树
      * @param now_page_no 当前遍历到的结点
@@ -233,15 +230,16 @@ class BPlusTreeConcurrentTest : public ::testing::Test {
         }
         for (int i = 0; i < node->get_size(); i++) {                 // 遍历node的所有孩子
             IxNodeHandle *child = ih->fetch_node(node->value_at(i));  // 第i个孩子
-            // check parent
-            assert(child->get_parent_page_no() == now_page_no);
-            // check first key
+            // check that the child is not the root
+            assert(child->get_page_no() != ih->file_hdr_->root_page_);
+            // check separator key
             int node_key = node->key_at(i);  // node的第i个key
-            int child_first_key = child->key_at(0);
+            // 内部结点的第0个key不参与比较，孩子的第一个有效key是叶子的第0个key或内部结点的第1个分隔key
+            int child_first_key = child->key_at(child->first_key_idx());
             int child_last_key = child->key_at(child->get_size() - 1);
             if (i != 0) {
-                // 除了第0个key之外，node的第i个key与其第i个孩子的第0个key的值相同
-                ASSERT_EQ(node_key, child_first_key);
+                // 除了第0个key之外，node的第i个key是分隔key，不大于其第i个孩子中的key
+                ASSERT_LE(node_key, child_first_key);
             }
             if (i + 1 < node->get_size()) {
                 // 满足制约大小关系
@@ -462,4 +460,59 @@ TEST_F(BPlusTreeConcurrentTest, MixScaleTest) {
         scan.next();
     }
     EXPECT_EQ(size, keys.size() - delete_keys.size());
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 小阶数下并发插入、删除和查找，频繁触发分裂与合并：
+ * 预先插入key%3∈{0,1}的key，之后每个线程负责key%thread_num==thread_itr的部分，
+ * 删除key%3==1的key、插入key%3==2的key，同时查找key%3==0的key，这些key在整个过程中必须一直能找到
+ */
+TEST_F(BPlusTreeConcurrentTest, MixedStressTest) {
+    const int scale = 30000;
+    const int thread_num = 8;
+    const int order = 8;
+
+    assert(order > 2 && order <= ih_->file_hdr_->btree_order_);
+    ih_->file_hdr_->btree_order_ = order;
+
+    std::vector<int> keys(scale);
+    for (int key = 0; key < scale; key++) {
+        keys[key] = key;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::default_random_engine{});
+    for (int key : keys) {
+        if (key % 3 != 2) {
+            ih_->insert_entry((const char *)&key, Rid{.page_no = 0, .slot_no = key}, txn_.get());
+        }
+    }
+
+    auto worker = [&](uint64_t thread_itr) {
+        Transaction transaction(0);
+        std::vector<Rid> rids;
+        for (int key : keys) {
+            if (key % thread_num != static_cast<int>(thread_itr)) {
+                continue;
+            }
+            if (key % 3 == 1) {
+                EXPECT_TRUE(ih_->delete_entry((const char *)&key, &transaction));
+            } else if (key % 3 == 2) {
+                EXPECT_NE(ih_->insert_entry((const char *)&key, Rid{.page_no = 0, .slot_no = key}, &transaction),
+                          IX_NO_PAGE);
+            }
+            int probe = key - key % 3;
+            rids.clear();
+            EXPECT_TRUE(ih_->get_value((const char *)&probe, &rids, &transaction));
+            ASSERT_EQ(rids.size(), 1);
+            EXPECT_EQ(rids[0].slot_no, probe);
+        }
+    };
+    LaunchParallelTest(thread_num, worker);
+
+    std::multimap<int, Rid> mock;
+    for (int key = 0; key < scale; key++) {
+        if (key % 3 != 1) {
+            mock.insert(std::make_pair(key, Rid{.page_no = 0, .slot_no = key}));
+        }
+    }
+    check_all(ih_.get(), mock);
+}
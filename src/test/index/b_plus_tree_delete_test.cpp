@@ -67,6 +67,10 @@ class BPlusTreeTests : public ::testing::Test {
         sm_->create_table(TEST_FILE_NAME, coldef, nullptr);
         sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr);
         assert(ix_manager_->exists(TEST_FILE_NAME, TEST_COL));
+        // create_index()之后索引文件由sm_打开，先关闭再由测试自己打开
+        std::string index_name = ix_manager_->get_index_name(TEST_FILE_NAME, TEST_COL);
+        ix_manager_->close_index(sm_->ihs_.at(index_name).get());
+        sm_->ihs_.erase(index_name);
         // 打开测试文件
         ih_ = ix_manager_->open_index(TEST_FILE_NAME, TEST_COL);
         assert(ih_ != nullptr);
@@ -101,7 +105,7 @@ class BPlusTreeTests : public ::testing::Test {
                 << "max_size=" << leaf->get_max_size() << ",min_size=" << leaf->get_min_size() << "</TD></TR>\n";
             out << "<TR>";
             for (int i = 0; i < leaf->get_size(); i++) {
-                out << "<TD>" << *reinterpret_cast<int*>(leaf->get_key(i)) << "</TD>\n";
+                out << "<TD>" << leaf->key_at(i) << "</TD>\n";
             }
             out << "</TR>";
             // Print table end
@@ -114,11 +118,6 @@ class BPlusTreeTests : public ::testing::Test {
                     << "};\n";
             }
 
-            // Print parent links if there is a parent
-            if (leaf->get_parent_page_no() != INVALID_PAGE_ID) {
-                out << internal_prefix << leaf->get_parent_page_no() << ":p" << leaf->get_page_no() << " -> " << leaf_prefix
-                    << leaf->get_page_no() << ";\n";
-            }
         } else {
             IxNodeHandle *inner = node;
             // Print node name
@@ -145,15 +144,13 @@ class BPlusTreeTests : public ::testing::Test {
             out << "</TR>";
             // Print table end
             out << "</TABLE>>];\n";
-            // Print Parent link
-            if (inner->get_parent_page_no() != INVALID_PAGE_ID) {
-                out << internal_prefix << inner->get_parent_page_no() << ":p" << inner->get_page_no() << " -> "
-                    << internal_prefix << inner->get_page_no() << ";\n";
-            }
             // Print leaves
             for (int i = 0; i < inner->get_size(); i++) {
                 IxNodeHandle *child_node = ih->fetch_node(inner->value_at(i));
                 ToGraph(ih, child_node, bpm, out);  // 继续递归
+                // Print link to the child
+                out << internal_prefix << inner->get_page_no() << ":p" << child_node->get_page_no() << " -> "
+                    << (child_node->is_leaf_page() ? leaf_prefix : internal_prefix) << child_node->get_page_no() << ";\n";
                 if (i > 0) {
                     IxNodeHandle *sibling_node = ih->fetch_node(inner->value_at(i - 1));
                     if (!sibling_node->is_leaf_page() && !child_node->is_leaf_page()) {
@@ -218,7 +215,7 @@ class BPlusTreeTests : public ::testing::Test {
     }
 
     /**
-     * @brief dfs遍历整个树，检查孩子结点的第一个和最后一个key是否正确
+     * @brief dfs遍历整个树，检查孩子结点的第一个和最后一个key与分隔key的大小关系
      *
      * @param ih 树
      * @param now_page_no 当前遍历到的结点
@@ -231,15 +228,16 @@ class BPlusTreeTests : public ::testing::Test {
         }
         for (int i = 0; i < node->get_size(); i++) {                 // 遍历node的所有孩子
             IxNodeHandle *child = ih->fetch_node(node->value_at(i));  // 第i个孩子
-            // check parent
-            assert(child->get_parent_page_no() == now_page_no);
-            // check first key
+            // check that the child is not the root
+            assert(child->get_page_no() != ih->file_hdr_->root_page_);
+            // check separator key
             int node_key = node->key_at(i);  // node的第i个key
-            int child_first_key = child->key_at(0);
+            // 内部结点的第0个key不参与比较，孩子的第一个有效key是叶子的第0个key或内部结点的第1个分隔key
+            int child_first_key = child->key_at(child->first_key_idx());
             int child_last_key = child->key_at(child->get_size() - 1);
             if (i != 0) {
-                // 除了第0个key之外，node的第i个key与其第i个孩子的第0个key的值相同
-                ASSERT_EQ(node_key, child_first_key);
+                // 除了第0个key之外，node的第i个key是分隔key，不大于其第i个孩子中的key
+                ASSERT_LE(node_key, child_first_key);
             }
             if (i + 1 < node->get_size()) {
                 // 满足制约大小关系
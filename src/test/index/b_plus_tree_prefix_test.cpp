@@ -0,0 +1,267 @@
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#undef private
+
+#include "storage/buffer_pool_manager.h"
+
+const std::string TEST_DB_NAME = "BPlusTreePrefixTest_db";
+const std::string TEST_FILE_NAME = "table1";
+const int KEY_LEN = 64;
+
+/**
+ * 叶子结点按公共前缀压缩：key为长度KEY_LEN的字符串，前面是很长的公共路径，后面是序号
+ */
+class BPlusTreePrefixTests : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<IxIndexHandle> ih_;
+    std::vector<ColMeta> cols_ = {{TEST_FILE_NAME, "path", TYPE_STRING, KEY_LEN, 0, true}};
+
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(1024, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            disk_manager_->destroy_dir(TEST_DB_NAME);
+        }
+        disk_manager_->create_dir(TEST_DB_NAME);
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+        ix_manager_->create_index(TEST_FILE_NAME, cols_);
+        ih_ = ix_manager_->open_index(TEST_FILE_NAME, cols_);
+    }
+
+    void TearDown() override {
+        ix_manager_->close_index(ih_.get());
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+        disk_manager_->destroy_dir(TEST_DB_NAME);
+    }
+
+    static std::string make_key(const std::string &prefix, int i) {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%08d", i);
+        std::string key = prefix + buf;
+        key.resize(KEY_LEN, ' ');
+        return key;
+    }
+
+    static Rid make_rid(int i) { return Rid{i / 1000, i % 1000}; }
+
+    /**
+     * @brief dfs检查只有根结点没有父结点、结点大小、内部结点的分隔key划分了相邻的孩子，
+     * 以及结点的前缀确实是所有参与压缩的key的公共前缀(内部结点的第0个key不参与)
+     * @return 子树中叶子结点的层数，max_leaf_size/max_inner_size记录叶子/内部结点中键值对个数的最大值
+     */
+    int check_tree(page_id_t page_no, page_id_t parent, int *max_leaf_size, int *max_inner_size) {
+        IxNodeHandle *node = ih_->fetch_node(page_no);
+        EXPECT_EQ(parent == IX_NO_PAGE, node->is_root_page());
+        EXPECT_LT(node->get_size(), node->get_max_size());
+        if (parent != IX_NO_PAGE) {
+            EXPECT_GE(node->get_size(), node->get_min_size());
+        }
+        const int first = node->first_key_idx();
+        char key[KEY_LEN], prev_key[KEY_LEN];
+        for (int i = first; i < node->get_size(); i++) {
+            node->get_key(i, key);
+            if (i > first) {
+                EXPECT_LT(memcmp(prev_key, key, KEY_LEN), 0);
+            }
+            memcpy(prev_key, key, KEY_LEN);
+        }
+        if (node->get_size() > first + 1) {
+            char first_key[KEY_LEN], last_key[KEY_LEN];
+            node->get_key(first, first_key);
+            node->get_key(node->get_size() - 1, last_key);
+            int lcp = 0;
+            while (lcp < KEY_LEN && first_key[lcp] == last_key[lcp]) lcp++;
+            EXPECT_EQ(lcp, node->get_prefix_len());
+        }
+        int depth = 0;
+        if (node->is_leaf_page()) {
+            *max_leaf_size = std::max(*max_leaf_size, node->get_size());
+        } else {
+            *max_inner_size = std::max(*max_inner_size, node->get_size());
+            for (int i = 0; i < node->get_size(); i++) {
+                IxNodeHandle *child = ih_->fetch_node(node->value_at(i));
+                char child_key[KEY_LEN];
+                node->get_key(i, key);
+                // 分隔key不大于第i个孩子中的key，大于第i-1个孩子中的key
+                if (i > 0 && child->get_size() > child->first_key_idx()) {
+                    child->get_key(child->first_key_idx(), child_key);
+                    EXPECT_LE(memcmp(key, child_key, KEY_LEN), 0);
+                }
+                if (i + 1 < node->get_size()) {
+                    node->get_key(i + 1, key);
+                    child->get_key(child->get_size() - 1, child_key);
+                    EXPECT_LT(memcmp(child_key, key, KEY_LEN), 0);
+                }
+                buffer_pool_manager_->unpin_page(child->get_page_id(), false);
+                delete child;
+                int child_depth = check_tree(node->value_at(i), page_no, max_leaf_size, max_inner_size);
+                if (i > 0) {
+                    EXPECT_EQ(depth, child_depth);
+                }
+                depth = child_depth;
+            }
+            depth++;
+        }
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
+        return depth;
+    }
+
+    /**
+     * @brief 检查树结构，扫描整个索引与expected(按key排序)一致，并逐个点查
+     * @param[out] max_inner_size 不为nullptr时记录内部结点中键值对个数的最大值
+     * @return 叶子中键值对个数的最大值
+     */
+    int check_index(const std::map<std::string, Rid> &expected, int *max_inner_size = nullptr) {
+        int max_leaf_size = 0, inner_size = 0;
+        check_tree(ih_->file_hdr_->root_page_, IX_NO_PAGE, &max_leaf_size, &inner_size);
+        if (max_inner_size != nullptr) {
+            *max_inner_size = inner_size;
+        }
+        IxScan scan(ih_.get(), ih_->leaf_begin(), ih_->leaf_end(), buffer_pool_manager_.get());
+        auto it = expected.begin();
+        for (; !scan.is_end(); scan.next(), ++it) {
+            if (it == expected.end()) {
+                ADD_FAILURE() << "scan returned extra entries";
+                break;
+            }
+            EXPECT_EQ(it->second, scan.rid());
+        }
+        EXPECT_TRUE(it == expected.end());
+        std::vector<Rid> rids;
+        for (auto &entry : expected) {
+            rids.clear();
+            EXPECT_TRUE(ih_->get_value(entry.first.c_str(), &rids, nullptr));
+            EXPECT_EQ(std::vector<Rid>{entry.second}, rids);
+        }
+        return max_leaf_size;
+    }
+};
+
+/**
+ * @brief 随机插入共享长前缀的key：叶子和内部结点装下的键值对都多于不压缩时的容量；
+ * 随机删除一半后结构仍然正确；在两端插入不共享前缀的key时前缀缩短
+ */
+TEST_F(BPlusTreePrefixTests, InsertDeleteTest) {
+    const int num_keys = 20000;
+    const std::string prefix = "/home/rmdb/data/warehouse/orders/2023/";
+    std::vector<int> ids(num_keys);
+    for (int i = 0; i < num_keys; i++) ids[i] = i;
+    std::mt19937 rng(0);
+    std::shuffle(ids.begin(), ids.end(), rng);
+
+    std::map<std::string, Rid> expected;
+    for (int id : ids) {
+        std::string key = make_key(prefix, id);
+        ih_->insert_entry(key.c_str(), make_rid(id), nullptr);
+        expected[key] = make_rid(id);
+    }
+    int max_inner_size = 0;
+    int max_leaf_size = check_index(expected, &max_inner_size);
+    EXPECT_GT(max_leaf_size, IxNodeHandle::capacity(KEY_LEN, 0));
+    EXPECT_GT(max_inner_size, IxNodeHandle::capacity(KEY_LEN, 0));
+
+    std::shuffle(ids.begin(), ids.end(), rng);
+    for (int i = 0; i < num_keys / 2; i++) {
+        std::string key = make_key(prefix, ids[i]);
+        EXPECT_TRUE(ih_->delete_entry(key.c_str(), nullptr));
+        expected.erase(key);
+    }
+    check_index(expected);
+
+    // 比所有key都小/大的key，插入到第一个/最后一个叶子时前缀缩短
+    for (int i = 0; i < 200; i++) {
+        for (const std::string &other : {std::string("/aaa/"), std::string("/zzz/")}) {
+            std::string key = make_key(other, i);
+            ih_->insert_entry(key.c_str(), make_rid(num_keys + i), nullptr);
+            expected[key] = make_rid(num_keys + i);
+        }
+    }
+    check_index(expected);
+}
+
+/**
+ * @brief 对共享长前缀的字符串key批量构建，叶子和内部结点按压缩后的容量装入，构建之后可以继续插入
+ */
+TEST_F(BPlusTreePrefixTests, BulkBuildTest) {
+    const int num_keys = 30000;
+    const std::string prefix = "/home/rmdb/data/warehouse/lineitem/";
+    std::map<std::string, Rid> expected;
+    {
+        IxSorter sorter({TYPE_STRING}, {KEY_LEN}, "prefix_sorter", IX_SORT_BUFFER_SIZE);
+        for (int i = 0; i < num_keys; i += 2) {
+            std::string key = make_key(prefix, i);
+            sorter.add(key.c_str(), make_rid(i));
+            expected[key] = make_rid(i);
+        }
+        sorter.finish();
+        ih_->bulk_build(&sorter);
+    }
+    int max_inner_size = 0;
+    int max_leaf_size = check_index(expected, &max_inner_size);
+    EXPECT_GT(max_leaf_size, IxNodeHandle::capacity(KEY_LEN, 0));
+    EXPECT_GT(max_inner_size, IxNodeHandle::capacity(KEY_LEN, 0));
+
+    for (int i = 1; i < num_keys; i += 50) {
+        std::string key = make_key(prefix, i);
+        ih_->insert_entry(key.c_str(), make_rid(i), nullptr);
+        expected[key] = make_rid(i);
+    }
+    check_index(expected);
+}
+
+/**
+ * @brief 删除部分key后关闭索引，模拟重启重新创建DiskManager和缓冲池后打开索引，继续插入直到结点分裂：
+ * 新分配的页面不能覆盖已有的结点
+ */
+TEST_F(BPlusTreePrefixTests, ReopenTest) {
+    const int num_keys = 10000;
+    const std::string prefix = "/home/rmdb/data/warehouse/customer/";
+    std::map<std::string, Rid> expected;
+    for (int i = 0; i < num_keys; i += 2) {
+        std::string key = make_key(prefix, i);
+        ih_->insert_entry(key.c_str(), make_rid(i), nullptr);
+        expected[key] = make_rid(i);
+    }
+    for (int i = 0; i < num_keys / 2; i += 2) {
+        std::string key = make_key(prefix, i);
+        EXPECT_TRUE(ih_->delete_entry(key.c_str(), nullptr));
+        expected.erase(key);
+    }
+    check_index(expected);
+
+    ix_manager_->close_index(ih_.get());
+    ih_.reset();
+    ix_manager_.reset();
+    buffer_pool_manager_.reset();
+    disk_manager_ = std::make_unique<DiskManager>();
+    buffer_pool_manager_ = std::make_unique<BufferPoolManager>(1024, disk_manager_.get());
+    ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+    ih_ = ix_manager_->open_index(TEST_FILE_NAME, cols_);
+    check_index(expected);
+
+    for (int i = 1; i < 2 * num_keys; i += 2) {
+        std::string key = make_key(prefix, i);
+        ih_->insert_entry(key.c_str(), make_rid(i), nullptr);
+        expected[key] = make_rid(i);
+    }
+    check_index(expected);
+}
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "index/ix_index_handle.h"
+
+static int sign(int x) { return (x > 0) - (x < 0); }
+
+/**
+ * @brief 规范化key按memcmp比较的结果与ix_compare一致，且可以还原
+ */
+TEST(IxKeyTest, OrderPreservingTest) {
+    const std::vector<ColType> col_types = {TYPE_INT, TYPE_FLOAT, TYPE_STRING};
+    const std::vector<int> col_lens = {4, 4, 3};
+    const int key_len = 11;
+    const std::vector<int> ints = {std::numeric_limits<int>::min(), -65536, -256, -1, 0, 1, 255, 256,
+                                   std::numeric_limits<int>::max()};
+    const std::vector<float> floats = {-std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::max(),
+                                       -1.5f, -std::numeric_limits<float>::denorm_min(), -0.0f, 0.0f,
+                                       std::numeric_limits<float>::denorm_min(), 1.0f, 1.5f,
+                                       std::numeric_limits<float>::max(), std::numeric_limits<float>::infinity()};
+    const std::vector<std::string> strs = {std::string("\0\0\0", 3), std::string("a\0\0", 3), "ab\x80", "abc", "b\xff\x01"};
+
+    std::vector<std::vector<char>> keys;
+    std::mt19937 rng(0);
+    for (int i = 0; i < 2000; i++) {
+        std::vector<char> key(key_len);
+        int iv = ints[rng() % ints.size()];
+        float fv = floats[rng() % floats.size()];
+        memcpy(key.data(), &iv, 4);
+        memcpy(key.data() + 4, &fv, 4);
+        memcpy(key.data() + 8, strs[rng() % strs.size()].data(), 3);
+        keys.push_back(key);
+    }
+    std::vector<std::vector<char>> norm_keys;
+    for (auto &key : keys) {
+        std::vector<char> norm_key(key_len), decoded(key_len);
+        ix_encode_key(key.data(), norm_key.data(), col_types, col_lens);
+        ix_decode_key(norm_key.data(), decoded.data(), col_types, col_lens);
+        EXPECT_EQ(0, ix_compare(key.data(), decoded.data(), col_types, col_lens));
+        norm_keys.push_back(norm_key);
+    }
+    for (size_t i = 0; i < keys.size(); i++) {
+        for (size_t j = 0; j < 20; j++) {
+            size_t k = rng() % keys.size();
+            ASSERT_EQ(sign(ix_compare(keys[i].data(), keys[k].data(), col_types, col_lens)),
+                      sign(ix_key_compare(norm_keys[i].data(), norm_keys[k].data(), key_len)));
+        }
+    }
+}
+
+/**
+ * @brief 单个int/float字段编码后的字节序与数值顺序一致，-0.0与+0.0编码相同
+ */
+TEST(IxKeyTest, ScalarTest) {
+    std::vector<int> ints(1000);
+    std::mt19937 rng(1);
+    for (auto &v : ints) v = static_cast<int>(rng());
+    std::sort(ints.begin(), ints.end());
+    char prev[4], cur[4];
+    for (size_t i = 0; i < ints.size(); i++) {
+        ix_encode_int(reinterpret_cast<const char *>(&ints[i]), cur);
+        EXPECT_EQ(ints[i], ix_decode_int(cur));
+        if (i > 0) {
+            EXPECT_EQ(ints[i - 1] < ints[i], memcmp(prev, cur, 4) < 0);
+        }
+        memcpy(prev, cur, 4);
+    }
+
+    float neg_zero = -0.0f, pos_zero = 0.0f;
+    char a[4], b[4];
+    ix_encode_float(reinterpret_cast<const char *>(&neg_zero), a);
+    ix_encode_float(reinterpret_cast<const char *>(&pos_zero), b);
+    EXPECT_EQ(0, memcmp(a, b, 4));
+    EXPECT_FALSE(std::signbit(ix_decode_float(a)));
+}
+
+/**
+ * @brief 无分支统计的结果与按memcmp的lower_bound/upper_bound一致，覆盖1~4字节的key和SIMD之后剩余的尾部
+ */
+TEST(IxKeyTest, ProbeCountTest) {
+    std::mt19937 rng(2);
+    for (int len = 1; len <= 4; len++) {
+        for (int n : {0, 1, 3, 4, 7, 64, 67}) {
+            std::vector<std::string> keys;
+            for (int i = 0; i < n; i++) {
+                std::string key(len, '\0');
+                for (auto &c : key) c = static_cast<char>(rng() % 4 * 64);
+                keys.push_back(key);
+            }
+            // 按无符号字节序排序
+            std::sort(keys.begin(), keys.end(), [len](const std::string &a, const std::string &b) {
+                return memcmp(a.data(), b.data(), len) < 0;
+            });
+            std::string buf;
+            for (auto &key : keys) buf += key;
+            for (int j = 0; j < 50; j++) {
+                std::string target(len, '\0');
+                for (auto &c : target) c = static_cast<char>(rng() % 4 * 64);
+                int lower = 0, upper = 0;
+                for (auto &key : keys) {
+                    lower += memcmp(key.data(), target.data(), len) < 0;
+                    upper += memcmp(key.data(), target.data(), len) <= 0;
+                }
+                EXPECT_EQ(lower, ix_probe_count(buf.data(), n, len, target.data(), false));
+                EXPECT_EQ(upper, ix_probe_count(buf.data(), n, len, target.data(), true));
+            }
+        }
+    }
+}
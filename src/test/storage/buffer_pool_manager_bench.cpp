@@ -0,0 +1,99 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+// 缓冲池命中路径的多线程吞吐测试：所有页面预先载入缓冲池，多个线程随机fetch_page/unpin_page
+// 用法: buffer_pool_manager_bench [ops_per_thread] [max_threads]
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "storage/buffer_pool_manager.h"
+
+const std::string BENCH_DB_NAME = "BufferPoolManagerBench_db";
+constexpr int BENCH_NUM_PAGES = 4096;
+
+/**
+ * @brief 在num_shards个分片的缓冲池上，用num_threads个线程各执行ops_per_thread次命中访问
+ * @return 每秒完成的fetch_page+unpin_page次数
+ */
+double run_bench(DiskManager *disk_manager, int fd, size_t num_shards, int num_threads, int ops_per_thread) {
+    auto bpm = std::make_unique<BufferPoolManager>(BENCH_NUM_PAGES, disk_manager, num_shards);
+    // 预热：把所有页面载入缓冲池，保证之后的访问全部命中
+    for (int i = 0; i < BENCH_NUM_PAGES; i++) {
+        Page *page = bpm->fetch_page(PageId{fd, i});
+        if (page == nullptr) {
+            fprintf(stderr, "warm up failed at page %d\n", i);
+            exit(1);
+        }
+        bpm->unpin_page(PageId{fd, i}, false);
+    }
+
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int tid = 0; tid < num_threads; tid++) {
+        threads.emplace_back([&bpm, fd, tid, ops_per_thread]() {
+            std::mt19937 rng(tid);
+            for (int i = 0; i < ops_per_thread; i++) {
+                PageId page_id{fd, static_cast<page_id_t>(rng() % BENCH_NUM_PAGES)};
+                bpm->fetch_page(page_id);
+                bpm->unpin_page(page_id, false);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(num_threads) * ops_per_thread / elapsed.count();
+}
+
+int main(int argc, char **argv) {
+    int ops_per_thread = argc > 1 ? atoi(argv[1]) : 200000;
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    if (disk_manager->is_dir(BENCH_DB_NAME)) {
+        disk_manager->destroy_dir(BENCH_DB_NAME);
+    }
+    disk_manager->create_dir(BENCH_DB_NAME);
+    if (chdir(BENCH_DB_NAME.c_str()) < 0) {
+        throw UnixError();
+    }
+
+    const std::string filename = "bench_file";
+    disk_manager->create_file(filename);
+    int fd = disk_manager->open_file(filename);
+    char buf[PAGE_SIZE] = {0};
+    for (int i = 0; i < BENCH_NUM_PAGES; i++) {
+        disk_manager->write_page(fd, i, buf, PAGE_SIZE);
+    }
+
+    int max_threads = argc > 2 ? atoi(argv[2]) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    printf("%8s %8s %16s\n", "shards", "threads", "ops/s");
+    for (size_t num_shards : {1, 4, 16, 64}) {
+        for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+            double ops = run_bench(disk_manager.get(), fd, num_shards, num_threads, ops_per_thread);
+            printf("%8zu %8d %16.0f\n", num_shards, num_threads, ops);
+        }
+    }
+
+    disk_manager->close_file(fd);
+    if (chdir("..") < 0) {
+        throw UnixError();
+    }
+    disk_manager->destroy_dir(BENCH_DB_NAME);
+    return 0;
+}
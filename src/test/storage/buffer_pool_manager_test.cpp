@@ -1,10 +1,13 @@
 #include "storage/buffer_pool_manager.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <ctime>
+#include <random>
 #include <string>
 #include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
@@ -15,6 +18,10 @@ constexpr int MAX_PAGES = 128;
 constexpr size_t TEST_BUFFER_POOL_SIZE = MAX_FILES * MAX_PAGES;
 const std::string TEST_DB_NAME = "BufferPoolManagerTest_db";  // 以TEST_DB_NAME作为存放测试文件的根目录名
 
+// 读写句柄不能被切片成只unpin不解锁的PageGuard
+static_assert(!std::is_convertible<ReadPageGuard *, PageGuard *>::value, "ReadPageGuard must not slice to PageGuard");
+static_assert(!std::is_convertible<WritePageGuard *, PageGuard *>::value, "WritePageGuard must not slice to PageGuard");
+
 // Add by jiawen
 class BufferPoolManagerTest : public ::testing::Test {
    public:
@@ -427,3 +434,640 @@ TEST_F(BufferPoolManagerTest, ConcurrencyTest) {
 
     disk_manager_->close_file(fd);
 }
+
+/**
+ * @brief 分片缓冲池测试（单文件），页面换入换出后数据不变，并发命中时pin/unpin计数正确
+ * @note 生成测试文件sharded_test
+ */
+TEST_F(BufferPoolManagerTest, ShardedTest) {
+    const int num_threads = 8;
+    const int num_pages = 500;
+    const size_t buffer_pool_size = 64;
+    const size_t num_shards = 4;
+
+    const std::string filename = "sharded_test";
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, num_shards);
+    EXPECT_EQ(num_shards, bpm->get_num_shards());
+
+    // 页面数远大于帧数，每个分片都会发生淘汰
+    std::vector<PageId> page_ids;
+    for (int i = 0; i < num_pages; i++) {
+        PageId tmp_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&tmp_page_id);
+        ASSERT_NE(nullptr, page);
+        strcpy(page->get_data(), std::to_string(tmp_page_id.page_no).c_str());
+        EXPECT_EQ(true, bpm->unpin_page(tmp_page_id, true));
+        page_ids.push_back(tmp_page_id);
+    }
+    for (auto &page_id : page_ids) {
+        Page *page = bpm->fetch_page(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(0, std::strcmp(std::to_string(page_id.page_no).c_str(), page->get_data()));
+        EXPECT_EQ(true, bpm->unpin_page(page_id, false));
+    }
+
+    // 多线程反复访问一小批页面，结束后所有页面都应可以被删除（pin_count归零）
+    std::vector<PageId> hot_pages(page_ids.begin(), page_ids.begin() + buffer_pool_size / num_shards);
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+        threads.push_back(std::thread([&bpm, &hot_pages, tid]() {
+            for (int r = 0; r < 2000; r++) {
+                auto &page_id = hot_pages[(r + tid) % hot_pages.size()];
+                Page *page = bpm->fetch_page(page_id);
+                while (page == nullptr) {
+                    page = bpm->fetch_page(page_id);
+                }
+                EXPECT_EQ(0, std::strcmp(std::to_string(page_id.page_no).c_str(), page->get_data()));
+                EXPECT_EQ(true, bpm->unpin_page(page_id, false));
+            }
+        }));
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    bpm->flush_all_pages(fd);
+    for (auto &page_id : page_ids) {
+        EXPECT_EQ(true, bpm->delete_page(page_id));
+    }
+
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief new_page失败时释放已分配的页号；复用的页号在缓冲池中还有被固定的旧帧时new_page失败，而不是为同一页号映射第二个帧
+ */
+TEST_F(BufferPoolManagerTest, NewPageFailureTest) {
+    const size_t buffer_pool_size = 8;
+    const size_t num_shards = 4;
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    disk_manager_->create_file("new_page_failure_test");
+    int fd = disk_manager_->open_file("new_page_failure_test");
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, num_shards);
+    std::vector<PageId> page_ids;
+    for (int i = 0; i < 100; i++) {
+        PageId tmp_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&tmp_page_id);
+        if (page != nullptr) page_ids.push_back(tmp_page_id);
+    }
+    // 页号所在分片的帧都被固定时new_page失败，失败的new_page不会占用页号
+    EXPECT_LE(page_ids.size(), buffer_pool_size);
+    EXPECT_EQ(static_cast<page_id_t>(page_ids.size()), disk_manager_->get_fd2pageno(fd));
+    for (auto &page_id : page_ids) {
+        EXPECT_EQ(true, bpm->unpin_page(page_id, false));
+    }
+
+    // 页号在其页面仍被固定时被释放，再次分配到该页号时new_page失败
+    PageId pinned_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+    Page *pinned_page = bpm->new_page(&pinned_page_id);
+    ASSERT_NE(nullptr, pinned_page);
+    disk_manager_->deallocate_page(fd, pinned_page_id.page_no);
+    PageId tmp_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+    EXPECT_EQ(nullptr, bpm->new_page(&tmp_page_id));
+    EXPECT_EQ(pinned_page, bpm->fetch_page(pinned_page_id));
+    EXPECT_EQ(true, bpm->unpin_page(pinned_page_id, false));
+    EXPECT_EQ(true, bpm->unpin_page(pinned_page_id, false));
+
+    // 旧帧被释放后可以正常复用该页号，页面只对应一个帧
+    Page *page = bpm->new_page(&tmp_page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(pinned_page_id, tmp_page_id);
+    EXPECT_EQ(1u, bpm->get_stats().pinned_pages_);
+    EXPECT_EQ(true, bpm->unpin_page(tmp_page_id, false));
+    EXPECT_EQ(false, bpm->unpin_page(tmp_page_id, false));
+
+    bpm.reset();
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 帧数远小于页面数时多线程随机读写页面：淘汰写回与读入在分片锁之外进行，
+ * 所有线程对页面内计数器的累加都不能丢失
+ */
+TEST_F(BufferPoolManagerTest, EvictionConcurrencyTest) {
+    const int num_threads = 8;
+    const int num_pages = 200;
+    const int num_rounds = 1000;
+    const size_t buffer_pool_size = 16;
+
+    const std::string filename = "eviction_concurrency_test";
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager);
+    for (int i = 0; i < num_pages; i++) {
+        PageId tmp_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&tmp_page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(true, bpm->unpin_page(tmp_page_id, true));
+    }
+
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+        threads.push_back(std::thread([&bpm, fd, tid]() {
+            std::mt19937 rng(tid);
+            for (int r = 0; r < num_rounds; r++) {
+                PageId page_id = {.fd = fd, .page_no = static_cast<page_id_t>(rng() % num_pages)};
+                Page *page = bpm->fetch_page(page_id);
+                while (page == nullptr) {
+                    page = bpm->fetch_page(page_id);
+                }
+                page->write_latch();
+                reinterpret_cast<int *>(page->get_data())[0]++;
+                page->write_unlatch();
+                EXPECT_EQ(true, bpm->unpin_page(page_id, true));
+            }
+        }));
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    int total = 0;
+    for (int i = 0; i < num_pages; i++) {
+        Page *page = bpm->fetch_page(PageId{fd, i});
+        ASSERT_NE(nullptr, page);
+        total += reinterpret_cast<int *>(page->get_data())[0];
+        EXPECT_EQ(true, bpm->unpin_page(PageId{fd, i}, false));
+    }
+    EXPECT_EQ(num_threads * num_rounds, total);
+
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 开启后台刷盘线程后多线程随机读写页面：后台线程提前写回脏页，
+ * 与前台淘汰写回交错进行时页面内计数器的累加不能丢失
+ */
+TEST_F(BufferPoolManagerTest, BackgroundFlusherTest) {
+    const int num_threads = 4;
+    const int num_pages = 200;
+    const int num_rounds = 1000;
+    const size_t buffer_pool_size = 32;
+    const size_t num_shards = 2;
+
+    const std::string filename = "background_flusher_test";
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, num_shards);
+    std::vector<PageId> page_ids;
+    for (int i = 0; i < num_pages; i++) {
+        PageId tmp_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&tmp_page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(true, bpm->unpin_page(tmp_page_id, true));
+        page_ids.push_back(tmp_page_id);
+    }
+    bpm->start_background_flusher(0.5, 1);
+
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+        threads.push_back(std::thread([&bpm, &page_ids, tid]() {
+            std::mt19937 rng(tid);
+            for (int r = 0; r < num_rounds; r++) {
+                PageId page_id = page_ids[rng() % num_pages];
+                Page *page = bpm->fetch_page(page_id);
+                while (page == nullptr) {
+                    page = bpm->fetch_page(page_id);
+                }
+                page->write_latch();
+                reinterpret_cast<int *>(page->get_data())[0]++;
+                page->write_unlatch();
+                EXPECT_EQ(true, bpm->unpin_page(page_id, true));
+            }
+        }));
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    // 留出时间让后台线程把剩余的脏页写回，直到达到干净帧的目标比例
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    bpm->stop_background_flusher();
+    EXPECT_GT(bpm->get_background_writes(), 0u);
+
+    int total = 0;
+    for (auto &page_id : page_ids) {
+        Page *page = bpm->fetch_page(page_id);
+        ASSERT_NE(nullptr, page);
+        total += reinterpret_cast<int *>(page->get_data())[0];
+        EXPECT_EQ(true, bpm->unpin_page(page_id, false));
+    }
+    EXPECT_EQ(num_threads * num_rounds, total);
+
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 顺序读取一个文件：检测到顺序访问后缓冲池异步预读后续页面，读到的内容必须与写入的一致
+ */
+TEST_F(BufferPoolManagerTest, ReadAheadTest) {
+    const int num_pages = 300;
+    const size_t buffer_pool_size = 64;
+
+    const std::string filename = "read_ahead_test";
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    {
+        auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager);
+        for (int i = 0; i < num_pages; i++) {
+            PageId tmp_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            Page *page = bpm->new_page(&tmp_page_id);
+            ASSERT_NE(nullptr, page);
+            strcpy(page->get_data(), std::to_string(tmp_page_id.page_no).c_str());
+            EXPECT_EQ(true, bpm->unpin_page(tmp_page_id, true));
+        }
+        bpm->flush_all_pages(fd);
+    }
+
+    // 两个分片，保证预读的页面分布在不同分片时也能被正确访问
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, 2);
+    // 顺序访问开头几个页面后，预读线程应当在后台载入后续页面
+    for (int i = 0; i < READ_AHEAD_TRIGGER + 1; i++) {
+        Page *page = bpm->fetch_page(PageId{fd, i});
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(true, bpm->unpin_page(PageId{fd, i}, false));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_GT(bpm->get_prefetched_pages(), 0u);
+
+    for (int round = 0; round < 2; round++) {
+        for (int i = 0; i < num_pages; i++) {
+            Page *page = bpm->fetch_page(PageId{fd, i});
+            while (page == nullptr) {
+                page = bpm->fetch_page(PageId{fd, i});
+            }
+            EXPECT_EQ(0, std::strcmp(std::to_string(i).c_str(), page->get_data()));
+            EXPECT_EQ(true, bpm->unpin_page(PageId{fd, i}, false));
+        }
+    }
+
+    // 关闭预读后，预读页面数不再增加
+    bpm->set_read_ahead_window(0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    size_t prefetched = bpm->get_prefetched_pages();
+    for (int i = 0; i < num_pages; i++) {
+        Page *page = bpm->fetch_page(PageId{fd, i});
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(true, bpm->unpin_page(PageId{fd, i}, false));
+    }
+    EXPECT_EQ(prefetched, bpm->get_prefetched_pages());
+
+    bpm.reset();
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 通过私有帧环顺序扫描远大于缓冲池的文件后，扫描之前载入的热点页面仍然留在缓冲池中
+ */
+TEST_F(BufferPoolManagerTest, BufferRingTest) {
+    const int num_pages = 500;
+    const int num_hot = 32;
+    const size_t buffer_pool_size = 64;
+
+    const std::string filename = "buffer_ring_test";
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager);
+    bpm->set_read_ahead_window(0);
+    for (int i = 0; i < num_pages; i++) {
+        PageId tmp_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&tmp_page_id);
+        ASSERT_NE(nullptr, page);
+        strcpy(page->get_data(), std::to_string(tmp_page_id.page_no).c_str());
+        EXPECT_EQ(true, bpm->unpin_page(tmp_page_id, true));
+    }
+    bpm->flush_all_pages(fd);
+
+    // 载入热点页面
+    for (int i = 0; i < num_hot; i++) {
+        Page *page = bpm->fetch_page(PageId{fd, i});
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(true, bpm->unpin_page(PageId{fd, i}, false));
+    }
+
+    // 通过帧环扫描其余页面，读到的内容必须正确
+    auto ring = bpm->make_ring(8);
+    for (int round = 0; round < 2; round++) {
+        for (int i = num_hot; i < num_pages; i++) {
+            Page *page = bpm->fetch_page(PageId{fd, i}, ring.get());
+            ASSERT_NE(nullptr, page);
+            EXPECT_EQ(0, std::strcmp(std::to_string(i).c_str(), page->get_data()));
+            EXPECT_EQ(true, bpm->unpin_page(PageId{fd, i}, false));
+        }
+    }
+
+    // 直接改写磁盘上的热点页面：若热点页面仍在缓冲池中，fetch_page读到的是缓冲池中的旧内容
+    char buf[PAGE_SIZE] = {0};
+    for (int i = 0; i < num_hot; i++) {
+        disk_manager_->write_page(fd, i, buf, PAGE_SIZE);
+    }
+    for (int i = 0; i < num_hot; i++) {
+        Page *page = bpm->fetch_page(PageId{fd, i});
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(0, std::strcmp(std::to_string(i).c_str(), page->get_data()));
+        EXPECT_EQ(true, bpm->unpin_page(PageId{fd, i}, false));
+    }
+
+    // 打开预读后再通过帧环扫描，不会预读页面，热点页面仍然驻留在缓冲池中
+    bpm->set_read_ahead_window(READ_AHEAD_WINDOW);
+    for (int i = num_hot; i < num_pages; i++) {
+        ASSERT_NE(nullptr, bpm->fetch_page(PageId{fd, i}, ring.get()));
+        EXPECT_EQ(true, bpm->unpin_page(PageId{fd, i}, false));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(0u, bpm->get_prefetched_pages());
+    std::vector<PageId> resident = bpm->get_resident_pages();
+    for (int i = 0; i < num_hot; i++) {
+        EXPECT_TRUE(std::find(resident.begin(), resident.end(), PageId{fd, i}) != resident.end());
+    }
+
+    bpm.reset();
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 帧数据按PAGE_SIZE对齐；在线扩大后可以同时固定更多页面，缩小时被固定的页面不会被移除，脏页写回磁盘
+ */
+TEST_F(BufferPoolManagerTest, ResizeTest) {
+    const size_t buffer_pool_size = 16;
+    const size_t max_pool_size = 64;
+
+    const std::string filename = "resize_test";
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, 4, REPLACER_TYPE, max_pool_size);
+    bpm->set_read_ahead_window(0);
+    EXPECT_EQ(buffer_pool_size, bpm->get_pool_size());
+
+    // 固定页面直到缓冲池被占满
+    std::vector<PageId> page_ids;
+    while (true) {
+        PageId tmp_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&tmp_page_id);
+        if (page == nullptr) break;
+        EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(page->get_data()) % PAGE_SIZE);
+        strcpy(page->get_data(), std::to_string(tmp_page_id.page_no).c_str());
+        page_ids.push_back(tmp_page_id);
+    }
+    EXPECT_LE(page_ids.size(), buffer_pool_size);
+    EXPECT_FALSE(bpm->resize(max_pool_size + 1));
+
+    // 扩大后可以固定更多页面
+    EXPECT_TRUE(bpm->resize(max_pool_size));
+    EXPECT_EQ(max_pool_size, bpm->get_pool_size());
+    size_t pinned = page_ids.size();
+    while (true) {
+        PageId tmp_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&tmp_page_id);
+        if (page == nullptr) break;
+        EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(page->get_data()) % PAGE_SIZE);
+        strcpy(page->get_data(), std::to_string(tmp_page_id.page_no).c_str());
+        page_ids.push_back(tmp_page_id);
+    }
+    EXPECT_GT(page_ids.size(), pinned);
+
+    // 至少有一个分片的帧全部被固定，缩小失败，该分片保持原来的大小
+    EXPECT_FALSE(bpm->resize(buffer_pool_size));
+    EXPECT_GT(bpm->get_pool_size(), buffer_pool_size);
+
+    // 释放所有页面后缩小成功，脏页被写回磁盘，之后仍能读到正确的内容
+    for (auto &page_id : page_ids) {
+        EXPECT_EQ(true, bpm->unpin_page(page_id, true));
+    }
+    EXPECT_TRUE(bpm->resize(buffer_pool_size));
+    EXPECT_EQ(buffer_pool_size, bpm->get_pool_size());
+    for (auto &page_id : page_ids) {
+        Page *page = bpm->fetch_page(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(0, std::strcmp(std::to_string(page_id.page_no).c_str(), page->get_data()));
+        EXPECT_EQ(true, bpm->unpin_page(page_id, false));
+    }
+
+    bpm.reset();
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief flush_all_pages只写回目标文件的脏页：其他文件的脏页仍留在缓冲池中，已经干净的页面不会被再次写回
+ */
+TEST_F(BufferPoolManagerTest, FlushAllPagesTest) {
+    const int num_pages = 64;
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    disk_manager_->create_file("flush_all_a");
+    disk_manager_->create_file("flush_all_b");
+    int fd_a = disk_manager_->open_file("flush_all_a");
+    int fd_b = disk_manager_->open_file("flush_all_b");
+
+    auto bpm = std::make_unique<BufferPoolManager>(4 * num_pages, disk_manager, 4);
+    bpm->set_read_ahead_window(0);
+    for (int fd : {fd_a, fd_b}) {
+        for (int i = 0; i < num_pages; i++) {
+            PageId tmp_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            Page *page = bpm->new_page(&tmp_page_id);
+            ASSERT_NE(nullptr, page);
+            strcpy(page->get_data(), (std::to_string(fd) + ":" + std::to_string(tmp_page_id.page_no)).c_str());
+            EXPECT_EQ(true, bpm->unpin_page(tmp_page_id, true));
+        }
+    }
+
+    bpm->flush_all_pages(fd_a);
+    char buf[PAGE_SIZE];
+    for (int i = 0; i < num_pages; i++) {
+        disk_manager_->read_page(fd_a, i, buf, PAGE_SIZE);
+        EXPECT_EQ(0, std::strcmp((std::to_string(fd_a) + ":" + std::to_string(i)).c_str(), buf));
+    }
+    // 文件b的脏页没有被写回
+    EXPECT_EQ(0, disk_manager_->get_file_size("flush_all_b"));
+    // 各文件的脏页链表随页面变脏、变干净维护
+    auto residency = bpm->get_file_residency();
+    EXPECT_EQ(static_cast<size_t>(num_pages), residency[fd_a].resident_pages_);
+    EXPECT_EQ(0u, residency[fd_a].dirty_pages_);
+    EXPECT_EQ(static_cast<size_t>(num_pages), residency[fd_b].dirty_pages_);
+    for (int i = 1; i < num_pages; i += 2) {
+        PageId page_id = {.fd = fd_a, .page_no = i};
+        ASSERT_NE(nullptr, bpm->fetch_page(page_id));
+        EXPECT_EQ(true, bpm->unpin_page(page_id, true));
+    }
+    residency = bpm->get_file_residency();
+    EXPECT_EQ(static_cast<size_t>(num_pages / 2), residency[fd_a].dirty_pages_);
+
+    // 直接改写磁盘上的页面，再次flush时干净页面不会覆盖磁盘上的内容
+    char zero[PAGE_SIZE] = {0};
+    disk_manager_->write_page(fd_a, 0, zero, PAGE_SIZE);
+    bpm->flush_all_pages(fd_a);
+    disk_manager_->read_page(fd_a, 0, buf, PAGE_SIZE);
+    EXPECT_EQ(0, std::memcmp(zero, buf, PAGE_SIZE));
+
+    bpm->flush_all_pages(fd_b);
+    for (int i = 0; i < num_pages; i++) {
+        disk_manager_->read_page(fd_b, i, buf, PAGE_SIZE);
+        EXPECT_EQ(0, std::strcmp((std::to_string(fd_b) + ":" + std::to_string(i)).c_str(), buf));
+    }
+
+    bpm.reset();
+    disk_manager_->close_file(fd_a);
+    disk_manager_->close_file(fd_b);
+}
+
+/**
+ * @brief 统计计数：命中、缺页、淘汰次数以及每个文件驻留的页面和脏页个数
+ */
+TEST_F(BufferPoolManagerTest, StatsTest) {
+    const int num_pages = 16;
+    const size_t buffer_pool_size = 8;
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    disk_manager_->create_file("stats_test");
+    int fd = disk_manager_->open_file("stats_test");
+    char buf[PAGE_SIZE] = {0};
+    for (int i = 0; i < num_pages; i++) {
+        disk_manager_->write_page(fd, i, buf, PAGE_SIZE);
+    }
+    disk_manager_->set_fd2pageno(fd, num_pages);
+    size_t disk_reads = disk_manager_->get_io_stats().reads_;
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager);
+    bpm->set_read_ahead_window(0);
+    for (int i = 0; i < num_pages; i++) {
+        ASSERT_NE(nullptr, bpm->fetch_page(PageId{fd, i}));
+        EXPECT_EQ(true, bpm->unpin_page(PageId{fd, i}, i % 2 == 0));
+    }
+    ASSERT_NE(nullptr, bpm->fetch_page(PageId{fd, num_pages - 1}));
+    EXPECT_EQ(true, bpm->unpin_page(PageId{fd, num_pages - 1}, false));
+
+    BufferPoolStats stats = bpm->get_stats();
+    EXPECT_EQ(1u, stats.hits_);
+    EXPECT_EQ(static_cast<size_t>(num_pages), stats.misses_);
+    EXPECT_EQ(num_pages - buffer_pool_size, stats.evictions_);
+    EXPECT_EQ(buffer_pool_size, stats.resident_pages_);
+    EXPECT_EQ(buffer_pool_size / 2, stats.dirty_pages_);
+    EXPECT_EQ(0u, stats.pinned_pages_);
+    EXPECT_EQ(num_pages, disk_manager_->get_io_stats().reads_ - disk_reads);
+
+    auto residency = bpm->get_file_residency();
+    EXPECT_EQ(buffer_pool_size, residency[fd].resident_pages_);
+    EXPECT_EQ(buffer_pool_size / 2, residency[fd].dirty_pages_);
+    bpm->flush_all_pages(fd);
+    residency = bpm->get_file_residency();
+    EXPECT_EQ(0u, residency[fd].dirty_pages_);
+
+    bpm.reset();
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 预热：记录一个缓冲池中的页面，在新的缓冲池中预热后，这些页面的访问全部命中
+ */
+TEST_F(BufferPoolManagerTest, WarmRestartTest) {
+    const int num_pages = 64;
+    const size_t buffer_pool_size = 16;
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    disk_manager_->create_file("warm_restart_test");
+    int fd = disk_manager_->open_file("warm_restart_test");
+    char buf[PAGE_SIZE] = {0};
+    for (int i = 0; i < num_pages; i++) {
+        disk_manager_->write_page(fd, i, buf, PAGE_SIZE);
+    }
+    disk_manager_->set_fd2pageno(fd, num_pages);
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, 4);
+    bpm->set_read_ahead_window(0);
+    std::vector<page_id_t> hot_pages = {40, 3, 4, 5, 6, 7, 21, 22};
+    for (page_id_t page_no : hot_pages) {
+        ASSERT_NE(nullptr, bpm->fetch_page(PageId{fd, page_no}));
+        EXPECT_EQ(true, bpm->unpin_page(PageId{fd, page_no}, false));
+    }
+    std::vector<PageId> resident = bpm->get_resident_pages();
+    ASSERT_EQ(hot_pages.size(), resident.size());
+    std::sort(hot_pages.begin(), hot_pages.end());
+    for (size_t i = 0; i < resident.size(); i++) {
+        EXPECT_EQ(fd, resident[i].fd);
+        EXPECT_EQ(hot_pages[i], resident[i].page_no);
+    }
+    bpm.reset();
+
+    bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager, 4);
+    bpm->set_read_ahead_window(0);
+    // 5个连续页面超过单次预读的上限(4)，需要拆分为两次预读
+    bpm->warm_up(resident);
+    for (int i = 0; i < 100 && bpm->get_stats().resident_pages_ < resident.size(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(resident, bpm->get_resident_pages());
+    for (auto &page_id : resident) {
+        ASSERT_NE(nullptr, bpm->fetch_page(page_id));
+        EXPECT_EQ(true, bpm->unpin_page(page_id, false));
+    }
+    EXPECT_EQ(0u, bpm->get_stats().misses_);
+
+    bpm.reset();
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 已被固定的页面走无锁的命中路径：多线程反复访问同一个被固定的页面，同时其他页面不断被换入换出，
+ * 固定计数最终恢复原值，页面不会被淘汰
+ */
+TEST_F(BufferPoolManagerTest, PinnedHitTest) {
+    const int num_threads = 8;
+    const int num_pages = 64;
+    const int num_rounds = 2000;
+    const size_t buffer_pool_size = 16;
+    auto disk_manager = BufferPoolManagerTest::disk_manager_.get();
+    disk_manager_->create_file("pinned_hit_test");
+    int fd = disk_manager_->open_file("pinned_hit_test");
+
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager);
+    bpm->set_read_ahead_window(0);
+    for (int i = 0; i < num_pages; i++) {
+        PageId tmp_page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&tmp_page_id);
+        ASSERT_NE(nullptr, page);
+        reinterpret_cast<int *>(page->get_data())[0] = i;
+        EXPECT_EQ(true, bpm->unpin_page(tmp_page_id, true));
+    }
+    PageId hot_page_id = {.fd = fd, .page_no = 0};
+    Page *hot_page = bpm->fetch_page(hot_page_id);
+    ASSERT_NE(nullptr, hot_page);
+
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+        threads.push_back(std::thread([&bpm, fd, tid, hot_page, hot_page_id]() {
+            std::mt19937 rng(tid);
+            for (int r = 0; r < num_rounds; r++) {
+                EXPECT_EQ(hot_page, bpm->fetch_page(hot_page_id));
+                PageId page_id = {.fd = fd, .page_no = static_cast<page_id_t>(1 + rng() % (num_pages - 1))};
+                Page *page = bpm->fetch_page(page_id);
+                if (page != nullptr) {
+                    EXPECT_EQ(page_id.page_no, reinterpret_cast<int *>(page->get_data())[0]);
+                    EXPECT_EQ(true, bpm->unpin_page(page_id, false));
+                }
+                EXPECT_EQ(true, bpm->unpin_page(hot_page_id, false));
+            }
+        }));
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(1u, bpm->get_stats().pinned_pages_);
+    EXPECT_EQ(true, bpm->unpin_page(hot_page_id, false));
+    EXPECT_EQ(false, bpm->unpin_page(hot_page_id, false));
+    EXPECT_EQ(0u, bpm->get_stats().pinned_pages_);
+
+    bpm.reset();
+    disk_manager_->close_file(fd);
+}
@@ -147,3 +147,146 @@ TEST_F(DiskManagerTest, PageOperation) {
     disk_manager_->destroy_file(filename);
     EXPECT_EQ(disk_manager_->is_file(filename), false);
 }
+
+/**
+ * @brief 测试批量读写页面 read_pages/write_pages：乱序、部分连续的页号需要被正确合并与拆分
+ */
+TEST_F(DiskManagerTest, BatchPageOperation) {
+    const std::string filename = "BatchPageOperationTestFile";
+    if (disk_manager_->is_file(filename)) {
+        disk_manager_->destroy_file(filename);
+    }
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    // 页号乱序且部分连续：{0,1,2,3}、{7,8}、{20}、{MAX_PAGES-1}
+    std::vector<page_id_t> page_nos = {8, 2, 0, 20, 3, 7, 1, MAX_PAGES - 1};
+    std::vector<std::vector<char>> data(page_nos.size(), std::vector<char>(PAGE_SIZE));
+    std::vector<PageIORequest> requests;
+    for (size_t i = 0; i < page_nos.size(); i++) {
+        rand_buf(data[i].data(), PAGE_SIZE);
+        data[i][0] = static_cast<char>(i);
+        requests.push_back(PageIORequest{page_nos[i], data[i].data()});
+    }
+    disk_manager_->write_pages(fd, requests.data(), static_cast<int>(requests.size()));
+
+    // 逐页读回检查
+    char buf[PAGE_SIZE] = {0};
+    for (size_t i = 0; i < page_nos.size(); i++) {
+        disk_manager_->read_page(fd, page_nos[i], buf, PAGE_SIZE);
+        EXPECT_EQ(std::memcmp(buf, data[i].data(), PAGE_SIZE), 0);
+    }
+
+    // 批量读回检查
+    std::vector<std::vector<char>> out(page_nos.size(), std::vector<char>(PAGE_SIZE));
+    requests.clear();
+    for (size_t i = 0; i < page_nos.size(); i++) {
+        requests.push_back(PageIORequest{page_nos[i], out[i].data()});
+    }
+    disk_manager_->read_pages(fd, requests.data(), static_cast<int>(requests.size()));
+    for (size_t i = 0; i < page_nos.size(); i++) {
+        EXPECT_EQ(out[i], data[i]);
+    }
+
+    // 读取超出文件末尾的页面时报错
+    char tail[PAGE_SIZE];
+    PageIORequest past_end{MAX_PAGES, tail};
+    EXPECT_THROW(disk_manager_->read_pages(fd, &past_end, 1), InternalError);
+
+    disk_manager_->close_file(fd);
+    disk_manager_->destroy_file(filename);
+}
+
+/**
+ * @brief 测试释放页号 deallocate_page：释放的页号被优先复用，释放文件末尾的页面时文件被截断
+ */
+TEST_F(DiskManagerTest, DeallocatePage) {
+    const std::string filename = "DeallocatePageTestFile";
+    if (disk_manager_->is_file(filename)) {
+        disk_manager_->destroy_file(filename);
+    }
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    disk_manager_->set_fd2pageno(fd, 0);
+
+    char data[PAGE_SIZE] = {0};
+    for (int page_no = 0; page_no < 10; page_no++) {
+        EXPECT_EQ(disk_manager_->allocate_page(fd), page_no);
+        disk_manager_->write_page(fd, page_no, data, PAGE_SIZE);
+    }
+
+    // 释放中间的页号后，分配时按从小到大的顺序复用
+    disk_manager_->deallocate_page(fd, 5);
+    disk_manager_->deallocate_page(fd, 2);
+    disk_manager_->deallocate_page(fd, 2);  // 重复释放被忽略
+    EXPECT_EQ(disk_manager_->allocate_page(fd), 2);
+    EXPECT_EQ(disk_manager_->allocate_page(fd), 5);
+    EXPECT_EQ(disk_manager_->allocate_page(fd), 10);
+
+    // 释放末尾连续的页面：分配位置回退，文件被截断
+    disk_manager_->deallocate_page(fd, 8);
+    EXPECT_EQ(disk_manager_->get_file_size(filename), 10 * PAGE_SIZE);
+    disk_manager_->deallocate_page(fd, 10);
+    disk_manager_->deallocate_page(fd, 9);
+    EXPECT_EQ(disk_manager_->get_fd2pageno(fd), 8);
+    EXPECT_EQ(disk_manager_->get_file_size(filename), 8 * PAGE_SIZE);
+    EXPECT_EQ(disk_manager_->allocate_page(fd), 8);
+
+    disk_manager_->close_file(fd);
+    disk_manager_->destroy_file(filename);
+}
+
+/**
+ * @brief 测试O_DIRECT模式：对齐与未对齐的缓冲区、只写页面开头部分数据、批量读写都能得到正确结果
+ */
+TEST_F(DiskManagerTest, DirectIOOperation) {
+    const std::string filename = "DirectIOOperationTestFile";
+    if (disk_manager_->is_file(filename)) {
+        disk_manager_->destroy_file(filename);
+    }
+    disk_manager_->create_file(filename);
+    disk_manager_->set_direct_io(true);
+    int fd = disk_manager_->open_file(filename);
+    disk_manager_->set_direct_io(false);
+
+    // 对齐的整页读写
+    alignas(PAGE_SIZE) static char aligned[PAGE_SIZE];
+    alignas(PAGE_SIZE) static char aligned_out[PAGE_SIZE];
+    rand_buf(aligned, PAGE_SIZE);
+    disk_manager_->write_page(fd, 0, aligned, PAGE_SIZE);
+    disk_manager_->read_page(fd, 0, aligned_out, PAGE_SIZE);
+    EXPECT_EQ(std::memcmp(aligned, aligned_out, PAGE_SIZE), 0);
+
+    // 未对齐地只改写页面开头，页面其余部分保持不变
+    char header[37];
+    rand_buf(header, sizeof(header));
+    disk_manager_->write_page(fd, 0, header, sizeof(header));
+    char header_out[sizeof(header)];
+    disk_manager_->read_page(fd, 0, header_out, sizeof(header_out));
+    EXPECT_EQ(std::memcmp(header, header_out, sizeof(header)), 0);
+    disk_manager_->read_page(fd, 0, aligned_out, PAGE_SIZE);
+    EXPECT_EQ(std::memcmp(header, aligned_out, sizeof(header)), 0);
+    EXPECT_EQ(std::memcmp(aligned + sizeof(header), aligned_out + sizeof(header), PAGE_SIZE - sizeof(header)), 0);
+
+    // 批量读写中混有未对齐的缓冲区
+    std::vector<std::vector<char>> data(4, std::vector<char>(PAGE_SIZE + 1));
+    std::vector<PageIORequest> requests;
+    for (int i = 0; i < 4; i++) {
+        rand_buf(data[i].data() + 1, PAGE_SIZE);
+        requests.push_back(PageIORequest{i + 1, data[i].data() + 1});
+    }
+    disk_manager_->write_pages(fd, requests.data(), static_cast<int>(requests.size()));
+    std::vector<std::vector<char>> out(4, std::vector<char>(PAGE_SIZE + 1));
+    requests.clear();
+    for (int i = 0; i < 4; i++) {
+        requests.push_back(PageIORequest{i + 1, out[i].data() + 1});
+    }
+    disk_manager_->read_pages(fd, requests.data(), static_cast<int>(requests.size()));
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(std::memcmp(out[i].data() + 1, data[i].data() + 1, PAGE_SIZE), 0);
+    }
+
+    disk_manager_->close_file(fd);
+    EXPECT_EQ(disk_manager_->is_direct_io(fd), false);
+    disk_manager_->destroy_file(filename);
+}
@@ -0,0 +1,117 @@
+#include "storage/page_table.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/**
+ * @brief 插入、更新、删除与std::unordered_map的结果一致，删除时的backward shift不会让其他页面丢失
+ */
+TEST(PageTableTest, RandomOperationTest) {
+    const int num_frames = 64;
+    PageTable page_table;
+    page_table.init(num_frames);
+    std::unordered_map<PageId, frame_id_t, PageIdHash> expected;
+
+    std::mt19937 rng(0);
+    for (int r = 0; r < 100000; r++) {
+        // 大页号与小fd组合，旧的(fd << 16) | page_no哈希在这里会冲突
+        PageId page_id{static_cast<int>(rng() % 4), static_cast<page_id_t>((rng() % 32) << 16)};
+        if (expected.size() < static_cast<size_t>(num_frames) && rng() % 2 == 0) {
+            frame_id_t frame_id = static_cast<frame_id_t>(rng() % num_frames);
+            page_table.insert(page_id, frame_id);
+            expected[page_id] = frame_id;
+        } else {
+            page_table.erase(page_id);
+            expected.erase(page_id);
+        }
+        ASSERT_EQ(expected.size(), page_table.size());
+    }
+    for (auto &[page_id, frame_id] : expected) {
+        EXPECT_EQ(frame_id, page_table.find(page_id));
+    }
+    size_t visited = 0;
+    page_table.for_each([&](const PageId &page_id, frame_id_t frame_id) {
+        EXPECT_EQ(expected[page_id], frame_id);
+        visited++;
+    });
+    EXPECT_EQ(expected.size(), visited);
+    EXPECT_EQ(INVALID_FRAME_ID, page_table.find(PageId{4, 0}));
+}
+
+/**
+ * @brief 哈希值的高位和低位都分布均匀：fd不同而page_no相差1 << 16的页面不再得到相同的哈希值
+ */
+TEST(PageTableTest, HashTest) {
+    EXPECT_NE(PageId({0, 1 << 16}).Get(), PageId({1, 0}).Get());
+    std::unordered_set<size_t> low_bits, high_bits;
+    for (int fd = 0; fd < 4; fd++) {
+        for (page_id_t page_no = 0; page_no < (1 << 20); page_no += 1 << 16) {
+            size_t h = PageIdHash()(PageId{fd, page_no});
+            low_bits.insert(h & 0xff);
+            high_bits.insert(h >> 56);
+        }
+    }
+    // 64个页面落入256个桶，分布均匀时不同的桶至少有50个
+    EXPECT_GE(low_bits.size(), 50u);
+    EXPECT_GE(high_bits.size(), 50u);
+}
+
+/**
+ * @brief 一个线程持锁不断插入删除，其他线程无锁查找始终存在的页面，版本号校验通过的结果都是正确的
+ */
+TEST(PageTableTest, OptimisticReadTest) {
+    const int num_frames = 256;
+    const int num_stable = 64;
+    PageTable page_table;
+    page_table.init(num_frames);
+    std::mutex latch;
+    for (int i = 0; i < num_stable; i++) {
+        page_table.insert(PageId{0, i}, i);
+    }
+
+    std::atomic<bool> stop = false;
+    std::thread writer([&]() {
+        std::mt19937 rng(1);
+        for (int r = 0; !stop; r++) {
+            // 间歇地修改，读者才有机会在两次修改之间完成查找
+            if (r % 64 == 0) std::this_thread::sleep_for(std::chrono::microseconds(50));
+            std::scoped_lock lock{latch};
+            PageId page_id{1, static_cast<page_id_t>(rng() % (num_frames - num_stable))};
+            if (page_table.count(page_id)) {
+                page_table.erase(page_id);
+            } else {
+                page_table.insert(page_id, num_stable + page_id.page_no);
+            }
+        }
+    });
+    std::vector<std::thread> readers;
+    std::atomic<size_t> validated = 0;
+    for (int tid = 0; tid < 4; tid++) {
+        readers.emplace_back([&, tid]() {
+            std::mt19937 rng(tid);
+            for (int r = 0; r < 200000; r++) {
+                PageId page_id{0, static_cast<page_id_t>(rng() % num_stable)};
+                uint64_t version;
+                frame_id_t frame_id;
+                if (page_table.find_optimistic(page_id, &version, &frame_id)) {
+                    ASSERT_EQ(page_id.page_no, frame_id);
+                    validated++;
+                }
+            }
+        });
+    }
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    stop = true;
+    writer.join();
+    EXPECT_GT(validated.load(), 0u);
+}
@@ -8,6 +8,8 @@
 #include <cstring>
 #include <ctime>
 #include <iostream>
+#include <random>
+#include <set>
 #include <unordered_map>
 
 #include "gtest/gtest.h"
@@ -58,6 +60,37 @@ void check_equal(const RmFileHandle *file_handle,
     assert(num_records == mock.size());
 }
 
+/**
+ * @brief 按64位处理的next_bit/first_bit/for_each_set_bit与逐位检查的结果一致，包括跨字节、跨字和末尾不足一个字的情况
+ */
+TEST(RecordManagerTest, BitmapTest) {
+    std::mt19937 rng(0);
+    char bm[512];
+    for (int round = 0; round < 200; round++) {
+        int max_n = 1 + rng() % (static_cast<int>(sizeof(bm)) * BITMAP_WIDTH);
+        Bitmap::init(bm, sizeof(bm));
+        // 稀疏、稠密和全满的bitmap
+        int density = round % 3 == 0 ? 2 : (round % 3 == 1 ? 50 : 100);
+        for (int i = 0; i < max_n; i++) {
+            if (static_cast<int>(rng() % 100) < density) Bitmap::set(bm, i);
+        }
+        for (int curr = -1; curr < max_n; curr++) {
+            for (bool bit : {false, true}) {
+                int expected = curr + 1;
+                while (expected < max_n && Bitmap::is_set(bm, expected) != bit) expected++;
+                ASSERT_EQ(expected, Bitmap::next_bit(bit, bm, max_n, curr));
+            }
+        }
+        EXPECT_EQ(Bitmap::next_bit(false, bm, max_n, -1), Bitmap::first_bit(false, bm, max_n));
+        std::vector<int> expected, actual;
+        for (int i = 0; i < max_n; i++) {
+            if (Bitmap::is_set(bm, i)) expected.push_back(i);
+        }
+        Bitmap::for_each_set_bit(bm, max_n, [&](int pos) { actual.push_back(pos); });
+        EXPECT_EQ(expected, actual);
+    }
+}
+
 // std::cout can call this, for example: std::cout << rid
 std::ostream &operator<<(std::ostream &os, const Rid &rid) {
     return os << '(' << rid.page_no << ", " << rid.slot_no << ')';
@@ -223,4 +256,293 @@ TEST(RecordManagerTest, MultipleFilesTest) {
         std::string filename = filenames[i];
         rm_manager->destroy_file(filename);
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 顺序扫描在页内迭代时复用页面的pin：每个数据页只经过一次缓冲池，record()读到的记录与get_record()一致
+ */
+TEST(RecordManagerTest, ScanPinReuseTest) {
+    char *result = new char[BUFFER_LENGTH];
+    int offset = 0;
+    Context *context = new Context(nullptr, nullptr, nullptr, result, &offset);
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::string filename = "scan_pin_reuse.txt";
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    rm_manager->create_file(filename, 64);
+    auto file_handle = rm_manager->open_file(filename);
+    char write_buf[PAGE_SIZE];
+    int num_records = file_handle->file_hdr_.num_records_per_page * 10;
+    for (int i = 0; i < num_records; i++) {
+        rand_buf(file_handle->file_hdr_.record_size, write_buf);
+        file_handle->insert_record(write_buf, context);
+    }
+    int num_data_pages = file_handle->file_hdr_.num_pages - RM_FIRST_RECORD_PAGE;
+
+    BufferPoolStats before = buffer_pool_manager->get_stats();
+    int scanned = 0;
+    std::vector<std::unique_ptr<RmRecord>> records;
+    for (RmScan scan(file_handle.get()); !scan.is_end(); scan.next()) {
+        records.push_back(scan.record());
+        scanned++;
+    }
+    BufferPoolStats after = buffer_pool_manager->get_stats();
+    EXPECT_EQ(num_records, scanned);
+    EXPECT_EQ(static_cast<size_t>(num_data_pages), after.hits_ + after.misses_ - before.hits_ - before.misses_);
+    EXPECT_EQ(0u, after.pinned_pages_);
+
+    int i = 0;
+    PageGuard guard;
+    for (RmScan scan(file_handle.get()); !scan.is_end(); scan.next(), i++) {
+        auto rec = file_handle->get_record(scan.rid(), context);
+        EXPECT_EQ(0, memcmp(rec->data, records[i]->data, file_handle->file_hdr_.record_size));
+        RmRecordView view = scan.record_view();
+        EXPECT_EQ(0, memcmp(view.data, records[i]->data, view.size));
+        view = file_handle->get_record_view(scan.rid(), &guard);
+        EXPECT_EQ(0, memcmp(view.data, records[i]->data, view.size));
+        EXPECT_EQ(0, memcmp(view.to_record()->data, records[i]->data, view.size));
+    }
+    guard.release();
+    EXPECT_EQ(0u, buffer_pool_manager->get_stats().pinned_pages_);
+
+    // 复制和移动
+    RmRecord copy = *records[0];
+    copy = *records[1];
+    EXPECT_EQ(0, memcmp(copy.data, records[1]->data, copy.size));
+    RmRecord moved = std::move(copy);
+    EXPECT_EQ(nullptr, copy.data);
+    EXPECT_EQ(0, memcmp(moved.data, records[1]->data, moved.size));
+    moved = *records[2];
+    EXPECT_EQ(0, memcmp(moved.data, records[2]->data, moved.size));
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 批量插入先填满已有页面的空闲slot，再依次使用新页面，返回的rid与记录顺序一致
+ */
+TEST(RecordManagerTest, BatchInsertTest) {
+    char *result = new char[BUFFER_LENGTH];
+    int offset = 0;
+    Context *context = new Context(nullptr, nullptr, nullptr, result, &offset);
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::string filename = "batch_insert.txt";
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    rm_manager->create_file(filename, 64);
+    auto file_handle = rm_manager->open_file(filename);
+    const int record_size = file_handle->file_hdr_.record_size;
+    const int per_page = file_handle->file_hdr_.num_records_per_page;
+
+    // 第一页写满后删除其中几条记录，留下空闲slot
+    char write_buf[PAGE_SIZE];
+    std::vector<Rid> first_page;
+    for (int i = 0; i < per_page; i++) {
+        rand_buf(record_size, write_buf);
+        first_page.push_back(file_handle->insert_record(write_buf, context));
+    }
+    std::set<int> holes = {1, per_page / 2, per_page - 1};
+    for (int slot_no : holes) {
+        file_handle->delete_record(first_page[slot_no], context);
+    }
+
+    int num_records = static_cast<int>(holes.size()) + per_page * 2 + 5;
+    std::vector<char> buf(static_cast<size_t>(num_records) * record_size);
+    rand_buf(static_cast<int>(buf.size()), buf.data());
+    std::vector<Rid> rids = file_handle->insert_records(buf.data(), num_records, context);
+    ASSERT_EQ(static_cast<size_t>(num_records), rids.size());
+
+    int i = 0;
+    for (int slot_no : holes) {
+        EXPECT_EQ(first_page[slot_no].page_no, rids[i].page_no);
+        EXPECT_EQ(slot_no, rids[i].slot_no);
+        i++;
+    }
+    std::set<std::pair<int, int>> seen;
+    for (i = 0; i < num_records; i++) {
+        EXPECT_TRUE(seen.insert({rids[i].page_no, rids[i].slot_no}).second);
+        auto rec = file_handle->get_record(rids[i], context);
+        EXPECT_EQ(0, memcmp(rec->data, buf.data() + static_cast<size_t>(i) * record_size, record_size));
+    }
+    EXPECT_EQ(RM_FIRST_RECORD_PAGE + 4, file_handle->file_hdr_.num_pages);
+    EXPECT_EQ(0u, buffer_pool_manager->get_stats().pinned_pages_);
+
+    // 最后一页未满，单条插入继续使用它
+    Rid rid = file_handle->insert_record(write_buf, context);
+    EXPECT_EQ(rids.back().page_no, rid.page_no);
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 批量装载直接写出满页，装载后的记录可以正常读取和扫描，最后一个未满的页面继续用于插入
+ */
+TEST(RecordManagerTest, BulkLoadTest) {
+    char *result = new char[BUFFER_LENGTH];
+    int offset = 0;
+    Context *context = new Context(nullptr, nullptr, nullptr, result, &offset);
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::string filename = "bulk_load.txt";
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    rm_manager->create_file(filename, 64);
+    auto file_handle = rm_manager->open_file(filename);
+    const int record_size = file_handle->file_hdr_.record_size;
+    const int per_page = file_handle->file_hdr_.num_records_per_page;
+
+    // 已有一个未满的页面，批量装载不使用它
+    char write_buf[PAGE_SIZE];
+    rand_buf(record_size, write_buf);
+    Rid first = file_handle->insert_record(write_buf, context);
+
+    int num_records = per_page * (LOAD_DATA_WRITE_PAGES + 2) + 7;
+    std::vector<char> buf(static_cast<size_t>(num_records) * record_size);
+    rand_buf(static_cast<int>(buf.size()), buf.data());
+    std::vector<Rid> rids = file_handle->bulk_load_records(buf.data(), num_records);
+    ASSERT_EQ(static_cast<size_t>(num_records), rids.size());
+    EXPECT_EQ(RM_FIRST_RECORD_PAGE + 1 + LOAD_DATA_WRITE_PAGES + 3, file_handle->file_hdr_.num_pages);
+    for (int i = 0; i < num_records; i++) {
+        EXPECT_EQ(first.page_no + 1 + i / per_page, rids[i].page_no);
+        EXPECT_EQ(i % per_page, rids[i].slot_no);
+        auto rec = file_handle->get_record(rids[i], context);
+        EXPECT_EQ(0, memcmp(rec->data, buf.data() + static_cast<size_t>(i) * record_size, record_size));
+    }
+    int scanned = 0;
+    for (RmScan scan(file_handle.get()); !scan.is_end(); scan.next()) {
+        scanned++;
+    }
+    EXPECT_EQ(num_records + 1, scanned);
+
+    // 插入先填满页号最小的未满页面，再使用最后装载的未满页面
+    for (int i = 0; i < per_page - 1; i++) {
+        EXPECT_EQ(first.page_no, file_handle->insert_record(write_buf, context).page_no);
+    }
+    EXPECT_EQ(rids.back().page_no, file_handle->insert_record(write_buf, context).page_no);
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 空闲空间映射：没有记录的页面被释放，文件末尾的页面被截断，中间的页面被重新分配，扫描跳过已释放的页面；
+ *        映射在关闭、重新打开文件后保持不变，释放时仍被固定的页面在关闭文件时释放
+ */
+TEST(RecordManagerTest, FreeSpaceMapTest) {
+    char *result = new char[BUFFER_LENGTH];
+    int offset = 0;
+    Context *context = new Context(nullptr, nullptr, nullptr, result, &offset);
+
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+
+    std::string filename = "free_space_map.txt";
+    if (disk_manager->is_file(filename)) {
+        disk_manager->destroy_file(filename);
+    }
+    rm_manager->create_file(filename, 64);
+    auto file_handle = rm_manager->open_file(filename);
+    const int record_size = file_handle->file_hdr_.record_size;
+    const int per_page = file_handle->file_hdr_.num_records_per_page;
+
+    // 写满5个数据页
+    const int num_data_pages = 5;
+    std::vector<char> buf(static_cast<size_t>(per_page) * num_data_pages * record_size);
+    rand_buf(static_cast<int>(buf.size()), buf.data());
+    std::vector<Rid> rids = file_handle->insert_records(buf.data(), per_page * num_data_pages, context);
+    ASSERT_EQ(RM_FIRST_RECORD_PAGE + num_data_pages, file_handle->file_hdr_.num_pages);
+    std::vector<std::vector<Rid>> pages(num_data_pages);
+    for (auto &rid : rids) {
+        pages[rid.page_no - RM_FIRST_RECORD_PAGE].push_back(rid);
+    }
+    auto count_records = [&]() {
+        int cnt = 0;
+        for (RmScan scan(file_handle.get()); !scan.is_end(); scan.next()) {
+            cnt++;
+        }
+        return cnt;
+    };
+
+    // 删空最后两个页面，文件被截断
+    for (int p = num_data_pages - 2; p < num_data_pages; p++) {
+        for (auto &rid : pages[p]) {
+            file_handle->delete_record(rid, context);
+        }
+    }
+    EXPECT_EQ(RM_FIRST_RECORD_PAGE + num_data_pages - 2, file_handle->file_hdr_.num_pages);
+    buffer_pool_manager->flush_all_pages(file_handle->fd_);
+    EXPECT_EQ((RM_FIRST_RECORD_PAGE + num_data_pages - 2) * PAGE_SIZE, disk_manager->get_file_size(filename));
+
+    // 删空中间的页面，扫描跳过它，且不再读入该页面
+    const int middle = RM_FIRST_RECORD_PAGE + 1;
+    for (auto &rid : pages[1]) {
+        file_handle->delete_record(rid, context);
+    }
+    EXPECT_TRUE(file_handle->is_free_page(middle));
+    EXPECT_EQ(RM_FIRST_RECORD_PAGE + num_data_pages - 2, file_handle->file_hdr_.num_pages);
+    EXPECT_EQ(RM_NO_PAGE, file_handle->file_hdr_.first_free_page_no);
+    BufferPoolStats before = buffer_pool_manager->get_stats();
+    EXPECT_EQ(per_page * 2, count_records());
+    BufferPoolStats after = buffer_pool_manager->get_stats();
+    EXPECT_EQ(2u, after.hits_ + after.misses_ - before.hits_ - before.misses_);
+    EXPECT_THROW(file_handle->get_record(pages[1][0], context), PageNotExistError);
+
+    // 关闭、重新打开后映射不变，新页面重用中间的页号
+    rm_manager->close_file(file_handle.get());
+    file_handle = rm_manager->open_file(filename);
+    EXPECT_TRUE(file_handle->is_free_page(middle));
+    EXPECT_EQ(per_page * 2, count_records());
+    char write_buf[PAGE_SIZE];
+    rand_buf(record_size, write_buf);
+    Rid rid = file_handle->insert_record(write_buf, context);
+    EXPECT_EQ(middle, rid.page_no);
+    EXPECT_FALSE(file_handle->is_free_page(middle));
+    EXPECT_EQ(RM_FIRST_RECORD_PAGE + num_data_pages - 2, file_handle->file_hdr_.num_pages);
+    EXPECT_EQ(0, memcmp(write_buf, file_handle->get_record(rid, context)->data, record_size));
+    EXPECT_EQ(per_page * 2 + 1, count_records());
+
+    // 扫描固定着页面时删空该页面，页面在关闭文件时释放
+    {
+        RmScan scan(file_handle.get());
+        ASSERT_EQ(RM_FIRST_RECORD_PAGE, scan.rid().page_no);
+        for (auto &r : pages[0]) {
+            file_handle->delete_record(r, context);
+        }
+        EXPECT_FALSE(file_handle->is_free_page(RM_FIRST_RECORD_PAGE));
+    }
+    rm_manager->close_file(file_handle.get());
+    file_handle = rm_manager->open_file(filename);
+    EXPECT_TRUE(file_handle->is_free_page(RM_FIRST_RECORD_PAGE));
+    EXPECT_EQ(per_page + 1, count_records());
+
+    // 没有映射文件时从数据页重建
+    rm_manager->close_file(file_handle.get());
+    disk_manager->destroy_file(RmManager::get_fsm_name(filename));
+    file_handle = rm_manager->open_file(filename);
+    EXPECT_EQ(RM_FIRST_RECORD_PAGE, file_handle->file_hdr_.first_free_page_no);
+    EXPECT_EQ(per_page + 1, count_records());
+    rm_manager->close_file(file_handle.get());
+    file_handle = rm_manager->open_file(filename);
+    EXPECT_TRUE(file_handle->is_free_page(RM_FIRST_RECORD_PAGE));
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+    EXPECT_FALSE(disk_manager->is_file(RmManager::get_fsm_name(filename)));
+}
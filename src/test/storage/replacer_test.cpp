@@ -0,0 +1,259 @@
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "replacer/clock_replacer.h"
+#include "replacer/lru_k_replacer.h"
+#include "replacer/two_queue_replacer.h"
+
+/**
+ * @brief CLOCK的二次机会：指针经过时引用位为1的frame被跳过一次
+ */
+TEST(ReplacerTest, ClockSimpleTest) {
+    ClockReplacer clock_replacer(7);
+
+    for (int i = 1; i <= 6; i++) {
+        clock_replacer.unpin(i);
+    }
+    clock_replacer.unpin(1);
+    EXPECT_EQ(6, clock_replacer.Size());
+
+    // 所有引用位均为1，第一圈清零，第二圈按指针顺序淘汰
+    int value;
+    EXPECT_EQ(true, clock_replacer.victim(&value));
+    EXPECT_EQ(1, value);
+    EXPECT_EQ(true, clock_replacer.victim(&value));
+    EXPECT_EQ(2, value);
+
+    // 被pin的frame不会被淘汰
+    clock_replacer.pin(3);
+    clock_replacer.pin(4);
+    EXPECT_EQ(2, clock_replacer.Size());
+
+    // 重新unpin的frame引用位为1，获得二次机会
+    clock_replacer.unpin(4);
+    EXPECT_EQ(true, clock_replacer.victim(&value));
+    EXPECT_EQ(5, value);
+    EXPECT_EQ(true, clock_replacer.victim(&value));
+    EXPECT_EQ(6, value);
+    EXPECT_EQ(true, clock_replacer.victim(&value));
+    EXPECT_EQ(4, value);
+    EXPECT_EQ(false, clock_replacer.victim(&value));
+    EXPECT_EQ(0, clock_replacer.Size());
+}
+
+/**
+ * @brief LRU-K：访问不足K次的frame先被淘汰，访问满K次的frame按第K次最近访问时间淘汰
+ */
+TEST(ReplacerTest, LRUKSimpleTest) {
+    LRUKReplacer lru_k_replacer(8, 2);
+
+    // frame 0、1 被访问两次，frame 2、3 只被访问一次
+    for (int i = 0; i < 4; i++) {
+        lru_k_replacer.pin(i);
+    }
+    lru_k_replacer.pin(1);
+    lru_k_replacer.pin(0);
+    for (int i = 0; i < 4; i++) {
+        lru_k_replacer.unpin(i);
+    }
+    EXPECT_EQ(4, lru_k_replacer.Size());
+
+    int value;
+    EXPECT_EQ(true, lru_k_replacer.victim(&value));
+    EXPECT_EQ(2, value);
+    EXPECT_EQ(true, lru_k_replacer.victim(&value));
+    EXPECT_EQ(3, value);
+    // frame 0 的第2次最近访问早于frame 1
+    EXPECT_EQ(true, lru_k_replacer.victim(&value));
+    EXPECT_EQ(0, value);
+    EXPECT_EQ(true, lru_k_replacer.victim(&value));
+    EXPECT_EQ(1, value);
+    EXPECT_EQ(false, lru_k_replacer.victim(&value));
+}
+
+/**
+ * @brief 2Q：一次性访问的frame留在A1中先被淘汰，相关访问期之外再次访问的frame晋升到Am
+ */
+TEST(ReplacerTest, TwoQueueSimpleTest) {
+    const int num_pages = 8;  // 相关访问期为2
+    TwoQueueReplacer two_queue_replacer(num_pages);
+
+    // frame 0 在相关访问期之外被再次访问，晋升为热点页面
+    two_queue_replacer.pin(0);
+    two_queue_replacer.unpin(0);
+    for (int i = 1; i < num_pages; i++) {
+        two_queue_replacer.pin(i);
+        two_queue_replacer.unpin(i);
+    }
+    two_queue_replacer.pin(0);
+    two_queue_replacer.unpin(0);
+    // frame 7 在相关访问期之内被再次访问，仍然留在A1
+    two_queue_replacer.pin(7);
+    two_queue_replacer.unpin(7);
+    EXPECT_EQ(num_pages, two_queue_replacer.Size());
+
+    // A1超过目标容量(2)时先淘汰A1，之后淘汰Am，Am为空后再淘汰A1中剩余的frame
+    int value;
+    for (int i = 1; i <= 5; i++) {
+        EXPECT_EQ(true, two_queue_replacer.victim(&value));
+        EXPECT_EQ(i, value);
+    }
+    EXPECT_EQ(true, two_queue_replacer.victim(&value));
+    EXPECT_EQ(0, value);
+    EXPECT_EQ(true, two_queue_replacer.victim(&value));
+    EXPECT_EQ(6, value);
+    EXPECT_EQ(true, two_queue_replacer.victim(&value));
+    EXPECT_EQ(7, value);
+    EXPECT_EQ(false, two_queue_replacer.victim(&value));
+}
+
+/**
+ * @brief remove()清空frame的访问历史：帧被回收后装入的新页面不能继承旧页面的热度
+ */
+TEST(ReplacerTest, RemoveTest) {
+    int value;
+
+    // LRU-K：frame 0 在回收前被访问过两次，回收后只被访问一次，应先于访问满两次的frame 1被淘汰
+    LRUKReplacer lru_k_replacer(4, 2);
+    lru_k_replacer.pin(1);
+    lru_k_replacer.unpin(1);
+    lru_k_replacer.pin(1);
+    lru_k_replacer.unpin(1);
+    lru_k_replacer.pin(0);
+    lru_k_replacer.unpin(0);
+    lru_k_replacer.pin(0);
+    lru_k_replacer.unpin(0);
+    lru_k_replacer.remove(0);
+    EXPECT_EQ(1, lru_k_replacer.Size());
+    lru_k_replacer.pin(0);
+    lru_k_replacer.unpin(0);
+    EXPECT_EQ(true, lru_k_replacer.victim(&value));
+    EXPECT_EQ(0, value);
+    EXPECT_EQ(true, lru_k_replacer.victim(&value));
+    EXPECT_EQ(1, value);
+
+    // 2Q：晋升到Am的frame 0被回收后重新进入A1，A1超过目标容量时先于Am中的frame 1被淘汰
+    const int num_pages = 8;  // 相关访问期为2
+    TwoQueueReplacer two_queue_replacer(num_pages);
+    for (int i = 0; i < 2; i++) {
+        two_queue_replacer.pin(i);
+        two_queue_replacer.unpin(i);
+    }
+    for (int i = 2; i < num_pages; i++) {
+        two_queue_replacer.pin(i);
+        two_queue_replacer.unpin(i);
+        two_queue_replacer.remove(i);
+    }
+    two_queue_replacer.pin(0);
+    two_queue_replacer.unpin(0);
+    two_queue_replacer.pin(1);
+    two_queue_replacer.unpin(1);
+    two_queue_replacer.remove(0);
+    EXPECT_EQ(1, two_queue_replacer.Size());
+    for (int i : {0, 2, 3}) {
+        two_queue_replacer.pin(i);
+        two_queue_replacer.unpin(i);
+    }
+    EXPECT_EQ(true, two_queue_replacer.victim(&value));
+    EXPECT_EQ(0, value);
+    EXPECT_EQ(true, two_queue_replacer.victim(&value));
+    EXPECT_EQ(1, value);
+
+    // CLOCK：被移除的frame不会再被淘汰
+    ClockReplacer clock_replacer(4);
+    clock_replacer.unpin(0);
+    clock_replacer.unpin(1);
+    clock_replacer.remove(0);
+    EXPECT_EQ(1, clock_replacer.Size());
+    EXPECT_EQ(true, clock_replacer.victim(&value));
+    EXPECT_EQ(1, value);
+    EXPECT_EQ(false, clock_replacer.victim(&value));
+}
+
+/**
+ * @brief 抗扫描测试：热点frame被反复访问后，一次覆盖其余所有frame的扫描不能把热点frame淘汰
+ */
+template <typename ReplacerT>
+void scan_resistance_test(ReplacerT *replacer, int num_pages, int num_hot) {
+    // 热点frame被访问两次，其余frame只在装入时被访问一次
+    for (int i = 0; i < num_pages; i++) {
+        replacer->pin(i);
+        replacer->unpin(i);
+    }
+    for (int i = 0; i < num_hot; i++) {
+        replacer->pin(i);
+        replacer->unpin(i);
+    }
+    // 扫描：每次淘汰一个frame装入新页面，访问一次后释放
+    for (int r = 0; r < 4 * num_pages; r++) {
+        int value;
+        ASSERT_EQ(true, replacer->victim(&value));
+        EXPECT_GE(value, num_hot);
+        replacer->pin(value);
+        replacer->unpin(value);
+    }
+}
+
+TEST(ReplacerTest, ScanResistanceTest) {
+    const int num_pages = 64;
+    const int num_hot = 8;
+    auto lru_k_replacer = std::make_unique<LRUKReplacer>(num_pages, 2);
+    scan_resistance_test(lru_k_replacer.get(), num_pages, num_hot);
+    auto two_queue_replacer = std::make_unique<TwoQueueReplacer>(num_pages);
+    scan_resistance_test(two_queue_replacer.get(), num_pages, num_hot);
+}
+
+/**
+ * @brief 三种replacer在多个线程中交替pin/unpin后，所有frame都恰好被淘汰一次。
+ * replacer自身不加锁，测试线程与缓冲池一样在外部锁内调用
+ */
+TEST(ReplacerTest, ConcurrencyTest) {
+    const int num_threads = 5;
+    const int value_size = 1000;
+    std::vector<std::unique_ptr<Replacer>> replacers;
+    replacers.emplace_back(new ClockReplacer(value_size));
+    replacers.emplace_back(new LRUKReplacer(value_size));
+    replacers.emplace_back(new TwoQueueReplacer(value_size));
+    for (auto &replacer : replacers) {
+        std::vector<int> value(value_size);
+        for (int i = 0; i < value_size; i++) {
+            value[i] = i;
+        }
+        auto rng = std::default_random_engine{};
+        std::shuffle(value.begin(), value.end(), rng);
+
+        std::mutex latch;
+        std::vector<std::thread> threads;
+        for (int tid = 0; tid < num_threads; tid++) {
+            threads.push_back(std::thread([tid, &replacer, &value, &latch]() {
+                int share = value_size / num_threads;
+                for (int i = 0; i < share; i++) {
+                    std::scoped_lock lock{latch};
+                    replacer->pin(value[tid * share + i]);
+                    replacer->unpin(value[tid * share + i]);
+                }
+            }));
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        int result;
+        std::vector<int> out_values;
+        for (int i = 0; i < value_size; i++) {
+            EXPECT_EQ(true, replacer->victim(&result));
+            out_values.push_back(result);
+        }
+        std::sort(value.begin(), value.end());
+        std::sort(out_values.begin(), out_values.end());
+        EXPECT_EQ(value, out_values);
+        EXPECT_EQ(false, replacer->victim(&result));
+    }
+}
@@ -0,0 +1,254 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "analyze/analyze.h"
+#include "execution/execution_manager.h"
+#include "index/ix_scan.h"
+#include "optimizer/optimizer.h"
+#include "optimizer/planner.h"
+#include "parser/parser.h"
+#include "portal.h"
+#include "record/rm_scan.h"
+#include "system/sm.h"
+
+const std::string TEST_DB_NAME = "SmManagerTest_db";  // 以数据库名作为根目录
+
+/** 每个测试点创建并打开数据库TEST_DB_NAME，结束时关闭并删除该数据库 */
+class SmManagerTest : public ::testing::Test {
+   public:
+    static constexpr size_t POOL_SIZE = 64;
+    static constexpr size_t MAX_POOL_SIZE = 256;
+
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<RmManager> rm_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<SmManager> sm_manager_;
+    std::unique_ptr<Planner> planner_;
+    std::unique_ptr<Optimizer> optimizer_;
+    std::unique_ptr<Portal> portal_;
+    std::unique_ptr<QlManager> ql_manager_;
+    char data_send_[BUFFER_LENGTH];
+    int offset_ = 0;
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(POOL_SIZE, disk_manager_.get(), 1, REPLACER_TYPE,
+                                                                   MAX_POOL_SIZE);
+        rm_manager_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_manager_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_manager_.get(),
+                                                  ix_manager_.get());
+        planner_ = std::make_unique<Planner>(sm_manager_.get());
+        optimizer_ = std::make_unique<Optimizer>(sm_manager_.get(), planner_.get());
+        portal_ = std::make_unique<Portal>(sm_manager_.get());
+        ql_manager_ = std::make_unique<QlManager>(sm_manager_.get(), nullptr);
+
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            sm_manager_->drop_db(TEST_DB_NAME);
+        }
+        sm_manager_->create_db(TEST_DB_NAME);
+        sm_manager_->open_db(TEST_DB_NAME);
+    }
+
+    void TearDown() override {
+        sm_manager_->close_db();
+        sm_manager_->drop_db(TEST_DB_NAME);
+    }
+
+    /**
+     * @brief 与rmdb相同，经过解析、分析、优化和执行执行一条语句
+     * @return 发送给客户端的输出
+     */
+    std::string run_sql(const std::string &sql) {
+        offset_ = 0;
+        memset(data_send_, 0, sizeof(data_send_));
+        Context context(nullptr, nullptr, nullptr, data_send_, &offset_);
+        YY_BUFFER_STATE buf = yy_scan_string(sql.c_str());
+        int ret = yyparse();
+        yy_delete_buffer(buf);
+        if (ret != 0 || ast::parse_tree == nullptr) {
+            ADD_FAILURE() << "failed to parse: " << sql;
+            return std::string();
+        }
+        Analyze analyze(sm_manager_.get());
+        std::shared_ptr<Query> query = analyze.do_analyze(ast::parse_tree);
+        std::shared_ptr<Plan> plan = optimizer_->plan_query(query, &context);
+        std::shared_ptr<PortalStmt> stmt = portal_->start(plan, &context);
+        txn_id_t txn_id = INVALID_TXN_ID;
+        portal_->run(stmt, ql_manager_.get(), &txn_id, &context);
+        return std::string(data_send_, offset_);
+    }
+
+    /** 在数据库目录下写一个csv文件 */
+    void write_csv(const std::string &file_name, const std::string &content) {
+        std::ofstream ofs(file_name, std::ios::binary);
+        ofs << content;
+    }
+
+    void load_data(const std::string &file_name, const std::string &tab_name) {
+        offset_ = 0;
+        Context context(nullptr, nullptr, nullptr, data_send_, &offset_);
+        sm_manager_->load_data(file_name, tab_name, &context);
+    }
+
+    /** 全表扫描，返回第一个字段(int)到记录号的映射 */
+    std::map<int, Rid> scan_table(const std::string &tab_name) {
+        std::map<int, Rid> records;
+        for (RmScan scan(sm_manager_->fhs_.at(tab_name).get()); !scan.is_end(); scan.next()) {
+            int id;
+            memcpy(&id, scan.record_view().data, sizeof(int));
+            EXPECT_TRUE(records.emplace(id, scan.rid()).second) << id;
+        }
+        return records;
+    }
+
+    /** 按叶子链表扫描索引，返回索引中的所有记录号 */
+    std::vector<Rid> scan_index(const std::string &tab_name, const std::vector<std::string> &col_names) {
+        auto &tab = sm_manager_->db_.get_table(tab_name);
+        std::vector<ColMeta> cols;
+        for (auto &col_name : col_names) {
+            cols.push_back(*tab.get_col(col_name));
+        }
+        IxIndexHandle *ih = sm_manager_->ihs_.at(ix_manager_->get_index_name(tab_name, cols)).get();
+        std::vector<Rid> rids;
+        for (IxScan scan(ih, ih->leaf_begin(), ih->leaf_end(), buffer_pool_manager_.get()); !scan.is_end();
+             scan.next()) {
+            rids.push_back(scan.rid());
+        }
+        return rids;
+    }
+
+    /** 堆文件中的记录与id上的索引一一对应 */
+    void check_index(const std::string &tab_name, size_t expected_records) {
+        std::map<int, Rid> records = scan_table(tab_name);
+        std::vector<Rid> rids = scan_index(tab_name, {"id"});
+        EXPECT_EQ(expected_records, records.size());
+        ASSERT_EQ(records.size(), rids.size());
+        size_t i = 0;
+        for (auto &entry : records) {
+            EXPECT_EQ(entry.second, rids[i++]) << entry.first;
+        }
+    }
+};
+
+/**
+ * @brief SET BUFFER POOL SIZE在线扩大和缩小缓冲池；有帧被固定时只缩小到被固定的帧为止，越界的大小报错
+ */
+TEST_F(SmManagerTest, SetBufferPoolSizeTest) {
+    // 固定前20个帧，缩小只能移除其后的空闲帧
+    disk_manager_->create_file("pin_test");
+    int fd = disk_manager_->open_file("pin_test");
+    std::vector<PageId> page_ids;
+    for (int i = 0; i < 20; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        ASSERT_NE(nullptr, buffer_pool_manager_->new_page(&page_id));
+        page_ids.push_back(page_id);
+    }
+    std::string output = run_sql("set buffer pool size 8;");
+    EXPECT_EQ(20u, buffer_pool_manager_->get_pool_size());
+    EXPECT_NE(std::string::npos, output.find("pool_size")) << output;
+    EXPECT_NE(std::string::npos, output.find(" 20 ")) << output;
+
+    for (auto &page_id : page_ids) {
+        EXPECT_EQ(true, buffer_pool_manager_->unpin_page(page_id, false));
+    }
+    run_sql("SET BUFFER POOL SIZE 8;");
+    EXPECT_EQ(8u, buffer_pool_manager_->get_pool_size());
+
+    output = run_sql("set buffer pool size 256;");
+    EXPECT_EQ(MAX_POOL_SIZE, buffer_pool_manager_->get_pool_size());
+    EXPECT_NE(std::string::npos, output.find(" 256 ")) << output;
+
+    // 超过启动时的最大帧个数或小于分片个数时报错，缓冲池大小不变
+    EXPECT_THROW(run_sql("set buffer pool size 257;"), InternalError);
+    EXPECT_THROW(run_sql("set buffer pool size 0;"), InternalError);
+    EXPECT_EQ(MAX_POOL_SIZE, buffer_pool_manager_->get_pool_size());
+
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @description: 装载带表头、引号、CRLF和空行的csv：记录按字段解析，空索引批量构建，非空索引按key顺序插入，
+ * 堆文件中的记录数始终等于索引中的键值对数
+ */
+TEST_F(SmManagerTest, LoadDataTest) {
+    sm_manager_->create_table("t", {{"id", TYPE_INT, 4}, {"name", TYPE_STRING, 8}, {"score", TYPE_FLOAT, 4}}, nullptr);
+    sm_manager_->create_index("t", {"id"}, nullptr);
+
+    write_csv("first.csv", "ID,name,score\n3,\"a,b\",1.5\r\n1,\"q\"\"t\",-2\n\n2,plain,0.25");
+    load_data("first.csv", "t");
+    check_index("t", 3);
+    std::map<int, Rid> records = scan_table("t");
+    auto fh = sm_manager_->fhs_.at("t").get();
+    auto rec = fh->get_record(records.at(3), nullptr);
+    EXPECT_EQ(std::string("a,b"), std::string(rec->data + 4, strnlen(rec->data + 4, 8)));
+    EXPECT_FLOAT_EQ(1.5f, *reinterpret_cast<float *>(rec->data + 12));
+    rec = fh->get_record(records.at(1), nullptr);
+    EXPECT_EQ(std::string("q\"t"), std::string(rec->data + 4, strnlen(rec->data + 4, 8)));
+    EXPECT_FLOAT_EQ(-2.0f, *reinterpret_cast<float *>(rec->data + 12));
+
+    // 第二次装载时索引非空，按key顺序插入
+    std::string content;
+    for (int id = 100; id > 3; id--) {
+        content += std::to_string(id) + ",n" + std::to_string(id) + "," + std::to_string(id) + ".5\n";
+    }
+    write_csv("second.csv", content);
+    load_data("second.csv", "t");
+    check_index("t", 100);
+}
+
+/**
+ * @description: 最后一行格式错误(类型不符、字段个数不符、整数溢出)时抛出异常，表和索引都不变
+ */
+TEST_F(SmManagerTest, LoadDataBadLineTest) {
+    sm_manager_->create_table("t", {{"id", TYPE_INT, 4}, {"name", TYPE_STRING, 8}}, nullptr);
+    sm_manager_->create_index("t", {"id"}, nullptr);
+
+    write_csv("bad_type.csv", "1,a\n2,b\nthree,c\n");
+    EXPECT_THROW(load_data("bad_type.csv", "t"), IncompatibleTypeError);
+    check_index("t", 0);
+    write_csv("bad_count.csv", "1,a\n2,b\n3,c,d\n");
+    EXPECT_THROW(load_data("bad_count.csv", "t"), InvalidValueCountError);
+    check_index("t", 0);
+    write_csv("overflow.csv", "1,a\n2,b\n2147483648,c");
+    EXPECT_THROW(load_data("overflow.csv", "t"), IncompatibleTypeError);
+    check_index("t", 0);
+    EXPECT_THROW(load_data("missing.csv", "t"), FileNotFoundError);
+
+    write_csv("good.csv", "1,a\n2,b\n3,c\n");
+    load_data("good.csv", "t");
+    check_index("t", 3);
+}
+
+/**
+ * @description: 文件中的key互相重复，或与索引中已有的key重复时抛出IndexDuplicateKeyError，不写入任何记录
+ */
+TEST_F(SmManagerTest, LoadDataDuplicateTest) {
+    sm_manager_->create_table("t", {{"id", TYPE_INT, 4}, {"name", TYPE_STRING, 8}}, nullptr);
+    sm_manager_->create_index("t", {"id"}, nullptr);
+
+    write_csv("dup_in_file.csv", "1,a\n2,b\n3,c\n1,d\n");
+    EXPECT_THROW(load_data("dup_in_file.csv", "t"), IndexDuplicateKeyError);
+    check_index("t", 0);
+
+    write_csv("good.csv", "1,a\n2,b\n3,c\n");
+    load_data("good.csv", "t");
+    check_index("t", 3);
+
+    write_csv("dup_existing.csv", "4,d\n5,e\n2,f\n");
+    EXPECT_THROW(load_data("dup_existing.csv", "t"), IndexDuplicateKeyError);
+    check_index("t", 3);
+    std::map<int, Rid> records = scan_table("t");
+    auto rec = sm_manager_->fhs_.at("t")->get_record(records.at(2), nullptr);
+    EXPECT_EQ('b', rec->data[4]);
+}
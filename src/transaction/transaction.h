@@ -27,6 +27,7 @@ class Transaction {
         lock_set_ = std::make_shared<std::unordered_set<LockDataId>>();
         index_latch_page_set_ = std::make_shared<std::deque<Page *>>();
         index_deleted_page_set_ = std::make_shared<std::deque<Page*>>();
+        index_child_idx_set_ = std::make_shared<std::deque<int>>();
         prev_lsn_ = INVALID_LSN;
         thread_id_ = std::this_thread::get_id();
     }
@@ -58,7 +59,12 @@ class Transaction {
     inline void append_index_deleted_page(Page* page) { index_deleted_page_set_->push_back(page); }
 
     inline std::shared_ptr<std::deque<Page*>> get_index_latch_page_set() { return index_latch_page_set_; }
-    inline void append_index_latch_page_set(Page* page) { index_latch_page_set_->push_back(page); }
+    inline void append_index_latch_page_set(Page* page) {
+        index_latch_page_set_->push_back(page);
+        index_child_idx_set_->push_back(-1);
+    }
+
+    inline std::shared_ptr<std::deque<int>> get_index_child_idx_set() { return index_child_idx_set_; }
 
     inline std::shared_ptr<std::unordered_set<LockDataId>> get_lock_set() { return lock_set_; }
 
@@ -75,4 +81,5 @@ class Transaction {
     std::shared_ptr<std::unordered_set<LockDataId>> lock_set_;  // 事务申请的所有锁
     std::shared_ptr<std::deque<Page*>> index_latch_page_set_;          // 维护事务执行过程中加锁的索引页面
     std::shared_ptr<std::deque<Page*>> index_deleted_page_set_;    // 维护事务执行过程中删除的索引页面
+    std::shared_ptr<std::deque<int>> index_child_idx_set_;         // 与index_latch_page_set一一对应，下降时走向的孩子下标，-1表示未记录
 };